@@ -0,0 +1,30 @@
+# Find Z3 (the Z3 theorem prover's C API)
+#
+#  Z3_FOUND       - True if Z3 was found
+#  Z3_INCLUDE_DIR - Path to Z3's include directory.
+#  Z3_LIBRARY     - Path to libz3.
+
+include(FindPackageHandleStandardArgs)
+
+if(Z3_INCLUDE_DIR AND Z3_LIBRARY)
+
+  # Already found, don't search again
+  set(Z3_FOUND TRUE)
+
+else(Z3_INCLUDE_DIR AND Z3_LIBRARY)
+
+  find_path(Z3_INCLUDE_DIR z3.h DOC "Path to Z3's include directory")
+
+  find_library(Z3_LIBRARY NAMES z3 DOC "Path to Z3's library")
+
+  FIND_PACKAGE_HANDLE_STANDARD_ARGS(Z3 DEFAULT_MSG
+    Z3_INCLUDE_DIR
+    Z3_LIBRARY
+  )
+
+  mark_as_advanced(
+    Z3_INCLUDE_DIR
+    Z3_LIBRARY
+  )
+
+endif(Z3_INCLUDE_DIR AND Z3_LIBRARY)
@@ -20,6 +20,9 @@ using llvm::dyn_cast_or_null;
 #include <assert.h>
 #include <iosfwd> // FIXME: Remove this!!!
 
+// With LLVM2KITTEL_ATOMIC_REFCOUNT defined, reference counts are updated
+// atomically so that objects can be shared between threads.
+
 namespace klee {
 
 template<class T>
@@ -34,12 +37,24 @@ public:
 private:
   void inc() const {
     if (ptr)
+#ifdef LLVM2KITTEL_ATOMIC_REFCOUNT
+      __atomic_add_fetch(&ptr->refCount, 1, __ATOMIC_RELAXED);
+#else
       ++ptr->refCount;
+#endif
   }
 
   void dec() const {
-    if (ptr && --ptr->refCount == 0)
-      delete ptr;
+    release(ptr);
+  }
+
+  static void release(T *p) {
+#ifdef LLVM2KITTEL_ATOMIC_REFCOUNT
+    if (p && __atomic_sub_fetch(&p->refCount, 1, __ATOMIC_ACQ_REL) == 0)
+#else
+    if (p && --p->refCount == 0)
+#endif
+      delete p;
   }
 
 public:
@@ -61,6 +76,18 @@ public:
     inc();
   }
 
+#if __cplusplus >= 201103L
+  // move constructors: steal the reference without touching the count
+  ref(ref<T> &&r) : ptr(r.ptr) {
+    r.ptr = 0;
+  }
+
+  template<class U>
+  ref (ref<U> &&r) : ptr(r.ptr) {
+    r.ptr = 0;
+  }
+#endif
+
   // pointer operations
   T *get () const {
     return ptr;
@@ -84,6 +111,28 @@ public:
     return *this;
   }
 
+#if __cplusplus >= 201103L
+  ref<T> &operator= (ref<T> &&r) {
+    if (this != &r) {
+      T *old = ptr;
+      ptr = r.ptr;
+      r.ptr = 0;
+      release(old);
+    }
+
+    return *this;
+  }
+
+  template<class U> ref<T> &operator= (ref<U> &&r) {
+    T *old = ptr;
+    ptr = r.ptr;
+    r.ptr = 0;
+    release(old);
+
+    return *this;
+  }
+#endif
+
   T& operator*() const {
     return *ptr;
   }
@@ -17,6 +17,9 @@
 
 class Rule;
 
-std::list<ref<Rule> > addBoundConstraints(std::list<ref<Rule> > rules, std::map<std::string, unsigned int> bitwidthMap, bool unsignedEncoding);
+std::list<ref<Rule> > addBoundConstraints(const std::list<ref<Rule> > &rules, std::map<std::string, unsigned int> bitwidthMap, bool unsignedEncoding);
+
+// Drops the bound atoms of kittelized rules that are implied by the remaining atoms
+std::list<ref<Rule> > removeImpliedBounds(const std::list<ref<Rule> > &rules, const std::map<std::string, unsigned int> &bitwidthMap, bool unsignedEncoding);
 
 #endif // BOUND_CONSTRAINER_H
@@ -8,12 +8,18 @@
 #ifndef CONSTRAINT_ELIMINATOR_H
 #define CONSTRAINT_ELIMINATOR_H
 
+#include "llvm2kittel/LinearChecker.h"
+#include "llvm2kittel/QueryCanonicalizer.h"
 #include "llvm2kittel/Util/Ref.h"
 
+#include <map>
 #include <string>
 #include <utility>
+#include <vector>
 
 class Constraint;
+class QueryCache;
+class SolverLimits;
 
 enum SMTSolver
 {
@@ -21,27 +27,122 @@ enum SMTSolver
   MathSAT5Solver,
   Yices2Solver,
   Z3Solver,
+  BuiltinSolver,
   NoSolver
 };
 
 class EliminateClass
 {
 protected:
-    EliminateClass();
+    EliminateClass(unsigned int workers);
 
 public:
     virtual ~EliminateClass();
 
-    virtual bool shouldEliminate(ref<Constraint> c) = 0;
-    friend EliminateClass *eliminateClassFactory(SMTSolver solver);
+    class Query
+    {
+    public:
+        Query();
+
+        // SMT-LIB declarations and assertions
+        std::string text;
+        // the clause in structured form, if it could be canonicalized
+        bool isCanonical;
+        CanonicalQuery canonical;
+    };
+
+    // Dual clauses that share a prefix
+    class ClauseGroup
+    {
+    public:
+        ClauseGroup();
+
+        ref<Constraint> prefix;
+        // clauses[i] is prefix /\ extensions[i]
+        std::vector<ref<Constraint> > extensions;
+        std::vector<ref<Constraint> > clauses;
+    };
+
+    bool shouldEliminate(ref<Constraint> c);
+    void shouldEliminateAll(const std::vector<ref<Constraint> > &cs, std::vector<bool> &res);
+    // Decides all clauses at once; the queries that need the external solver
+    // are distributed over the workers a group at a time. If a group's prefix
+    // is unsatisfiable, all of its clauses are eliminated; incremental solvers
+    // assert the prefix once and decide its extensions in nested scopes.
+    virtual void shouldEliminateGroups(const std::vector<ClauseGroup> &groups, std::vector<std::vector<bool> > &res);
+    friend EliminateClass *eliminateClassFactory(SMTSolver solver, bool persistent, unsigned int workers);
+
+    // Answers to queries are looked up in (and added to) the cache, if any
+    void setCache(QueryCache *cache);
+    // Solver calls are subject to the limits, if any
+    void setLimits(SolverLimits *limits);
 
 protected:
+    enum Answer {
+        Sat,
+        Unsat,
+        Unknown
+    };
+
+    QueryCache *m_cache;
+    SolverLimits *m_limits;
+    LinearChecker m_checker;
+    // decides the clauses of queries the solver gave up on, without the size
+    // limits of m_checker
+    LinearChecker m_fallbackChecker;
+    unsigned int m_workers;
+
     std::pair<std::string, int> makeTempFile(const char templ[]);
     char *makeTempTemplate(const char str[]);
-    bool shouldEliminateInternal(ref<Constraint> c);
-    virtual bool callSolver(const std::string &filename_in, const std::string &filename_out) = 0;
+    void getQuery(ref<Constraint> c, Query &query);
+    // worker identifies the calling worker, which is below m_workers; the
+    // answer is Unknown if the solver gave up or did not finish within
+    // timeout milliseconds (0: no timeout), and is then not cached
+    virtual Answer decide(const Query &query, unsigned long timeout, unsigned int worker);
+    virtual bool callSolver(const std::string &filename_in, const std::string &filename_out, unsigned long timeout, bool &timedOut) = 0;
+
+    // Incremental solvers assert the prefix until popPrefix and decide each
+    // extension (whose variables are numbered after those of the prefix) in
+    // its own scope
+    virtual bool isIncremental() const;
+    virtual void pushPrefix(const Query &prefix, unsigned int worker);
+    virtual Answer decideExtension(const Query &extension, unsigned long timeout, unsigned int worker);
+    virtual void popPrefix(unsigned int worker);
+
+private:
+    // The queries of the pending clauses of one group, with the prefix and
+    // extensions if the group is decided incrementally
+    class Job
+    {
+    public:
+        Job();
+
+        std::vector<Query> clauses;
+        bool incremental;
+        Query prefix;
+        std::vector<Query> extensions;
+    };
+
+    // runs the jobs on the solver workers, which are kept between batches
+    class DecideTasks;
+
+    DecideTasks *m_tasks;
+
+    void placeQueries(const ClauseGroup &group, bool hasPrefix, const std::vector<unsigned int> &pending, const std::vector<Query> &pendingQueries, std::vector<Job> &jobs, std::vector<std::pair<unsigned int, unsigned int> > &clauseToQuery, std::map<std::string, std::pair<unsigned int, unsigned int> > &queryIndex);
+    Answer decideWithinLimits(const Query &query, bool extension, unsigned int worker);
+    void decideJob(const Job &job, unsigned int worker, std::vector<char> &answers);
+    void decideAll(const std::vector<Job> &jobs, std::vector<std::vector<char> > &answers);
+
+private:
+    EliminateClass(const EliminateClass &);
+    EliminateClass &operator=(const EliminateClass &);
 };
 
-EliminateClass *eliminateClassFactory(SMTSolver solver);
+// If persistent, one solver process per worker is kept alive and queried
+// incrementally; otherwise, a new solver process is started for every query.
+// Builds with the Z3 library (LLVM2KITTEL_Z3_API) decide Z3 queries in-process
+// instead, with one Z3 context per worker.
+// A batch of queries is decided by up to workers solver processes in parallel.
+EliminateClass *eliminateClassFactory(SMTSolver solver, bool persistent, unsigned int workers);
 
 #endif // CONSTRAINT_ELIMINATOR_H
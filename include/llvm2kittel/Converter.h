@@ -15,6 +15,7 @@
 #include "llvm2kittel/Analysis/ConditionPropagator.h"
 #include "llvm2kittel/Analysis/LoopConditionExplicitizer.h"
 #include "llvm2kittel/IntTRS/Constraint.h"
+#include "llvm2kittel/IntTRS/Symbol.h"
 #include "llvm2kittel/Util/Ref.h"
 #include "llvm2kittel/Util/Version.h"
 
@@ -38,11 +39,13 @@
 #include <list>
 #include <map>
 #include <set>
+#include <vector>
 
 #include "WARN_OFF.h"
 
 class Polynomial;
 class Rule;
+class Term;
 
 class Converter : public llvm::InstVisitor<Converter>
 {
@@ -95,22 +98,55 @@ public:
 
     std::list<ref<Rule> > getCondensedRules();
 
-    std::set<std::string> getPhiVariables();
+    std::set<Symbol> getPhiVariables();
 
     std::map<std::string, unsigned int> getBitwidthMap();
 
-    std::set<std::string> getComplexityLHSs();
+    std::set<Symbol> getComplexityLHSs();
 
 private:
+    typedef std::map<Symbol, ref<Polynomial> > Updates;
+
+    // Program state at a location: the arguments are those of the left-hand
+    // sides (m_lhs) with the updated variables replaced, unless the state
+    // belongs to another function (e.g., the start of a callee)
+    class State
+    {
+    public:
+        explicit State(const std::string &loc);
+        State(const std::string &loc, const Updates &newArgs);
+        State(const std::string &loc, const std::list<ref<Polynomial> > &foreignArgs);
+
+        Symbol location;
+        Updates updates;
+        bool isForeign;
+        std::list<ref<Polynomial> > args;
+    };
+
+    // Rule from lhs (without updates) to rhs; full-arity terms are only
+    // created when the rules are handed out
+    class Transition
+    {
+    public:
+        Transition(const State &from, const State &to, ref<Constraint> c);
+
+        State lhs;
+        State rhs;
+        ref<Constraint> constraint;
+    };
+
     llvm::BasicBlock *m_entryBlock;
     void visitBB(llvm::BasicBlock *bb);
 
     const llvm::Type *m_boolType;
 
-    std::list<ref<Rule> > m_blockRules;
-    std::list<ref<Rule> > m_rules;
-    std::list<std::string> m_vars;
-    std::list<ref<Polynomial> > m_lhs;
+    std::list<Transition> m_blockRules;
+    std::list<Transition> m_rules;
+    // the variables and their left-hand sides by position, and the position
+    // of the variable of every value that has one
+    std::vector<Symbol> m_vars;
+    std::vector<ref<Polynomial> > m_lhs;
+    std::map<llvm::Value*, unsigned int> m_varIndex;
     unsigned int m_counter;
     bool m_phase1;
 
@@ -121,20 +157,21 @@ private:
     TrueFalseMap m_tfMap;
     ConditionMap m_elcMap;
 
+    Symbol addVar(llvm::Value *V);
     std::string getVar(llvm::Value *V);
     std::string getEval(unsigned int i);
     std::string getEval(llvm::BasicBlock *bb, std::string inout);
     std::string getEval(llvm::Function *f, std::string startstop);
 
-    std::list<ref<Polynomial> > getArgsWithPhis(llvm::BasicBlock *from, llvm::BasicBlock *to);
+    Updates getArgsWithPhis(llvm::BasicBlock *from, llvm::BasicBlock *to);
 
-    void visitGenericInstruction(llvm::Instruction &I, std::list<ref<Polynomial> > newArgs, ref<Constraint> c=Constraint::_true);
+    void visitGenericInstruction(llvm::Instruction &I, const Updates &newArgs, ref<Constraint> c=Constraint::_true);
     void visitGenericInstruction(llvm::Instruction &I, ref<Polynomial> value, ref<Constraint> c=Constraint::_true);
 
     ref<Polynomial> getPolynomial(llvm::Value *V);
-    std::list<ref<Polynomial> > getNewArgs(llvm::Value &V, ref<Polynomial> p);
-    std::list<ref<Polynomial> > getZappedArgs(std::set<llvm::GlobalVariable*> toZap);
-    std::list<ref<Polynomial> > getZappedArgs(std::set<llvm::GlobalVariable*> toZap, llvm::Value &V, ref<Polynomial> p);
+    Updates getNewArgs(llvm::Value &V, ref<Polynomial> p);
+    Updates getZappedArgs(const std::set<llvm::GlobalVariable*> &toZap);
+    Updates getZappedArgs(const std::set<llvm::GlobalVariable*> &toZap, llvm::Value &V, ref<Polynomial> p);
 
     std::list<llvm::BasicBlock*> m_returns;
     std::map<llvm::Instruction*, unsigned int> m_idMap;
@@ -151,7 +188,15 @@ private:
     bool m_assumeIsControl;
     bool m_selectIsControl;
     bool m_onlyMultiPredIsControl;
-    std::set<std::string> m_controlPoints;
+    std::set<Symbol> m_controlPoints;
+
+    // Rules from a location to the next control point, composed from the
+    // rules of non-control locations
+    class Chain;
+    typedef std::map<Symbol, std::list<Transition> > RuleIndex;
+    const std::list<Chain> &getChains(const Symbol &f, RuleIndex &outgoing, std::map<Symbol, std::list<Chain> > &chains);
+    State compose(const State &state, Updates &updates);
+    ref<Term> toTerm(const State &state);
 
     ref<Constraint> getSDivConstraint(DivConstraintStore &store);
     ref<Constraint> getSDivConstraintForUnbounded(ref<Polynomial> upper, ref<Polynomial> lower, ref<Polynomial> res);
@@ -190,7 +235,14 @@ private:
 
     std::list<llvm::Function*> getMatchingFunctions(llvm::CallInst &I);
 
-    std::set<std::string> m_phiVars;
+    std::set<Symbol> m_phiVars;
+
+    // Positions of the phi variables of the target of a CFG edge together
+    // with their incoming values along the edge, in the order of the phis;
+    // built once per function by phase1
+    typedef std::vector<std::pair<unsigned int, llvm::Value*> > PhiTable;
+    std::map<std::pair<llvm::BasicBlock*, llvm::BasicBlock*>, PhiTable> m_phiTables;
+    void buildPhiTables();
 
     bool m_boundedIntegers;
     bool m_unsignedEncoding;
@@ -208,7 +260,7 @@ private:
     bool m_bitwiseConditions;
 
     bool m_complexityTuples;
-    std::set<std::string> m_complexityLHSs;
+    std::set<Symbol> m_complexityLHSs;
 
 private:
     Converter(const Converter &);
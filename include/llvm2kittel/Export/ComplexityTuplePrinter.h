@@ -8,6 +8,7 @@
 #ifndef COMPLEXITY_TUPLE_PRINTER_H
 #define COMPLEXITY_TUPLE_PRINTER_H
 
+#include "llvm2kittel/IntTRS/Symbol.h"
 #include "llvm2kittel/Util/Ref.h"
 
 // C++ includes
@@ -18,6 +19,6 @@
 
 class Rule;
 
-void printComplexityTuples(std::list<ref<Rule> > &rules, std::set<std::string> &complexityLHSs, std::ostream &stream);
+void printComplexityTuples(std::list<ref<Rule> > &rules, std::set<Symbol> &complexityLHSs, std::ostream &stream);
 
 #endif // COMPLEXITY_TUPLE_PRINTER_H
@@ -8,6 +8,9 @@
 #ifndef CONSTRAINT_H
 #define CONSTRAINT_H
 
+#include "llvm2kittel/IntTRS/HashCons.h"
+#include "llvm2kittel/IntTRS/Symbol.h"
+#include "llvm2kittel/Util/NodePool.h"
 #include "llvm2kittel/Util/Ref.h"
 
 // C++ includes
@@ -24,6 +27,15 @@ class Constraint
 public:
     unsigned int refCount;
 
+    static void *operator new(size_t size)
+    {
+        return NodePool::allocate(size);
+    }
+    static void operator delete(void *p, size_t size)
+    {
+        NodePool::deallocate(p, size);
+    }
+
 protected:
     Constraint();
 
@@ -47,7 +59,7 @@ public:
     virtual std::string toCIntString() = 0; // only if no True, False, Nondef, Negation, Or
     virtual std::string toSMTString(bool onlyLinearPart) = 0; // only if no False, Negation, Or
 
-    virtual ref<Constraint> instantiate(std::map<std::string, ref<Polynomial> > *bindings) = 0;
+    virtual ref<Constraint> instantiate(std::map<Symbol, ref<Polynomial> > *bindings) = 0;
 
     virtual ref<Constraint> toNNF(bool negate) = 0;
     virtual ref<Constraint> toDNF(EliminateClass *elim) = 0; // formula needs to be in NNF!
@@ -59,10 +71,12 @@ public:
     virtual ref<Constraint> evaluateTrivialAtoms() = 0;
     virtual ref<Constraint> setAtomToTrue(ref<Constraint> c) = 0;
 
-    virtual void addVariablesToSet(std::set<std::string> &res) = 0;
+    virtual void addVariablesToSet(std::set<Symbol> &res) = 0;
 
     virtual bool equals(ref<Constraint> c);
 
+    virtual unsigned long getHash() = 0;
+
     static ref<Constraint> _true;
     static ref<Constraint> _false;
 
@@ -90,7 +104,7 @@ public:
     std::string toCIntString();
     std::string toSMTString(bool onlyLinearPart);
 
-    ref<Constraint> instantiate(std::map<std::string, ref<Polynomial> > *bindings);
+    ref<Constraint> instantiate(std::map<Symbol, ref<Polynomial> > *bindings);
 
     ref<Constraint> toNNF(bool negate);
     ref<Constraint> toDNF(EliminateClass *elim);
@@ -102,7 +116,9 @@ public:
     ref<Constraint> evaluateTrivialAtoms();
     ref<Constraint> setAtomToTrue(ref<Constraint> c);
 
-    void addVariablesToSet(std::set<std::string> &res);
+    void addVariablesToSet(std::set<Symbol> &res);
+
+    unsigned long getHash();
 
 protected:
     bool equalsInternal(ref<Constraint> c);
@@ -123,7 +139,7 @@ public:
     std::string toCIntString();
     std::string toSMTString(bool onlyLinearPart);
 
-    ref<Constraint> instantiate(std::map<std::string, ref<Polynomial> > *bindings);
+    ref<Constraint> instantiate(std::map<Symbol, ref<Polynomial> > *bindings);
 
     ref<Constraint> toNNF(bool negate);
     ref<Constraint> toDNF(EliminateClass *elim);
@@ -135,7 +151,9 @@ public:
     ref<Constraint> evaluateTrivialAtoms();
     ref<Constraint> setAtomToTrue(ref<Constraint> c);
 
-    void addVariablesToSet(std::set<std::string> &res);
+    void addVariablesToSet(std::set<Symbol> &res);
+
+    unsigned long getHash();
 
 protected:
     bool equalsInternal(ref<Constraint> c);
@@ -156,7 +174,7 @@ public:
     std::string toCIntString();
     std::string toSMTString(bool onlyLinearPart);
 
-    ref<Constraint> instantiate(std::map<std::string, ref<Polynomial> > *bindings);
+    ref<Constraint> instantiate(std::map<Symbol, ref<Polynomial> > *bindings);
 
     ref<Constraint> toNNF(bool negate);
     ref<Constraint> toDNF(EliminateClass *elim);
@@ -168,14 +186,17 @@ public:
     ref<Constraint> evaluateTrivialAtoms();
     ref<Constraint> setAtomToTrue(ref<Constraint> c);
 
-    void addVariablesToSet(std::set<std::string> &res);
+    void addVariablesToSet(std::set<Symbol> &res);
+
+    unsigned long getHash();
 
 protected:
     bool equalsInternal(ref<Constraint> c);
 
 };
 
-// Atoms
+// Atoms, negations and operators are hash-consed: structurally equal
+// constraints are the same object
 class Atom : public Constraint
 {
 public:
@@ -204,7 +225,7 @@ public:
     std::string toCIntString();
     std::string toSMTString(bool onlyLinearPart);
 
-    ref<Constraint> instantiate(std::map<std::string, ref<Polynomial> > *bindings);
+    ref<Constraint> instantiate(std::map<Symbol, ref<Polynomial> > *bindings);
 
     ref<Constraint> toNNF(bool negate);
     ref<Constraint> toDNF(EliminateClass *elim);
@@ -216,11 +237,14 @@ public:
     ref<Constraint> evaluateTrivialAtoms();
     ref<Constraint> setAtomToTrue(ref<Constraint> c);
 
-    void addVariablesToSet(std::set<std::string> &res);
+    void addVariablesToSet(std::set<Symbol> &res);
 
     ref<Polynomial> getLeft();
     ref<Polynomial> getRight();
 
+    unsigned long getHash();
+    bool equalsStructurally(Atom *atom);
+
 protected:
     bool equalsInternal(ref<Constraint> c);
     static ref<Constraint> evaluateTrivialAtomsInternal(ref<Polynomial> lhs, ref<Polynomial> rhs, AType type);
@@ -229,6 +253,9 @@ private:
     ref<Polynomial> m_lhs;
     ref<Polynomial> m_rhs;
     AType m_type;
+    unsigned long m_hash;
+
+    static HashConsTable<Atom> &getTable();
 
     std::string typeToString(AType type);
     std::string typeToKittelString(AType type);
@@ -258,7 +285,7 @@ public:
     std::string toCIntString();
     std::string toSMTString(bool onlyLinearPart);
 
-    ref<Constraint> instantiate(std::map<std::string, ref<Polynomial> > *bindings);
+    ref<Constraint> instantiate(std::map<Symbol, ref<Polynomial> > *bindings);
 
     ref<Constraint> toNNF(bool negate);
     ref<Constraint> toDNF(EliminateClass *elim);
@@ -270,13 +297,21 @@ public:
     ref<Constraint> evaluateTrivialAtoms();
     ref<Constraint> setAtomToTrue(ref<Constraint> c);
 
-    void addVariablesToSet(std::set<std::string> &res);
+    void addVariablesToSet(std::set<Symbol> &res);
+
+    ref<Constraint> getNegated();
+
+    unsigned long getHash();
+    bool equalsStructurally(Negation *neg);
 
 protected:
     bool equalsInternal(ref<Constraint> c);
 
 private:
     ref<Constraint> m_c;
+    unsigned long m_hash;
+
+    static HashConsTable<Negation> &getTable();
 
 private:
     Negation(const Negation &);
@@ -309,7 +344,7 @@ public:
 
     CType getCType();
 
-    ref<Constraint> instantiate(std::map<std::string, ref<Polynomial> > *bindings);
+    ref<Constraint> instantiate(std::map<Symbol, ref<Polynomial> > *bindings);
 
     ref<Constraint> toNNF(bool negate);
     ref<Constraint> toDNF(EliminateClass *elim);
@@ -321,11 +356,14 @@ public:
     ref<Constraint> evaluateTrivialAtoms();
     ref<Constraint> setAtomToTrue(ref<Constraint> c);
 
-    void addVariablesToSet(std::set<std::string> &res);
+    void addVariablesToSet(std::set<Symbol> &res);
 
     ref<Constraint> getLeft();
     ref<Constraint> getRight();
 
+    unsigned long getHash();
+    bool equalsStructurally(Operator *op);
+
 protected:
     bool equalsInternal(ref<Constraint> c);
 
@@ -333,6 +371,9 @@ private:
     ref<Constraint> m_lhs;
     ref<Constraint> m_rhs;
     OType m_type;
+    unsigned long m_hash;
+
+    static HashConsTable<Operator> &getTable();
 
     std::string typeToString(OType type);
 
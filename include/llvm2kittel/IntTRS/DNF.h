@@ -0,0 +1,76 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#ifndef DNF_H
+#define DNF_H
+
+#include "llvm2kittel/Util/Ref.h"
+
+// C++ includes
+#include <cstddef>
+#include <vector>
+
+class Constraint;
+class EliminateClass;
+
+// Disjunctive normal form as a list of clauses
+//
+// The form is computed in a single traversal that pushes negations inward,
+// eliminates Neq atoms and distributes conjunctions over disjunctions, i.e.,
+// the result is that of toNNF(false)->evaluateTrivialAtoms()->eliminateNeq()
+// followed by toDNF.
+//
+// Atoms are hash-consed, so a literal is identified by its address. While
+// the form is built, duplicate clauses and clauses that are supersets of
+// another clause are dropped, as are clauses containing an atom and its
+// negation. True and nondef literals are dropped from clauses; the empty
+// clause is true and the empty DNF is false.
+class DNF
+{
+public:
+    class Clause
+    {
+    public:
+        Clause();
+
+        // in the order in which they were added
+        std::vector<ref<Constraint> > literals;
+        // sorted, for subsumption checks
+        std::vector<Constraint*> ids;
+        // set by conjoin: the clause extends the outer clause with index
+        // outer, which makes up its first outerLength literals
+        unsigned int outer;
+        size_t outerLength;
+    };
+
+    static DNF create(ref<Constraint> c, EliminateClass *elim);
+
+    const std::vector<Clause> &getClauses() const;
+
+    ref<Constraint> toConstraint() const;
+    static ref<Constraint> toConstraint(const Clause &clause);
+
+private:
+    DNF();
+
+    std::vector<Clause> m_clauses;
+
+    void add(const Clause &clause);
+    bool isTrue() const;
+
+    static DNF normalize(ref<Constraint> c, bool negate, EliminateClass *elim);
+    static DNF atom(ref<Constraint> c, bool negate);
+    static DNF literal(ref<Constraint> c);
+    static DNF disjoin(const DNF &lhs, const DNF &rhs);
+    static DNF conjoin(const DNF &lhs, const DNF &rhs, EliminateClass *elim);
+
+    static bool merge(const Clause &lhs, const Clause &rhs, Clause &res);
+    static bool subsumes(const Clause &lhs, const Clause &rhs);
+
+};
+
+#endif // DNF_H
@@ -0,0 +1,114 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#ifndef HASHCONS_H
+#define HASHCONS_H
+
+#include "llvm2kittel/Util/Mutex.h"
+#include "llvm2kittel/Util/Ref.h"
+
+// C++ includes
+#include <list>
+#include <map>
+
+inline unsigned long hashCombine(unsigned long seed, unsigned long value)
+{
+    return seed ^ (value + 0x9e3779b9UL + (seed << 6) + (seed >> 2));
+}
+
+// Table of the unique instances of an immutable node type.
+//
+// T has to provide getHash() and equalsStructurally(T*). The table does not
+// own its nodes: a node removes itself from the table in its destructor.
+// With atomic reference counts, a node whose count already dropped to zero
+// may still be in the table while another thread destroys it; such nodes
+// are never handed out again.
+template<class T>
+class HashConsTable
+{
+public:
+    HashConsTable()
+      : m_buckets(),
+        m_mutex()
+    {}
+
+    // Returns the instance that is structurally equal to node, deleting node
+    // if there already is one
+    ref<T> intern(T *node)
+    {
+        ref<T> res;
+        {
+            ScopedLock<NodeMutex> lock(m_mutex);
+            std::list<T*> &bucket = m_buckets[node->getHash()];
+            for (typename std::list<T*>::iterator i = bucket.begin(), e = bucket.end(); i != e; ++i) {
+                if ((*i)->equalsStructurally(node) && retain(*i)) {
+                    res = *i;
+                    release(*i);
+                    break;
+                }
+            }
+            if (res.isNull()) {
+                bucket.push_back(node);
+                return node;
+            }
+        }
+        // outside of the lock, as the destructor removes node from the table
+        delete node;
+        return res;
+    }
+
+    void remove(T *node)
+    {
+        ScopedLock<NodeMutex> lock(m_mutex);
+        typename std::map<unsigned long, std::list<T*> >::iterator found = m_buckets.find(node->getHash());
+        if (found == m_buckets.end()) {
+            return;
+        }
+        found->second.remove(node);
+        if (found->second.empty()) {
+            m_buckets.erase(found);
+        }
+    }
+
+private:
+    std::map<unsigned long, std::list<T*> > m_buckets;
+    NodeMutex m_mutex;
+
+    // takes a reference unless the node is already being destroyed
+    static bool retain(T *node)
+    {
+#ifdef LLVM2KITTEL_ATOMIC_REFCOUNT
+        unsigned int count = __atomic_load_n(&node->refCount, __ATOMIC_RELAXED);
+        while (count != 0) {
+            if (__atomic_compare_exchange_n(&node->refCount, &count, count + 1, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+                return true;
+            }
+        }
+        return false;
+#else
+        ++node->refCount;
+        return true;
+#endif
+    }
+
+    // drops the reference taken by retain, which is never the last one
+    static void release(T *node)
+    {
+#ifdef LLVM2KITTEL_ATOMIC_REFCOUNT
+        __atomic_sub_fetch(&node->refCount, 1, __ATOMIC_RELAXED);
+#else
+        --node->refCount;
+#endif
+    }
+
+private:
+    HashConsTable(const HashConsTable &);
+    HashConsTable &operator=(const HashConsTable &);
+
+};
+
+#endif // HASHCONS_H
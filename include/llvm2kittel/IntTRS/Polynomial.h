@@ -8,34 +8,50 @@
 #ifndef POLYNOMIAL_H
 #define POLYNOMIAL_H
 
+#include "llvm2kittel/IntTRS/HashCons.h"
+#include "llvm2kittel/IntTRS/Symbol.h"
+#include "llvm2kittel/Util/Integer.h"
+#include "llvm2kittel/Util/NodePool.h"
 #include "llvm2kittel/Util/Ref.h"
 
 // GMP includes
 #include <gmpxx.h>
 
 // C++ includes
-#include <list>
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
-// Monomials
+// Monomials, with the variables sorted by name
 class Monomial
 {
+    friend class Polynomial;
+
 public:
     unsigned int refCount;
 
+    static void *operator new(size_t size)
+    {
+        return NodePool::allocate(size);
+    }
+    static void operator delete(void *p, size_t size)
+    {
+        NodePool::deallocate(p, size);
+    }
+
 protected:
-    Monomial(std::string x);
+    Monomial(Symbol x);
 
 public:
-    static ref<Monomial> create(std::string x);
+    static ref<Monomial> create(Symbol x);
     ~Monomial();
 
-    unsigned int getPower(std::string x);
+    unsigned int getPower(Symbol x);
     bool empty();
 
     bool equals(ref<Monomial> mono);
+    int compare(ref<Monomial> mono);
 
     bool isUnivariateLinear();
 
@@ -44,13 +60,14 @@ public:
 
     ref<Monomial> mult(ref<Monomial> mono);
 
-    std::string getFirst();
-    ref<Monomial> lowerFirst();
+    Symbol getFirst();
+
+    void addVariablesToSet(std::set<Symbol> &res);
 
-    void addVariablesToSet(std::set<std::string> &res);
+    unsigned long getHash();
 
 private:
-    std::list<std::pair<std::string, unsigned int> > m_powers;
+    std::vector<std::pair<Symbol, unsigned int> > m_powers;
 
 private:
     Monomial(const Monomial &);
@@ -58,25 +75,40 @@ private:
 
 };
 
-// Polynomials
+// Polynomials, with the monomials sorted by Monomial::compare
+//
+// Polynomials are hash-consed: structurally equal polynomials are the same
+// object, so equals is pointer comparison.
 class Polynomial
 {
 public:
     unsigned int refCount;
 
+    static void *operator new(size_t size)
+    {
+        return NodePool::allocate(size);
+    }
+    static void operator delete(void *p, size_t size)
+    {
+        NodePool::deallocate(p, size);
+    }
+
 protected:
-    Polynomial(std::string x);
-    Polynomial(mpz_t c);
+    Polynomial(Symbol x);
+    Polynomial(const Integer &c);
     Polynomial(ref<Monomial> mono);
 
 public:
-    static ref<Polynomial> create(std::string x);
+    static ref<Polynomial> create(Symbol x);
+    static ref<Polynomial> create(const std::string &x);
     static ref<Polynomial> create(mpz_t c);
+    static ref<Polynomial> create(const Integer &c);
     static ref<Polynomial> create(ref<Monomial> mono);
     ~Polynomial();
 
     void getCoeff(mpz_t res, ref<Monomial> mono);
     void getConst(mpz_t res);
+    Integer getConst();
 
     bool isVar();
     bool isUnivariateLinear();
@@ -89,15 +121,24 @@ public:
     ref<Polynomial> add(ref<Polynomial> poly);
     ref<Polynomial> sub(ref<Polynomial> poly);
     ref<Polynomial> constMult(mpz_t d);
+    ref<Polynomial> constMult(const Integer &d);
     ref<Polynomial> mult(ref<Polynomial> poly);
 
-    ref<Polynomial> instantiate(std::map<std::string, ref<Polynomial> > *bindings);
+    ref<Polynomial> instantiate(std::map<Symbol, ref<Polynomial> > *bindings);
 
-    void addVariablesToSet(std::set<std::string> &res);
+    void addVariablesToSet(std::set<Symbol> &res);
+
+    // only for linear polynomials
+    void addLinearCoefficientsToMap(std::map<Symbol, mpz_class> &res);
 
     long int normStepsNeeded();
 
     bool equals(ref<Polynomial> p);
+
+    // for HashConsTable
+    unsigned long getHash();
+    bool equalsStructurally(Polynomial *p);
+
     static mpz_t _null;
     static mpz_t _one;
     static mpz_t _negone;
@@ -113,8 +154,9 @@ public:
     static ref<Polynomial> power_of_two(unsigned int power);
 
 private:
-    std::list<std::pair<mpz_class, ref<Monomial> > > m_monos;
-    mpz_t m_constant;
+    std::vector<std::pair<Integer, ref<Monomial> > > m_monos;
+    Integer m_constant;
+    unsigned long m_hash;
 
     static bool __init;
     static bool init();
@@ -129,7 +171,13 @@ private:
     Polynomial(const Polynomial &);
     Polynomial &operator=(const Polynomial &);
 
-    std::string constantToSMTString(mpz_class &constant);
+    std::string constantToSMTString(const Integer &constant);
+
+    static void merge(std::vector<std::pair<Integer, ref<Monomial> > > &a, std::vector<std::pair<Integer, ref<Monomial> > > &b, bool negate, std::vector<std::pair<Integer, ref<Monomial> > > &res);
+    static void normalize(std::vector<std::pair<Integer, ref<Monomial> > > &monos);
+
+    static HashConsTable<Polynomial> &getTable();
+    static ref<Polynomial> intern(Polynomial *p);
 
 };
 
@@ -8,6 +8,8 @@
 #ifndef RULE_H
 #define RULE_H
 
+#include "llvm2kittel/IntTRS/Symbol.h"
+#include "llvm2kittel/Util/NodePool.h"
 #include "llvm2kittel/Util/Ref.h"
 // C++ includes
 #include <set>
@@ -23,6 +25,15 @@ class Rule
 public:
     unsigned int refCount;
 
+    static void *operator new(size_t size)
+    {
+        return NodePool::allocate(size);
+    }
+    static void operator delete(void *p, size_t size)
+    {
+        NodePool::deallocate(p, size);
+    }
+
 protected:
     Rule(ref<Term> lhs, ref<Term> rhs, ref<Constraint> c);
 
@@ -36,12 +47,13 @@ public:
     ref<Term> getLeft();
     ref<Term> getRight();
     ref<Constraint> getConstraint();
-    void addVariablesToSet(std::set<std::string> &res);
+    void addVariablesToSet(std::set<Symbol> &res);
 
-    ref<Rule> dropArgs(std::set<unsigned int> drop);
-    ref<Rule> instantiate(std::map<std::string, ref<Polynomial> > *subst);
+    ref<Rule> dropArgs(const std::set<unsigned int> &drop);
+    ref<Rule> instantiate(std::map<Symbol, ref<Polynomial> > *subst);
 
     bool equals(ref<Rule> rule);
+    unsigned long getHash();
 
 private:
     Rule(const Rule&);
@@ -0,0 +1,55 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+// C++ includes
+#include <set>
+#include <string>
+
+// Interned name of a variable or function symbol.
+//
+// Every distinct name is stored once in a global table and identified by a
+// dense index, so that symbols are compared and hashed as integers. Symbols
+// are ordered by their names, so that sets and maps of symbols, and hence
+// the output, do not depend on the order in which names were first seen.
+class Symbol
+{
+public:
+    Symbol();
+    explicit Symbol(const std::string &name);
+
+    const std::string &getName() const;
+    unsigned int getId() const;
+
+    bool operator==(const Symbol &other) const
+    {
+        return m_id == other.m_id;
+    }
+
+    bool operator!=(const Symbol &other) const
+    {
+        return m_id != other.m_id;
+    }
+
+    bool operator<(const Symbol &other) const
+    {
+        return m_id != other.m_id && *m_name < *other.m_name;
+    }
+
+private:
+    unsigned int m_id;
+    // owned by the table, where names are never moved
+    const std::string *m_name;
+
+};
+
+// Adds the names of the given symbols to res, e.g., to print them sorted
+void addNamesToSet(const std::set<Symbol> &symbols, std::set<std::string> &res);
+
+#endif // SYMBOL_H
@@ -8,6 +8,9 @@
 #ifndef TERM_H
 #define TERM_H
 
+#include "llvm2kittel/IntTRS/HashCons.h"
+#include "llvm2kittel/IntTRS/Symbol.h"
+#include "llvm2kittel/Util/NodePool.h"
 #include "llvm2kittel/Util/Ref.h"
 
 // C++ includes
@@ -19,44 +22,69 @@
 
 class Polynomial;
 
+// Terms are hash-consed: structurally equal terms are the same object
 class Term
 {
 public:
     unsigned int refCount;
 
+    static void *operator new(size_t size)
+    {
+        return NodePool::allocate(size);
+    }
+    static void operator delete(void *p, size_t size)
+    {
+        NodePool::deallocate(p, size);
+    }
+
 protected:
-    Term(std::string f, std::list<ref<Polynomial> > args);
+    Term(Symbol f, const std::vector<ref<Polynomial> > &args);
 
 public:
-    static ref<Term> create(std::string f, std::list<ref<Polynomial> > args);
+    static ref<Term> create(Symbol f, const std::vector<ref<Polynomial> > &args);
+    static ref<Term> create(const std::string &f, const std::vector<ref<Polynomial> > &args);
+    static ref<Term> create(Symbol f, const std::list<ref<Polynomial> > &args);
+    static ref<Term> create(const std::string &f, const std::list<ref<Polynomial> > &args);
     ~Term();
 
     std::string toString();
 
-    std::string getFunctionSymbol();
-    std::list<ref<Polynomial> > getArgs();
+    Symbol getFunctionSymbol();
+    const std::vector<ref<Polynomial> > &getArgs();
+    unsigned int getArity();
     ref<Polynomial> getArg(unsigned int argpos);
 
-    ref<Term> instantiate(std::map<std::string, ref<Polynomial> > *bindings);
+    ref<Term> instantiate(std::map<Symbol, ref<Polynomial> > *bindings);
 
-    void addVariablesToSet(std::set<std::string> &res);
+    void addVariablesToSet(std::set<Symbol> &res);
 
-    void addVariablesToSet(unsigned int argpos, std::set<std::string> &res);
+    void addVariablesToSet(unsigned int argpos, std::set<Symbol> &res);
 
-    ref<Term> dropArgs(std::set<unsigned int> drop);
+    ref<Term> dropArgs(const std::set<unsigned int> &drop);
 
     bool equals(ref<Term> term);
 
+    // for HashConsTable
+    unsigned long getHash();
+    bool equalsStructurally(Term *term);
+
 private:
     Term(const Term&);
     Term &operator=(const Term&);
 
-    std::string m_f;
-    std::list<ref<Polynomial> > m_args;
-    std::vector<std::set<std::string> > m_vars;
+    Symbol m_f;
+    std::vector<ref<Polynomial> > m_args;
+    std::vector<std::set<Symbol> > m_vars;
+    bool m_varsReady;
+    unsigned long m_hash;
 
     void setupVars(void);
 
+    static HashConsTable<Term> &getTable();
+#ifdef LLVM2KITTEL_ATOMIC_REFCOUNT
+    static Mutex &getVarsMutex();
+#endif
+
 };
 
 #endif // TERM_H
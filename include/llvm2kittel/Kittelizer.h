@@ -13,9 +13,20 @@
 
 // C++ includes
 #include <list>
+#include <vector>
 
 class Rule;
 
-std::list<ref<Rule> > kittelize(std::list<ref<Rule> > rules, SMTSolver solver);
+// If budget is not 0, constraints whose DNF may have more than budget clauses
+// are split over a chain of fresh locations instead of being multiplied out.
+// The fresh locations are numbered from splitCount on, which is advanced; as
+// their names are derived from the left-hand sides, one counter per function
+// keeps them unique.
+std::list<ref<Rule> > kittelize(const std::list<ref<Rule> > &rules, EliminateClass *elim, unsigned int budget, unsigned int &splitCount);
+
+// Processes the rules in parallel, one thread per solver handle; the result
+// is the same as that of the sequential version. Only builds with atomic
+// reference counts use more than the first handle.
+std::list<ref<Rule> > kittelize(const std::list<ref<Rule> > &rules, const std::vector<EliminateClass*> &elims, unsigned int budget, unsigned int &splitCount);
 
 #endif // KITTELIZER_H
@@ -0,0 +1,84 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#ifndef LINEAR_CHECKER_H
+#define LINEAR_CHECKER_H
+
+#include "llvm2kittel/IntTRS/Symbol.h"
+#include "llvm2kittel/Util/Ref.h"
+
+// GMP includes
+#include <gmpxx.h>
+
+// C++ includes
+#include <list>
+#include <map>
+#include <utility>
+
+class Constraint;
+
+// In-process satisfiability check for conjunctions of linear integer atoms.
+//
+// Equalities with a unit coefficient are eliminated by substitution; the
+// remaining inequalities are projected by Fourier-Motzkin elimination with
+// integer tightening.  The projection is exact over the integers as long as
+// every combined pair of bounds has a unit coefficient for the eliminated
+// variable (the "exact shadow" of the Omega test); otherwise only
+// unsatisfiability can be concluded.  Nonlinear atoms are ignored, just as
+// in the queries sent to external solvers.
+//
+// Before projecting, the bounds of the variables are propagated through the
+// inequalities for a few rounds.  This is linear in the size of the clause and
+// not subject to the limits, so large clauses with contradictory ranges (as
+// introduced by the bitwidth bounds of -bounded-integers) are refuted as well.
+class LinearChecker
+{
+public:
+    enum Result {
+        Sat,
+        Unsat,
+        Unknown
+    };
+
+    class Interval
+    {
+    public:
+        Interval();
+
+        bool hasLower;
+        mpz_class lower;
+        bool hasUpper;
+        mpz_class upper;
+    };
+
+    LinearChecker(unsigned int maxVariables, unsigned int maxConstraints);
+    ~LinearChecker();
+
+    // c has to be a dual clause
+    Result check(ref<Constraint> c);
+
+    // Bounds of the variables of the dual clause c implied by its linear
+    // atoms; Unsat if the bounds are contradictory, Unknown otherwise
+    static Result getBounds(ref<Constraint> c, std::map<Symbol, Interval> &bounds);
+
+private:
+    typedef std::map<Symbol, mpz_class> Coeffs;
+    // sum of coefficients times variables plus constant, compared to zero
+    typedef std::pair<Coeffs, mpz_class> Linear;
+
+    unsigned int m_maxVariables;
+    unsigned int m_maxConstraints;
+
+    static bool collect(ref<Constraint> c, std::list<Linear> &geqs, std::list<Linear> &equs, bool &exact);
+    static Result propagateBounds(const std::list<Linear> &geqs, const std::list<Linear> &equs, std::map<Symbol, Interval> &bounds);
+    static Result propagateBounds(const Linear &l, bool negated, std::map<Symbol, Interval> &bounds, bool &changed);
+    // only substitutes variables with unit coefficients, so it stays exact
+    Result eliminateEqualities(std::list<Linear> &geqs, std::list<Linear> &equs);
+    Result eliminateVariables(std::list<Linear> &geqs, bool &exact);
+};
+
+#endif // LINEAR_CHECKER_H
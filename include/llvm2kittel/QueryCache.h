@@ -0,0 +1,49 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+
+#include "llvm2kittel/Util/Mutex.h"
+
+// C++ includes
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+// Remembers the outcome of satisfiability queries, keyed by a hash of the
+// query text.  Entries are kept in memory and, if a directory is given, also
+// stored on disk so that later runs can reuse them. The cache can be shared
+// between threads.
+class QueryCache
+{
+public:
+    QueryCache(const std::string &directory);
+    ~QueryCache();
+
+    bool lookup(const std::string &query, bool &unsat);
+    void insert(const std::string &query, bool unsat);
+
+    static unsigned long long hash(const std::string &str);
+
+private:
+    std::string m_directory;
+    std::map<unsigned long long, std::list<std::pair<std::string, bool> > > m_memory;
+    Mutex m_mutex;
+
+    void insertMemory(unsigned long long key, const std::string &query, bool unsat);
+    std::string getFileName(unsigned long long key);
+    bool lookupDisk(unsigned long long key, const std::string &query, bool &unsat);
+    void insertDisk(unsigned long long key, const std::string &query, bool unsat);
+
+private:
+    QueryCache(const QueryCache &);
+    QueryCache &operator=(const QueryCache &);
+};
+
+#endif // QUERY_CACHE_H
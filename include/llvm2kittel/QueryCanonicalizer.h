@@ -0,0 +1,104 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#ifndef QUERY_CANONICALIZER_H
+#define QUERY_CANONICALIZER_H
+
+#include "llvm2kittel/IntTRS/Symbol.h"
+#include "llvm2kittel/Util/Ref.h"
+
+// GMP includes
+#include <gmpxx.h>
+
+// C++ includes
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Constraint;
+
+// Linear dual clause over the variables x0, ..., x(variables - 1), where
+// every literal is sum a_i * x_i + c (>=|=|!=) 0
+class CanonicalQuery
+{
+public:
+    enum Kind {
+        Geq,
+        Equ,
+        Neq
+    };
+
+    class Literal
+    {
+    public:
+        Literal();
+
+        Kind kind;
+        // sorted by variable
+        std::vector<std::pair<unsigned int, mpz_class> > coeffs;
+        mpz_class constant;
+
+        std::string toSMTString() const;
+    };
+
+    CanonicalQuery();
+
+    unsigned int variables;
+    // the variables below are declared in an enclosing scope
+    unsigned int declared;
+    // the clause contains an atom without integer solutions
+    bool infeasible;
+    std::vector<Literal> literals;
+
+    std::string toSMTString() const;
+};
+
+// Equisatisfiable SMT queries for dual clauses that do not depend on the
+// names of the variables or the order of the atoms, so that the answers of
+// structurally identical clauses are shared through the query cache.
+//
+// Every linear atom is brought into the form sum a_i * x_i + c (>=|=|!=) 0
+// with the gcd of the a_i divided out (rounding the constant of inequalities
+// down) and, for (dis)equalities, the coefficient of the first variable
+// positive. The atoms are ordered by their coefficients and constant, the
+// variables are renamed in order of their first occurrence, and the printed
+// atoms are sorted and made unique. Nonlinear atoms are dropped, just as in
+// the queries that are not canonicalized.
+class QueryCanonicalizer
+{
+public:
+    // false if c is not a dual clause
+    static bool canonicalize(ref<Constraint> c, CanonicalQuery &res);
+    // As above, but numbers the variables as in numbering, which is extended
+    // by the variables that are new to it, and keeps the order of the atoms;
+    // the variables that were already numbered count as declared
+    static bool canonicalize(ref<Constraint> c, std::map<Symbol, unsigned int> &numbering, CanonicalQuery &res);
+
+private:
+    QueryCanonicalizer();
+
+    class Linear
+    {
+    public:
+        Linear();
+
+        CanonicalQuery::Kind kind;
+        // sorted by symbol
+        std::vector<std::pair<Symbol, mpz_class> > coeffs;
+        mpz_class constant;
+        // independent of the variables
+        std::string shape;
+    };
+
+    static bool collect(ref<Constraint> c, std::vector<Linear> &atoms, bool &infeasible);
+    static bool normalize(Linear &l, bool &infeasible);
+    static std::string getShape(const Linear &l, bool negated);
+    static CanonicalQuery::Literal getLiteral(const Linear &l, std::map<Symbol, unsigned int> &numbering);
+};
+
+#endif // QUERY_CANONICALIZER_H
@@ -8,6 +8,7 @@
 #ifndef SLICER_H
 #define SLICER_H
 
+#include "llvm2kittel/IntTRS/Symbol.h"
 #include "llvm2kittel/Util/Ref.h"
 #include "llvm2kittel/Util/Version.h"
 
@@ -31,68 +32,68 @@ class Slicer
 {
 
 public:
-    Slicer(llvm::Function *F, std::set<std::string> phiVars);
+    Slicer(llvm::Function *F, const std::set<Symbol> &phiVars);
     ~Slicer();
 
-    std::list<ref<Rule> > sliceUsage(std::list<ref<Rule> > rules);
+    std::list<ref<Rule> > sliceUsage(const std::list<ref<Rule> > &rules);
 
-    std::list<ref<Rule> > sliceConstraint(std::list<ref<Rule> > rules);
+    std::list<ref<Rule> > sliceConstraint(const std::list<ref<Rule> > &rules);
 
-    std::list<ref<Rule> > sliceDefined(std::list<ref<Rule> > rules);
+    std::list<ref<Rule> > sliceDefined(const std::list<ref<Rule> > &rules);
 
-    std::list<ref<Rule> > sliceStillUsed(std::list<ref<Rule> > rules, bool conservative);
+    std::list<ref<Rule> > sliceStillUsed(const std::list<ref<Rule> > &rules, bool conservative);
 
-    std::list<ref<Rule> > sliceTrivialNondefConstraints(std::list<ref<Rule> > rules);
+    std::list<ref<Rule> > sliceTrivialNondefConstraints(const std::list<ref<Rule> > &rules);
 
-    std::list<ref<Rule> > sliceDuplicates(std::list<ref<Rule> > rules);
+    std::list<ref<Rule> > sliceDuplicates(const std::list<ref<Rule> > &rules);
 
 private:
     llvm::Function *m_F;
 
     std::set<unsigned int> getSet(unsigned int size);
 
-    std::string getVar(std::string name);
-    std::string getEval(std::string startstop);
+    Symbol getVar(const std::string &name);
+    Symbol getEval(const std::string &startstop);
 
-    std::map<std::string, unsigned int> m_functionIdx;
-    std::map<unsigned int, std::string> m_idxFunction;
-    unsigned int getIdxFunction(std::string f);
-    std::string getFunction(unsigned int idx);
+    std::map<Symbol, unsigned int> m_functionIdx;
+    std::map<unsigned int, Symbol> m_idxFunction;
+    unsigned int getIdxFunction(Symbol f);
+    Symbol getFunction(unsigned int idx);
 
     unsigned int m_numFunctions;
-    std::set<std::string> m_functions;
+    std::set<Symbol> m_functions;
     bool *m_preceeds;
-    void setUpPreceeds(std::list<ref<Rule> > rules);
+    void setUpPreceeds(const std::list<ref<Rule> > &rules);
     void makePreceedsTransitive(void);
     bool *m_calls;
-    void setUpCalls(std::list<ref<Rule> > rules);
+    void setUpCalls(const std::list<ref<Rule> > &rules);
     void makeCallsTransitive(void);
 
-    std::map<std::string, unsigned int> m_varIdx;
-    std::map<unsigned int, std::string> m_idxVar;
-    unsigned int getIdxVar(std::string v);
-    std::string getVar(unsigned int idx);
+    std::map<Symbol, unsigned int> m_varIdx;
+    std::map<unsigned int, Symbol> m_idxVar;
+    unsigned int getIdxVar(Symbol v);
+    Symbol getVar(unsigned int idx);
 
     unsigned int m_numVars;
-    std::set<std::string> m_vars;
+    std::set<Symbol> m_vars;
     bool *m_depends;
     void makeDependsTransitive(void);
 
-    std::map<std::string, std::set<std::string> > m_defined;
-    std::map<std::string, std::set<std::string> > m_stillUsed;
+    std::map<Symbol, std::set<Symbol> > m_defined;
+    std::map<Symbol, std::set<Symbol> > m_stillUsed;
 
-    std::set<std::string> getKnownVars(std::string f);
+    std::set<Symbol> getKnownVars(Symbol f);
 
-    std::set<std::string> getStillUsed(std::string f);
+    std::set<Symbol> getStillUsed(Symbol f);
 
-    std::set<unsigned int> getNotNeeded(std::string f, std::list<std::string> vars);
+    std::set<unsigned int> getNotNeeded(Symbol f, const std::list<Symbol> &vars);
 
-    std::set<std::string> computeReachableFuns(std::list<ref<Rule> > rules);
+    std::set<Symbol> computeReachableFuns(const std::list<ref<Rule> > &rules);
 
-    bool isRecursiveCall(std::string f);
-    bool isNondef(std::string v);
+    bool isRecursiveCall(Symbol f);
+    bool isNondef(Symbol v);
 
-    std::set<std::string> m_phiVars;
+    std::set<Symbol> m_phiVars;
 
 private:
     Slicer(const Slicer &);
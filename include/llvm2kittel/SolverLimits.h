@@ -0,0 +1,68 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#ifndef SOLVER_LIMITS_H
+#define SOLVER_LIMITS_H
+
+#include "llvm2kittel/Util/Mutex.h"
+
+enum TimeoutPolicy
+{
+  KeepClause,
+  FallBackToChecker
+};
+
+// Bounds the time spent in the external solver. Every query gets at most the
+// query timeout, and the time of all queries together is bounded per SCC and
+// per run; queries that no longer fit the budget are not sent at all. The
+// policy decides what happens to the clauses of such queries. The limits can
+// be shared between threads.
+class SolverLimits
+{
+public:
+    // times in milliseconds, 0 means unlimited
+    SolverLimits(unsigned long queryTimeout, unsigned long sccBudget, unsigned long runBudget, TimeoutPolicy policy);
+    // Limits of a single SCC that is converted alongside others; the time,
+    // timeouts, and skipped queries also count towards run, which keeps the
+    // budget of the run
+    explicit SolverLimits(SolverLimits &run);
+    ~SolverLimits();
+
+    // Returns false if the budget is used up; otherwise, timeout is set to
+    // the time the next query may take (0 if unlimited)
+    bool getTimeout(unsigned long &timeout);
+    void addTime(unsigned long time);
+    void addTimeout();
+    void addSkipped();
+
+    // starts the budget of the next SCC
+    void startSCC();
+
+    TimeoutPolicy getPolicy();
+    unsigned long getTimeouts();
+    unsigned long getSkipped();
+
+private:
+    SolverLimits *m_run;
+    unsigned long m_queryTimeout;
+    unsigned long m_sccBudget;
+    unsigned long m_runBudget;
+    TimeoutPolicy m_policy;
+    unsigned long m_sccTime;
+    unsigned long m_runTime;
+    unsigned long m_timeouts;
+    unsigned long m_skipped;
+    Mutex m_mutex;
+
+    bool limitRun(unsigned long &timeout);
+
+private:
+    SolverLimits(const SolverLimits &);
+    SolverLimits &operator=(const SolverLimits &);
+};
+
+#endif // SOLVER_LIMITS_H
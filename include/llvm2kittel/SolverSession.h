@@ -0,0 +1,58 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#ifndef SOLVER_SESSION_H
+#define SOLVER_SESSION_H
+
+// C++ includes
+#include <string>
+#include <vector>
+
+// C includes
+#include <sys/types.h>
+
+// A long-lived SMT-LIB 2 solver process that is driven over pipes.
+class SolverSession
+{
+public:
+    // The prologue is sent every time the process is (re)started.
+    SolverSession(const std::vector<std::string> &command, const std::string &prologue);
+    ~SolverSession();
+
+    // Sends a sequence of SMT-LIB 2 commands, starting the process if needed.
+    bool send(const std::string &commands);
+
+    // Reads one line of solver output (without the trailing newline).
+    bool readLine(std::string &line);
+    // As above, but if timeout (in milliseconds) is not 0 and no line arrives
+    // in time, the process is stopped and timedOut is set.
+    bool readLine(std::string &line, unsigned long timeout, bool &timedOut);
+
+    // Terminates the process; the next send() restarts it.
+    void stop();
+
+    // Runs a shell command to completion and returns whether it succeeded;
+    // with a timeout the command is killed and timedOut is set when the time
+    // is up.
+    static bool run(const std::string &command, unsigned long timeout, bool &timedOut);
+
+private:
+    std::vector<std::string> m_command;
+    std::string m_prologue;
+    pid_t m_pid;
+    int m_toSolver;
+    int m_fromSolver;
+    std::string m_buffer;
+
+    bool start();
+
+private:
+    SolverSession(const SolverSession &);
+    SolverSession &operator=(const SolverSession &);
+};
+
+#endif // SOLVER_SESSION_H
@@ -0,0 +1,160 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#ifndef INTEGER_H
+#define INTEGER_H
+
+// GMP includes
+#include <gmpxx.h>
+
+// C++ includes
+#include <ostream>
+#include <string>
+
+// Arbitrary precision integer that is stored inline as a long as long as it
+// fits and only falls back to GMP when an operation overflows.
+//
+// Values that fit in a long are always stored inline, so two integers are
+// equal iff their representations are.
+class Integer
+{
+public:
+    Integer()
+      : m_small(0),
+        m_big(NULL)
+    {}
+
+    Integer(long value)
+      : m_small(value),
+        m_big(NULL)
+    {}
+
+    explicit Integer(mpz_srcptr value);
+
+    Integer(const Integer &other)
+      : m_small(other.m_small),
+        m_big(other.m_big == NULL ? NULL : new mpz_class(*other.m_big))
+    {}
+
+    ~Integer()
+    {
+        delete m_big;
+    }
+
+    Integer &operator=(const Integer &other);
+
+    static Integer fromUnsigned(unsigned long value);
+    static Integer powerOfTwo(unsigned int power);
+
+    bool isSmall() const
+    {
+        return m_big == NULL;
+    }
+
+    // only for small integers
+    long getSmall() const
+    {
+        return m_small;
+    }
+
+    void get(mpz_t res) const;
+    mpz_class toMpz() const;
+    std::string toString() const;
+    unsigned long getHash() const;
+
+    int sgn() const
+    {
+        if (m_big != NULL) {
+            return mpz_sgn(m_big->get_mpz_t());
+        }
+        return (m_small > 0) - (m_small < 0);
+    }
+
+    int compare(const Integer &other) const
+    {
+        if (m_big == NULL && other.m_big == NULL) {
+            return (m_small > other.m_small) - (m_small < other.m_small);
+        }
+        return compareSlow(other);
+    }
+
+    Integer operator-() const
+    {
+        long res;
+        if (m_big == NULL && !__builtin_sub_overflow(0L, m_small, &res)) {
+            return Integer(res);
+        }
+        return negSlow();
+    }
+
+    Integer operator+(const Integer &other) const
+    {
+        long res;
+        if (m_big == NULL && other.m_big == NULL && !__builtin_add_overflow(m_small, other.m_small, &res)) {
+            return Integer(res);
+        }
+        return addSlow(other);
+    }
+
+    Integer operator-(const Integer &other) const
+    {
+        long res;
+        if (m_big == NULL && other.m_big == NULL && !__builtin_sub_overflow(m_small, other.m_small, &res)) {
+            return Integer(res);
+        }
+        return subSlow(other);
+    }
+
+    Integer operator*(const Integer &other) const
+    {
+        long res;
+        if (m_big == NULL && other.m_big == NULL && !__builtin_mul_overflow(m_small, other.m_small, &res)) {
+            return Integer(res);
+        }
+        return mulSlow(other);
+    }
+
+    Integer &operator+=(const Integer &other)
+    {
+        return *this = *this + other;
+    }
+
+    Integer abs() const
+    {
+        return (sgn() < 0) ? -*this : *this;
+    }
+
+    bool operator==(const Integer &other) const
+    {
+        return compare(other) == 0;
+    }
+    bool operator!=(const Integer &other) const
+    {
+        return compare(other) != 0;
+    }
+    bool operator<(const Integer &other) const
+    {
+        return compare(other) < 0;
+    }
+
+private:
+    long m_small;
+    mpz_class *m_big;
+
+    static Integer fromMpz(const mpz_class &value);
+
+    int compareSlow(const Integer &other) const;
+    Integer negSlow() const;
+    Integer addSlow(const Integer &other) const;
+    Integer subSlow(const Integer &other) const;
+    Integer mulSlow(const Integer &other) const;
+
+};
+
+std::ostream &operator<<(std::ostream &os, const Integer &i);
+
+#endif // INTEGER_H
@@ -0,0 +1,126 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#ifndef MUTEX_H
+#define MUTEX_H
+
+// C includes
+#include <pthread.h>
+
+class Mutex
+{
+public:
+    Mutex()
+      : m_mutex()
+    {
+        pthread_mutex_init(&m_mutex, NULL);
+    }
+
+    ~Mutex()
+    {
+        pthread_mutex_destroy(&m_mutex);
+    }
+
+    void lock()
+    {
+        pthread_mutex_lock(&m_mutex);
+    }
+
+    void unlock()
+    {
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+private:
+    pthread_mutex_t m_mutex;
+
+    friend class Condition;
+
+private:
+    Mutex(const Mutex &);
+    Mutex &operator=(const Mutex &);
+
+};
+
+class Condition
+{
+public:
+    Condition()
+      : m_cond()
+    {
+        pthread_cond_init(&m_cond, NULL);
+    }
+
+    ~Condition()
+    {
+        pthread_cond_destroy(&m_cond);
+    }
+
+    // mutex has to be locked by the caller
+    void wait(Mutex &mutex)
+    {
+        pthread_cond_wait(&m_cond, &mutex.m_mutex);
+    }
+
+    void broadcast()
+    {
+        pthread_cond_broadcast(&m_cond);
+    }
+
+private:
+    pthread_cond_t m_cond;
+
+private:
+    Condition(const Condition &);
+    Condition &operator=(const Condition &);
+
+};
+
+class NullMutex
+{
+public:
+    void lock()
+    {}
+
+    void unlock()
+    {}
+
+};
+
+// IntTRS nodes are only shared between threads in builds with atomic
+// reference counts; other builds do without the locking
+#ifdef LLVM2KITTEL_ATOMIC_REFCOUNT
+typedef Mutex NodeMutex;
+#else
+typedef NullMutex NodeMutex;
+#endif
+
+template<class M>
+class ScopedLock
+{
+public:
+    ScopedLock(M &mutex)
+      : m_mutex(mutex)
+    {
+        m_mutex.lock();
+    }
+
+    ~ScopedLock()
+    {
+        m_mutex.unlock();
+    }
+
+private:
+    M &m_mutex;
+
+private:
+    ScopedLock(const ScopedLock &);
+    ScopedLock &operator=(const ScopedLock &);
+
+};
+
+#endif // MUTEX_H
@@ -0,0 +1,50 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+// C++ includes
+#include <cstddef>
+
+// Slab allocator for the small reference counted IntTRS nodes.
+//
+// Every slab serves a single size class and keeps the chunks released to it
+// for reuse. Slabs that become completely unused are only given back to the
+// system at the end of a NodeRegion, so one unit of work (e.g., an SCC)
+// reuses the memory of its predecessor instead of going through malloc for
+// every node. Only builds with atomic reference counts lock the pool.
+class NodePool
+{
+public:
+    static void *allocate(size_t size);
+    static void deallocate(void *p, size_t size);
+
+    // returns all unused slabs to the system
+    static void trim();
+
+    static size_t getSlabCount();
+
+private:
+    NodePool();
+
+};
+
+// Scope of one unit of work; unused slabs are released when it ends
+class NodeRegion
+{
+public:
+    NodeRegion();
+    ~NodeRegion();
+
+private:
+    NodeRegion(const NodeRegion &);
+    NodeRegion &operator=(const NodeRegion &);
+
+};
+
+#endif // NODE_POOL_H
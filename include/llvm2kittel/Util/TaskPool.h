@@ -0,0 +1,78 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+// C++ includes
+#include <vector>
+
+// C includes
+#include <pthread.h>
+
+class Condition;
+class Mutex;
+
+// Runs the tasks 0, ..., size - 1 on a number of worker threads.
+//
+// Every worker starts out with a contiguous range of the tasks. A worker that
+// has run out of tasks steals the upper half of the remaining range of
+// another worker. The calling thread acts as worker 0; the other workers
+// are threads that are started when first needed and kept until the pool
+// is destroyed, so a pool that runs many small batches does not pay for
+// starting threads every time.
+class TaskPool
+{
+public:
+    TaskPool();
+    virtual ~TaskPool();
+
+    void run(unsigned int size, unsigned int workers);
+
+protected:
+    // worker identifies the calling worker, which is below the number of workers
+    virtual void runTask(unsigned int index, unsigned int worker) = 0;
+
+private:
+    struct Range
+    {
+        Mutex *mutex;
+        unsigned int begin;
+        unsigned int end;
+    };
+
+    struct Thread
+    {
+        TaskPool *pool;
+        unsigned int worker;
+        unsigned long run;
+        pthread_t thread;
+    };
+
+    std::vector<Range> m_ranges;
+    std::vector<Thread*> m_threads;
+    // guards the fields below, which hand the runs to the threads
+    Mutex *m_mutex;
+    Condition *m_started;
+    Condition *m_finished;
+    unsigned long m_run;
+    unsigned int m_workers;
+    unsigned int m_busy;
+    bool m_stop;
+
+    bool nextTask(unsigned int worker, unsigned int &index);
+    void runTasks(unsigned int worker);
+    void serve(unsigned int worker, unsigned long seen);
+    static void *runThread(void *arg);
+
+private:
+    TaskPool(const TaskPool &);
+    TaskPool &operator=(const TaskPool &);
+
+};
+
+#endif // TASK_POOL_H
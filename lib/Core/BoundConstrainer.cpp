@@ -6,6 +6,7 @@
 // See LICENSE for details.
 
 #include "llvm2kittel/BoundConstrainer.h"
+#include "llvm2kittel/LinearChecker.h"
 #include "llvm2kittel/IntTRS/Constraint.h"
 #include "llvm2kittel/IntTRS/Polynomial.h"
 #include "llvm2kittel/IntTRS/Rule.h"
@@ -17,17 +18,17 @@
 #include <sstream>
 #include <stack>
 
-static std::string getNormFun(std::string f, unsigned int i)
+static std::string getNormFun(Symbol f, unsigned int i)
 {
     std::ostringstream tmp;
-    tmp << f << "_" << i << "_norm";
+    tmp << f.getName() << "_" << i << "_norm";
     return tmp.str();
 }
 
-static std::string getBlockFun(std::string f, unsigned int i)
+static std::string getBlockFun(Symbol f, unsigned int i)
 {
     std::ostringstream tmp;
-    tmp << f << "_" << i << "_block";
+    tmp << f.getName() << "_" << i << "_block";
     return tmp.str();
 }
 
@@ -54,8 +55,11 @@ static ref<Constraint> getBoundConstraints(std::string var, std::map<std::string
     return Operator::create(lowerCheck, upperCheck, Operator::And);
 }
 
-static ref<Constraint> getBoundConstraints(std::set<std::string> &vars, std::map<std::string, unsigned int> &bitwidthMap, bool unsignedEncoding)
+static ref<Constraint> getBoundConstraints(std::set<Symbol> &symbols, std::map<std::string, unsigned int> &bitwidthMap, bool unsignedEncoding)
 {
+    // by name, to keep the order of the conjuncts independent of interning
+    std::set<std::string> vars;
+    addNamesToSet(symbols, vars);
     if (vars.size() == 0) {
         return Constraint::_true;
     }
@@ -66,10 +70,11 @@ static ref<Constraint> getBoundConstraints(std::set<std::string> &vars, std::map
     return res;
 }
 
-static std::list<ref<Polynomial> > getNormArgs(std::string fun, std::list<ref<Rule> > rules)
+static std::vector<ref<Polynomial> > getNormArgs(Symbol fun, const std::list<ref<Rule> > &rules)
 {
-    if (fun.substr(fun.length() - 4) == "stop") {
-        for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    const std::string &name = fun.getName();
+    if (name.substr(name.length() - 4) == "stop") {
+        for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
             ref<Rule> rule = *i;
             ref<Term> rhs = rule->getRight();
             if (rhs->getFunctionSymbol() == fun) {
@@ -79,7 +84,7 @@ static std::list<ref<Polynomial> > getNormArgs(std::string fun, std::list<ref<Ru
         std::cerr << "Did not find rule with matching RHS!" << std::endl;
         exit(1212);
     }
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> rule = *i;
         ref<Term> lhs = rule->getLeft();
         if (lhs->getFunctionSymbol() == fun) {
@@ -98,14 +103,12 @@ bool isNormal(ref<Polynomial> p)
 static std::map<unsigned int, ref<Polynomial> > getNonNormalArgPositions(ref<Term> rhs)
 {
     std::map<unsigned int, ref<Polynomial> > res;
-    std::list<ref<Polynomial> > args = rhs->getArgs();
-    unsigned int c = 0;
-    for (std::list<ref<Polynomial> >::iterator i = args.begin(), e = args.end(); i != e; ++i) {
-        ref<Polynomial> p = *i;
+    const std::vector<ref<Polynomial> > &args = rhs->getArgs();
+    for (unsigned int c = 0; c < args.size(); ++c) {
+        ref<Polynomial> p = args[c];
         if (!isNormal(p)) {
-            res.insert(std::make_pair(c, p));
+            res.insert(res.end(), std::make_pair(c, p));
         }
-        ++c;
     }
     return res;
 }
@@ -132,34 +135,20 @@ static std::list<ref<Polynomial> > getNonNormalAtomPolynomials(ref<Constraint> c
     return res;
 }
 
-static std::string get(std::list<ref<Polynomial> > args, unsigned int c)
+static std::string get(const std::vector<ref<Polynomial> > &args, unsigned int c)
 {
-    std::list<ref<Polynomial> >::iterator tmp = args.begin();
-    for (unsigned int i = 0; i < c; ++i) {
-        ++tmp;
-    }
-    std::set<std::string> vars;
-    (*tmp)->addVariablesToSet(vars);
-    return *(vars.begin());
+    std::set<Symbol> vars;
+    args[c]->addVariablesToSet(vars);
+    return vars.begin()->getName();
 }
 
 static ref<Term> getNormRhs(ref<Term> lhs, unsigned int c, ref<Polynomial> addTerm, bool doAdd)
 {
-    std::list<ref<Polynomial> > args = lhs->getArgs();
-    std::list<ref<Polynomial> > newargs;
-    unsigned int cc = 0;
-    for (std::list<ref<Polynomial> >::iterator i = args.begin(), e = args.end(); i != e; ++i) {
-        ref<Polynomial> p = *i;
-        if (c == cc) {
-            if (doAdd) {
-                newargs.push_back(p->add(addTerm));
-            } else  {
-                newargs.push_back(p->sub(addTerm));
-            }
-        } else {
-            newargs.push_back(p);
-        }
-        ++cc;
+    std::vector<ref<Polynomial> > newargs = lhs->getArgs();
+    if (doAdd) {
+        newargs[c] = newargs[c]->add(addTerm);
+    } else {
+        newargs[c] = newargs[c]->sub(addTerm);
     }
     return Term::create(lhs->getFunctionSymbol(), newargs);
 }
@@ -197,37 +186,39 @@ static std::list<ref<Rule> > getNormRules(ref<Term> normLhs, unsigned int c, std
     return res;
 }
 
-static bool isNormSymbol(std::string fun)
+static bool isNormSymbol(Symbol fun)
 {
-    return (fun.substr(fun.length() - 5) == "_norm");
+    const std::string &name = fun.getName();
+    return (name.substr(name.length() - 5) == "_norm");
 }
 
-static bool isBlockSymbol(std::string fun)
+static bool isBlockSymbol(Symbol fun)
 {
-    return (fun.substr(fun.length() - 6) == "_block");
+    const std::string &name = fun.getName();
+    return (name.substr(name.length() - 6) == "_block");
 }
 
 static ref<Rule> chainRules(ref<Rule> rule1, ref<Rule> rule2)
 {
     ref<Term> rhs1 = rule1->getRight();
     ref<Term> lhs2 = rule2->getLeft();
-    std::map<std::string, ref<Polynomial> > subby;
-    std::list<ref<Polynomial> > rhs1args = rhs1->getArgs();
-    std::list<ref<Polynomial> > lhs2args = lhs2->getArgs();
-    for (std::list<ref<Polynomial> >::iterator i1 = rhs1args.begin(), e1 = rhs1args.end(), i2 = lhs2args.begin(); i1 != e1; ++i1, ++i2) {
+    std::map<Symbol, ref<Polynomial> > subby;
+    const std::vector<ref<Polynomial> > &rhs1args = rhs1->getArgs();
+    const std::vector<ref<Polynomial> > &lhs2args = lhs2->getArgs();
+    for (std::vector<ref<Polynomial> >::const_iterator i1 = rhs1args.begin(), e1 = rhs1args.end(), i2 = lhs2args.begin(); i1 != e1; ++i1, ++i2) {
         ref<Polynomial> p = *i1;
-        std::set<std::string> vars;
+        std::set<Symbol> vars;
         (*i2)->addVariablesToSet(vars);
-        std::string var = *(vars.begin());
+        Symbol var = *(vars.begin());
         subby.insert(std::make_pair(var, p));
     }
     return Rule::create(rule1->getLeft(), rule2->getRight()->instantiate(&subby), Operator::create(rule1->getConstraint(), rule2->getConstraint()->instantiate(&subby), Operator::And));
 }
 
-static std::pair<ref<Rule>, ref<Rule> > getTheNormRules(std::string rhsFun, unsigned int argPos, std::list<ref<Rule> > &rules)
+static std::pair<ref<Rule>, ref<Rule> > getTheNormRules(Symbol rhsFun, unsigned int argPos, const std::list<ref<Rule> > &rules)
 {
     std::list<ref<Rule> > normRules;
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> tmp = *i;
         if (tmp->getLeft()->getFunctionSymbol() == rhsFun && tmp->getRight()->getFunctionSymbol() == rhsFun) {
             ref<Polynomial> theArg = tmp->getRight()->getArg(argPos);
@@ -243,16 +234,16 @@ static std::pair<ref<Rule>, ref<Rule> > getTheNormRules(std::string rhsFun, unsi
     return std::make_pair(*normRules.begin(), *(++normRules.begin()));
 }
 
-static std::list<ref<Rule> > getChainedNormRules(ref<Rule> rule, std::list<ref<Rule> > &rules)
+static std::list<ref<Rule> > getChainedNormRules(ref<Rule> rule, const std::list<ref<Rule> > &rules)
 {
     std::list<ref<Rule> > res;
     std::list<ref<Rule> > thusFar;
     ref<Term> rhs = rule->getRight();
-    std::list<ref<Polynomial> > args = rhs->getArgs();
+    const std::vector<ref<Polynomial> > &args = rhs->getArgs();
     thusFar.push_back(rule);
-    std::string rhsFun = rhs->getFunctionSymbol();
+    Symbol rhsFun = rhs->getFunctionSymbol();
     unsigned int argCount = 0;
-    for (std::list<ref<Polynomial> >::iterator ia = args.begin(), ea = args.end(); ia != ea; ++ia) {
+    for (std::vector<ref<Polynomial> >::const_iterator ia = args.begin(), ea = args.end(); ia != ea; ++ia) {
         ref<Polynomial> p = *ia;
         if (isNormal(p)) {
             ++ argCount;
@@ -279,7 +270,7 @@ static std::list<ref<Rule> > getChainedNormRules(ref<Rule> rule, std::list<ref<R
     }
     // now chain with exit
     ref<Rule> exitRule;
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> tmp = *i;
         if (tmp->getLeft()->getFunctionSymbol() == rhsFun && tmp->getRight()->getFunctionSymbol() != rhsFun) {
             exitRule = tmp;
@@ -296,15 +287,15 @@ static std::list<ref<Rule> > getChainedNormRules(ref<Rule> rule, std::list<ref<R
     return res;
 }
 
-static std::list<ref<Rule> > eliminateUnneededNorms(std::list<ref<Rule> > rules, std::set<std::string> &haveToKeep)
+static std::list<ref<Rule> > eliminateUnneededNorms(const std::list<ref<Rule> > &rules, std::set<Symbol> &haveToKeep)
 {
     std::list<ref<Rule> > res;
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> rule = *i;
         ref<Term> lhs = rule->getLeft();
         ref<Term> rhs = rule->getRight();
-        std::string lhsFun = lhs->getFunctionSymbol();
-        std::string rhsFun = rhs->getFunctionSymbol();
+        Symbol lhsFun = lhs->getFunctionSymbol();
+        Symbol rhsFun = rhs->getFunctionSymbol();
         bool leftIsNorm = isNormSymbol(lhsFun);
         bool rightIsNorm = isNormSymbol(rhsFun);
         if (leftIsNorm && rightIsNorm) {
@@ -334,18 +325,18 @@ static std::list<ref<Rule> > eliminateUnneededNorms(std::list<ref<Rule> > rules,
     return res;
 }
 
-static std::list<ref<Rule> > eliminateBlocks(std::list<ref<Rule> > rules)
+static std::list<ref<Rule> > eliminateBlocks(const std::list<ref<Rule> > &rules)
 {
     std::list<ref<Rule> > res;
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> rule = *i;
         ref<Term> lhs = rule->getLeft();
         ref<Term> rhs = rule->getRight();
-        std::string lhsFun = lhs->getFunctionSymbol();
-        std::string rhsFun = rhs->getFunctionSymbol();
+        Symbol lhsFun = lhs->getFunctionSymbol();
+        Symbol rhsFun = rhs->getFunctionSymbol();
         if (isBlockSymbol(rhsFun)) {
             // chain
-            for (std::list<ref<Rule> >::iterator ii = rules.begin(), ee = rules.end(); ii != ee; ++ii) {
+            for (std::list<ref<Rule> >::const_iterator ii = rules.begin(), ee = rules.end(); ii != ee; ++ii) {
                 ref<Rule> inner = *ii;
                 if (inner->getLeft()->getFunctionSymbol() == rhsFun) {
                     res.push_back(chainRules(rule, inner));
@@ -374,7 +365,7 @@ static bool isCNorm(std::string v)
 }
 
 /*
-static void printRules(std::string header, std::list<ref<Rule> > rules)
+static void printRules(std::string header, const std::list<ref<Rule> > &rules)
 {
     std::cout << header << std::endl;
     for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
@@ -466,24 +457,23 @@ static ref<Constraint> mapPolysToVars(ref<Constraint> c, std::map<Polynomial*, s
     return makeConjunction(newAtoms);
 }
 
-std::list<ref<Rule> > addBoundConstraints(std::list<ref<Rule> > rules, std::map<std::string, unsigned int> bitwidthMap, bool unsignedEncoding)
+std::list<ref<Rule> > addBoundConstraints(const std::list<ref<Rule> > &rules, std::map<std::string, unsigned int> bitwidthMap, bool unsignedEncoding)
 {
     std::list<ref<Rule> > res;
-    std::set<std::string> haveToKeep;
+    std::set<Symbol> haveToKeep;
     unsigned int normCount = 0;
     unsigned int blockCount = 0;
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> rule = *i;
         ref<Term> lhs = rule->getLeft();
         ref<Term> rhs = rule->getRight();
         ref<Constraint> c = rule->getConstraint();
-        std::string lhsFun = lhs->getFunctionSymbol();
-        std::string rhsFun = rhs->getFunctionSymbol();
+        Symbol rhsFun = rhs->getFunctionSymbol();
         std::map<unsigned int, ref<Polynomial> > nonNormal = getNonNormalArgPositions(rhs);
         std::list<ref<Polynomial> > nonNormalAtomPolys = getNonNormalAtomPolynomials(c);
         if (nonNormal.empty() && nonNormalAtomPolys.empty()) {
             // rule only needs bound conditions
-            std::set<std::string> vars;
+            std::set<Symbol> vars;
             lhs->addVariablesToSet(vars);
             rhs->addVariablesToSet(vars);
             ref<Constraint> bounds = getBoundConstraints(vars, bitwidthMap, unsignedEncoding);
@@ -491,15 +481,15 @@ std::list<ref<Rule> > addBoundConstraints(std::list<ref<Rule> > rules, std::map<
             ref<Rule> newRule = Rule::create(lhs, rhs, conj);
             res.push_back(newRule);
         } else {
-            std::list<ref<Polynomial> > ruleNormArgs = getNormArgs(rhsFun, rules);
+            std::vector<ref<Polynomial> > ruleNormArgs = getNormArgs(rhsFun, rules);
             std::list<ref<Polynomial> > condNormArgs;
-            std::list<ref<Polynomial> > rhsArgs = rhs->getArgs();
+            const std::vector<ref<Polynomial> > &rhsArgs = rhs->getArgs();
 
-            std::string cond_norm = getNormFun(rhsFun, normCount);
+            Symbol cond_norm(getNormFun(rhsFun, normCount));
             ++normCount;
-            std::string rule_norm = getNormFun(rhsFun, normCount);
+            Symbol rule_norm(getNormFun(rhsFun, normCount));
             ++normCount;
-            std::string blocker = getBlockFun(rhsFun, blockCount);
+            Symbol blocker(getBlockFun(rhsFun, blockCount));
             ++blockCount;
 
             // set up dummy vars for atom polys
@@ -513,8 +503,10 @@ std::list<ref<Rule> > addBoundConstraints(std::list<ref<Rule> > rules, std::map<
                 std::string var = getNewVar(counter++);
                 condNormArgs.push_back(Polynomial::create(var));
                 atomPolyToVarMap.insert(std::make_pair(pol.get(), var));
+                std::set<Symbol> tmpSymbols;
+                pol->addVariablesToSet(tmpSymbols);
                 std::set<std::string> tmpVars;
-                pol->addVariablesToSet(tmpVars);
+                addNamesToSet(tmpSymbols, tmpVars);
                 std::string tmpvar = *(tmpVars.begin());
                 std::map<std::string, unsigned int>::iterator tmpvari = bitwidthMap.find(tmpvar);
                 if (tmpvari == bitwidthMap.end()) {
@@ -527,21 +519,21 @@ std::list<ref<Rule> > addBoundConstraints(std::list<ref<Rule> > rules, std::map<
             // rule needs bound constraints and normalization
 
             // lhs -> rhs_cond_norm [ bounds ]
-            std::set<std::string> bounds1Vars;
+            std::set<Symbol> bounds1Vars;
             lhs->addVariablesToSet(bounds1Vars);
             ref<Constraint> bounds1 = getBoundConstraints(bounds1Vars, bitwidthMap, unsignedEncoding);
-            std::list<ref<Polynomial> > cond_norm_args = lhs->getArgs();
+            std::vector<ref<Polynomial> > cond_norm_args = lhs->getArgs();
             cond_norm_args.insert(cond_norm_args.end(), nonNormalAtomPolys.begin(), nonNormalAtomPolys.end());
             ref<Term> rhs_cond_norm = Term::create(cond_norm, cond_norm_args);
             ref<Rule> rule1 = Rule::create(lhs, rhs_cond_norm, bounds1);
             res.push_back(rule1);
 
             // rhs_cond_norm -> blockrhs_rule_norm [ bounds /\ mapped(c) ]
-            std::list<ref<Polynomial> > cond_norm_done_args = lhs->getArgs();
+            std::vector<ref<Polynomial> > cond_norm_done_args = lhs->getArgs();
             cond_norm_done_args.insert(cond_norm_done_args.end(), condNormArgs.begin(), condNormArgs.end());
             ref<Term> rhs_cond_norm_done = Term::create(cond_norm, cond_norm_done_args);
             ref<Term> block = Term::create(blocker, lhs->getArgs());
-            std::set<std::string> bounds2Vars;
+            std::set<Symbol> bounds2Vars;
             rhs_cond_norm_done->addVariablesToSet(bounds2Vars);
             ref<Constraint> bounds2 = getBoundConstraints(bounds2Vars, bitwidthMap, unsignedEncoding);
             ref<Constraint> newC = Operator::create(mapPolysToVars(c, atomPolyToVarMap), bounds2, Operator::And);
@@ -554,22 +546,21 @@ std::list<ref<Rule> > addBoundConstraints(std::list<ref<Rule> > rules, std::map<
             // rhs_rule_norm -> rhs [ bounds ]
             ref<Term> rhs_rule_norm_done = Term::create(rule_norm, ruleNormArgs);
             ref<Term> normRhs = Term::create(rhsFun, ruleNormArgs);
-            std::set<std::string> bounds3Vars;
+            std::set<Symbol> bounds3Vars;
             rhs_rule_norm_done->addVariablesToSet(bounds3Vars);
             ref<Constraint> bounds3 = getBoundConstraints(bounds3Vars, bitwidthMap, unsignedEncoding);
             ref<Rule> rule4 = Rule::create(rhs_rule_norm_done, normRhs, bounds3);
 
             // do normalization for both
             unsigned int count = 0;
-            for (std::list<ref<Polynomial> >::iterator it = cond_norm_done_args.begin(), et = cond_norm_done_args.end(); it != et; ++it) {
+            for (std::vector<ref<Polynomial> >::iterator it = cond_norm_done_args.begin(), et = cond_norm_done_args.end(); it != et; ++it) {
                 ref<Polynomial> pol = *it;
                 if (pol->isConst()) {
                     continue;
                 }
-                std::set<std::string> vars;
+                std::set<Symbol> vars;
                 pol->addVariablesToSet(vars);
-                std::string var = *(vars.begin());
-                if (isCNorm(var)) {
+                if (isCNorm(vars.begin()->getName())) {
                     std::list<ref<Rule> > normRules = getNormRules(rhs_cond_norm_done, count, bitwidthMap, unsignedEncoding);
                     res.insert(res.end(), normRules.begin(), normRules.end());
                 }
@@ -578,7 +569,7 @@ std::list<ref<Rule> > addBoundConstraints(std::list<ref<Rule> > rules, std::map<
             res.push_back(rule2);
             res.push_back(rule3);
             count = 0;
-            for (std::list<ref<Polynomial> >::iterator ii = rhsArgs.begin(), ee = rhsArgs.end(); ii != ee; ++ii) {
+            for (std::vector<ref<Polynomial> >::const_iterator ii = rhsArgs.begin(), ee = rhsArgs.end(); ii != ee; ++ii) {
                 std::map<unsigned int, ref<Polynomial> >::iterator it = nonNormal.find(count);
                 if (it != nonNormal.end()) {
                     // normalize it!
@@ -586,7 +577,7 @@ std::list<ref<Rule> > addBoundConstraints(std::list<ref<Rule> > rules, std::map<
                     res.insert(res.end(), normRules.begin(), normRules.end());
                     ref<Polynomial> p = it->second;
                     if (p->normStepsNeeded() == -1) {
-                        haveToKeep.insert(getNormFun(rhsFun, normCount));
+                        haveToKeep.insert(Symbol(getNormFun(rhsFun, normCount)));
                     }
                 }
                 ++count;
@@ -596,3 +587,119 @@ std::list<ref<Rule> > addBoundConstraints(std::list<ref<Rule> > rules, std::map<
     }
     return eliminateBlocks(eliminateUnneededNorms(res, haveToKeep));
 }
+
+// Bound atoms as introduced by getBoundConstraints, i.e., v >= lower and v <= upper
+static bool isBoundAtom(ref<Atom> atom, const std::map<std::string, unsigned int> &bitwidthMap, bool unsignedEncoding, Symbol &var, bool &isLower)
+{
+    ref<Polynomial> lhs = atom->getLeft();
+    ref<Polynomial> rhs = atom->getRight();
+    Atom::AType type = atom->getAType();
+    if (!lhs->isVar() || !rhs->isConst() || (type != Atom::Geq && type != Atom::Leq)) {
+        return false;
+    }
+    std::set<Symbol> vars;
+    lhs->addVariablesToSet(vars);
+    var = *(vars.begin());
+    std::map<std::string, unsigned int>::const_iterator found = bitwidthMap.find(var.getName());
+    if (found == bitwidthMap.end()) {
+        return false;
+    }
+    isLower = (type == Atom::Geq);
+    ref<Polynomial> bound;
+    if (unsignedEncoding) {
+        bound = isLower ? Polynomial::null : Polynomial::uimax(found->second);
+    } else {
+        bound = isLower ? Polynomial::simin(found->second) : Polynomial::simax(found->second);
+    }
+    return rhs->equals(bound);
+}
+
+static bool addConjunctsToList(ref<Constraint> c, std::list<ref<Atom> > &atoms)
+{
+    Constraint::CType type = c->getCType();
+    if (type == Constraint::CTrue) {
+        return true;
+    } else if (type == Constraint::CAtom) {
+        atoms.push_back(static_cast<Atom*>(c.get()));
+        return true;
+    } else if (type == Constraint::COperator) {
+        Operator *op = static_cast<Operator*>(c.get());
+        return op->getOType() == Operator::And && addConjunctsToList(op->getLeft(), atoms) && addConjunctsToList(op->getRight(), atoms);
+    } else {
+        return false;
+    }
+}
+
+static ref<Constraint> removeAtoms(ref<Constraint> c, const std::set<Constraint*> &toRemove)
+{
+    Constraint::CType type = c->getCType();
+    if (type == Constraint::CAtom) {
+        return (toRemove.find(c.get()) != toRemove.end()) ? Constraint::_true : c;
+    } else if (type != Constraint::COperator) {
+        return c;
+    }
+    Operator *op = static_cast<Operator*>(c.get());
+    ref<Constraint> left = removeAtoms(op->getLeft(), toRemove);
+    ref<Constraint> right = removeAtoms(op->getRight(), toRemove);
+    if (left->getCType() == Constraint::CTrue) {
+        return right;
+    } else if (right->getCType() == Constraint::CTrue) {
+        return left;
+    } else if (left.get() == op->getLeft().get() && right.get() == op->getRight().get()) {
+        return c;
+    }
+    return Operator::create(left, right, Operator::And);
+}
+
+std::list<ref<Rule> > removeImpliedBounds(const std::list<ref<Rule> > &rules, const std::map<std::string, unsigned int> &bitwidthMap, bool unsignedEncoding)
+{
+    std::list<ref<Rule> > res;
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+        ref<Rule> rule = *i;
+        ref<Constraint> c = rule->getConstraint();
+        std::list<ref<Atom> > atoms;
+        if (!addConjunctsToList(c, atoms)) {
+            res.push_back(rule);
+            continue;
+        }
+        std::set<Constraint*> boundAtoms;
+        std::list<std::pair<ref<Atom>, std::pair<Symbol, bool> > > candidates;
+        for (std::list<ref<Atom> >::iterator ai = atoms.begin(), ae = atoms.end(); ai != ae; ++ai) {
+            Symbol var;
+            bool isLower = false;
+            if (isBoundAtom(*ai, bitwidthMap, unsignedEncoding, var, isLower)) {
+                boundAtoms.insert(ai->get());
+                candidates.push_back(std::make_pair(*ai, std::make_pair(var, isLower)));
+            }
+        }
+        if (candidates.empty()) {
+            res.push_back(rule);
+            continue;
+        }
+        // only the other atoms may be used, as bound atoms could otherwise justify each other's removal
+        std::map<Symbol, LinearChecker::Interval> bounds;
+        if (LinearChecker::getBounds(removeAtoms(c, boundAtoms), bounds) == LinearChecker::Unsat) {
+            res.push_back(rule);
+            continue;
+        }
+        std::set<Constraint*> implied;
+        for (std::list<std::pair<ref<Atom>, std::pair<Symbol, bool> > >::iterator ci = candidates.begin(), ce = candidates.end(); ci != ce; ++ci) {
+            std::map<Symbol, LinearChecker::Interval>::iterator found = bounds.find(ci->second.first);
+            if (found == bounds.end()) {
+                continue;
+            }
+            mpz_class bound;
+            ci->first->getRight()->getConst(bound.get_mpz_t());
+            const LinearChecker::Interval &interval = found->second;
+            if (ci->second.second ? (interval.hasLower && interval.lower >= bound) : (interval.hasUpper && interval.upper <= bound)) {
+                implied.insert(ci->first.get());
+            }
+        }
+        if (implied.empty()) {
+            res.push_back(rule);
+        } else {
+            res.push_back(Rule::create(rule->getLeft(), rule->getRight(), removeAtoms(c, implied)));
+        }
+    }
+    return res;
+}
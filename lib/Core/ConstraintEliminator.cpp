@@ -6,102 +6,578 @@
 // See LICENSE for details.
 
 #include "llvm2kittel/ConstraintEliminator.h"
+#include "llvm2kittel/QueryCache.h"
+#include "llvm2kittel/SolverLimits.h"
+#include "llvm2kittel/SolverSession.h"
 #include "llvm2kittel/IntTRS/Constraint.h"
+#include "llvm2kittel/Util/TaskPool.h"
 
 // C/C++ includes
+#include <climits>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <set>
 #include <sstream>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <vector>
+
+#if defined(LLVM2KITTEL_Z3_API)
+// Z3 includes
+#include <z3.h>
+#endif
 
 class CVC4Eliminate : public EliminateClass
 {
 public:
-    virtual bool shouldEliminate(ref<Constraint> c)
-    {
-        return shouldEliminateInternal(c);
-    }
+    CVC4Eliminate(unsigned int workers)
+      : EliminateClass(workers)
+    {}
 
-    virtual bool callSolver(const std::string &filename_in, const std::string &filename_out)
+    virtual bool callSolver(const std::string &filename_in, const std::string &filename_out, unsigned long timeout, bool &timedOut)
     {
         std::ostringstream sstr;
         sstr << "cvc4 --lang=smt2 < " << filename_in << "> " << filename_out;
-        return system(sstr.str().c_str()) == 0;
+        return SolverSession::run(sstr.str(), timeout, timedOut);
     }
 };
 
 class MathSAT5Eliminate : public EliminateClass
 {
 public:
-    virtual bool shouldEliminate(ref<Constraint> c)
-    {
-        return shouldEliminateInternal(c);
-    }
+    MathSAT5Eliminate(unsigned int workers)
+      : EliminateClass(workers)
+    {}
 
-    virtual bool callSolver(const std::string &filename_in, const std::string &filename_out)
+    virtual bool callSolver(const std::string &filename_in, const std::string &filename_out, unsigned long timeout, bool &timedOut)
     {
         std::ostringstream sstr;
         sstr << "mathsat < " << filename_in << "> " << filename_out;
-        return system(sstr.str().c_str()) == 0;
+        return SolverSession::run(sstr.str(), timeout, timedOut);
     }
 };
 
 class Yices2Eliminate : public EliminateClass
 {
 public:
-    virtual bool shouldEliminate(ref<Constraint> c)
-    {
-        return shouldEliminateInternal(c);
-    }
+    Yices2Eliminate(unsigned int workers)
+      : EliminateClass(workers)
+    {}
 
-    virtual bool callSolver(const std::string &filename_in, const std::string &filename_out)
+    virtual bool callSolver(const std::string &filename_in, const std::string &filename_out, unsigned long timeout, bool &timedOut)
     {
         std::ostringstream sstr;
         sstr << "yices-smt2 < " << filename_in << "> " << filename_out;
-        return system(sstr.str().c_str()) == 0;
+        return SolverSession::run(sstr.str(), timeout, timedOut);
     }
 };
 
 class Z3Eliminate : public EliminateClass
 {
 public:
-    virtual bool shouldEliminate(ref<Constraint> c)
-    {
-        return shouldEliminateInternal(c);
-    }
+    Z3Eliminate(unsigned int workers)
+      : EliminateClass(workers)
+    {}
 
-    virtual bool callSolver(const std::string &filename_in, const std::string &filename_out)
+    virtual bool callSolver(const std::string &filename_in, const std::string &filename_out, unsigned long timeout, bool &timedOut)
     {
         std::ostringstream sstr;
         sstr << "z3 -smt2 -in < " << filename_in << "> " << filename_out;
-        return system(sstr.str().c_str()) == 0;
+        return SolverSession::run(sstr.str(), timeout, timedOut);
+    }
+};
+
+class SessionEliminate : public EliminateClass
+{
+public:
+    SessionEliminate(const char *const command[], unsigned int workers)
+      : EliminateClass(workers),
+        m_sessions(),
+        m_prefixes(),
+        m_prefixLost()
+    {
+        // one session per worker; the processes are only started when used
+        for (unsigned int i = 0; i < m_workers; ++i) {
+            m_sessions.push_back(new SolverSession(makeCommand(command), "(set-option :print-success false)\n(set-logic QF_LIA)\n"));
+        }
+        m_prefixes.resize(m_workers);
+        m_prefixLost.assign(m_workers, 0);
+    }
+
+    ~SessionEliminate()
+    {
+        for (std::vector<SolverSession*>::iterator i = m_sessions.begin(), e = m_sessions.end(); i != e; ++i) {
+            delete *i;
+        }
+    }
+
+protected:
+    virtual Answer decide(const Query &query, unsigned long timeout, unsigned int worker)
+    {
+        // declarations are scoped as well, so the solver forgets all about the query on pop
+        bool timedOut = false;
+        return check(m_sessions[worker], "(push 1)\n" + query.text + "(check-sat)\n(pop 1)\n", timeout, timedOut);
+    }
+
+    virtual bool isIncremental() const
+    {
+        return true;
+    }
+
+    virtual void pushPrefix(const Query &prefix, unsigned int worker)
+    {
+        m_prefixes[worker] = prefix.text;
+        m_prefixLost[worker] = !m_sessions[worker]->send("(push 1)\n" + prefix.text);
+    }
+
+    virtual Answer decideExtension(const Query &extension, unsigned long timeout, unsigned int worker)
+    {
+        SolverSession *session = m_sessions[worker];
+        // a process that was stopped after a timeout has lost the prefix
+        if (m_prefixLost[worker]) {
+            m_prefixLost[worker] = !session->send("(push 1)\n" + m_prefixes[worker]);
+        }
+        bool timedOut = false;
+        Answer res = check(session, "(push 1)\n" + extension.text + "(check-sat)\n(pop 1)\n", timeout, timedOut);
+        if (timedOut) {
+            m_prefixLost[worker] = 1;
+        }
+        return res;
+    }
+
+    virtual void popPrefix(unsigned int worker)
+    {
+        if (!m_prefixLost[worker]) {
+            m_sessions[worker]->send("(pop 1)\n");
+        }
+        m_prefixes[worker].clear();
+        m_prefixLost[worker] = 0;
+    }
+
+public:
+    virtual bool callSolver(const std::string &, const std::string &, unsigned long, bool &)
+    {
+        std::cerr << "Internal error in SessionEliminate class (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+        exit(277);
+    }
+
+private:
+    std::vector<SolverSession*> m_sessions;
+    // per worker, the prefix asserted by pushPrefix and whether the process
+    // has to be given it again
+    std::vector<std::string> m_prefixes;
+    std::vector<char> m_prefixLost;
+
+    Answer check(SolverSession *session, const std::string &commands, unsigned long timeout, bool &timedOut)
+    {
+        std::string line;
+        if (!session->send(commands) || !session->readLine(line, timeout, timedOut)) {
+            if (timedOut) {
+                return Unknown;
+            }
+            std::cerr << "Call to external solver failed (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+            exit(277);
+        }
+        if (line == "unsat") {
+            return Unsat;
+        } else if (line == "sat") {
+            return Sat;
+        } else if (line == "unknown") {
+            return Unknown;
+        } else {
+            std::cerr << "Unexpected solver response \"" << line << "\" (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+            exit(277);
+        }
+    }
+
+    static std::vector<std::string> makeCommand(const char *const command[])
+    {
+        std::vector<std::string> res;
+        for (unsigned int i = 0; command[i] != NULL; ++i) {
+            res.push_back(command[i]);
+        }
+        return res;
+    }
+};
+
+#if defined(LLVM2KITTEL_Z3_API)
+static void ignoreZ3Error(Z3_context, Z3_error_code)
+{
+    // the error code is checked after the calls that can fail
+}
+
+// One Z3 context with a QF_LIA solver; queries are asserted in their own scope
+class Z3Context
+{
+public:
+    Z3Context()
+      : m_context(NULL),
+        m_solver(NULL),
+        m_int(NULL),
+        m_variables(),
+        m_terms(),
+        m_prefixTerms(),
+        m_timeout(0)
+    {
+        Z3_config config = Z3_mk_config();
+        Z3_set_param_value(config, "model", "false");
+        m_context = Z3_mk_context_rc(config);
+        Z3_del_config(config);
+        Z3_set_error_handler(m_context, ignoreZ3Error);
+        m_solver = Z3_mk_solver_for_logic(m_context, Z3_mk_string_symbol(m_context, "QF_LIA"));
+        Z3_solver_inc_ref(m_context, m_solver);
+        m_int = Z3_mk_int_sort(m_context);
+        Z3_inc_ref(m_context, Z3_sort_to_ast(m_context, m_int));
+        applyTimeout();
+    }
+
+    ~Z3Context()
+    {
+        for (std::vector<Z3_ast>::iterator i = m_variables.begin(), e = m_variables.end(); i != e; ++i) {
+            Z3_dec_ref(m_context, *i);
+        }
+        Z3_dec_ref(m_context, Z3_sort_to_ast(m_context, m_int));
+        Z3_solver_dec_ref(m_context, m_solver);
+        Z3_del_context(m_context);
+    }
+
+    // the answer is undefined if Z3 gave up, be it because of the timeout or not
+    Z3_lbool decide(const EliminateClass::Query &query, unsigned long timeout)
+    {
+        setTimeout(timeout);
+        Z3_solver_push(m_context, m_solver);
+        if (query.isCanonical) {
+            assertCanonical(query.canonical);
+        } else {
+            assertText(query.text);
+        }
+        Z3_lbool res = Z3_solver_check(m_context, m_solver);
+        if (Z3_get_error_code(m_context) != Z3_OK) {
+            std::cerr << "Call to Z3 library failed: " << Z3_get_error_msg(m_context, Z3_get_error_code(m_context)) << " (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+            exit(277);
+        }
+        Z3_solver_pop(m_context, m_solver, 1);
+        release(m_terms);
+        return res;
+    }
+
+    // the prefix stays asserted for the following queries until popPrefix
+    void pushPrefix(const EliminateClass::Query &prefix)
+    {
+        Z3_solver_push(m_context, m_solver);
+        if (prefix.isCanonical) {
+            assertCanonical(prefix.canonical);
+        } else {
+            assertText(prefix.text);
+        }
+        m_prefixTerms.swap(m_terms);
+    }
+
+    void popPrefix()
+    {
+        Z3_solver_pop(m_context, m_solver, 1);
+        release(m_prefixTerms);
+    }
+
+private:
+    Z3_context m_context;
+    Z3_solver m_solver;
+    Z3_sort m_int;
+    // x0, x1, ... of canonical queries, shared by all queries
+    std::vector<Z3_ast> m_variables;
+    // terms of the current query
+    std::vector<Z3_ast> m_terms;
+    // terms of the prefix
+    std::vector<Z3_ast> m_prefixTerms;
+    unsigned long m_timeout;
+
+    Z3_ast keep(Z3_ast term)
+    {
+        Z3_inc_ref(m_context, term);
+        m_terms.push_back(term);
+        return term;
+    }
+
+    void release(std::vector<Z3_ast> &terms)
+    {
+        for (std::vector<Z3_ast>::iterator i = terms.begin(), e = terms.end(); i != e; ++i) {
+            Z3_dec_ref(m_context, *i);
+        }
+        terms.clear();
+    }
+
+    Z3_ast getVariable(unsigned int v)
+    {
+        while (m_variables.size() <= v) {
+            Z3_ast var = Z3_mk_const(m_context, Z3_mk_int_symbol(m_context, static_cast<int>(m_variables.size())), m_int);
+            Z3_inc_ref(m_context, var);
+            m_variables.push_back(var);
+        }
+        return m_variables[v];
+    }
+
+    Z3_ast getNumeral(const mpz_class &value)
+    {
+        return keep(Z3_mk_numeral(m_context, value.get_str().c_str(), m_int));
+    }
+
+    void setTimeout(unsigned long timeout)
+    {
+        if (timeout != m_timeout) {
+            m_timeout = timeout;
+            applyTimeout();
+        }
+    }
+
+    void applyTimeout()
+    {
+        Z3_params params = Z3_mk_params(m_context);
+        Z3_params_inc_ref(m_context, params);
+        unsigned int value = (m_timeout == 0 || m_timeout > UINT_MAX) ? UINT_MAX : static_cast<unsigned int>(m_timeout);
+        Z3_params_set_uint(m_context, params, Z3_mk_string_symbol(m_context, "timeout"), value);
+        Z3_solver_set_params(m_context, m_solver, params);
+        Z3_params_dec_ref(m_context, params);
+    }
+
+    // built from the coefficients, without going through SMT-LIB
+    void assertCanonical(const CanonicalQuery &query)
+    {
+        if (query.infeasible) {
+            Z3_solver_assert(m_context, m_solver, keep(Z3_mk_false(m_context)));
+            return;
+        }
+        for (std::vector<CanonicalQuery::Literal>::const_iterator i = query.literals.begin(), e = query.literals.end(); i != e; ++i) {
+            std::vector<Z3_ast> summands;
+            for (std::vector<std::pair<unsigned int, mpz_class> >::const_iterator ci = i->coeffs.begin(), ce = i->coeffs.end(); ci != ce; ++ci) {
+                Z3_ast var = getVariable(ci->first);
+                if (ci->second == 1) {
+                    summands.push_back(var);
+                } else {
+                    Z3_ast factors[2] = { getNumeral(ci->second), var };
+                    summands.push_back(keep(Z3_mk_mul(m_context, 2, factors)));
+                }
+            }
+            Z3_ast sum = (summands.size() == 1) ? summands.front() : keep(Z3_mk_add(m_context, static_cast<unsigned int>(summands.size()), &summands[0]));
+            Z3_ast bound = getNumeral(-i->constant);
+            Z3_ast literal;
+            if (i->kind == CanonicalQuery::Geq) {
+                literal = keep(Z3_mk_ge(m_context, sum, bound));
+            } else if (i->kind == CanonicalQuery::Equ) {
+                literal = keep(Z3_mk_eq(m_context, sum, bound));
+            } else {
+                literal = keep(Z3_mk_not(m_context, keep(Z3_mk_eq(m_context, sum, bound))));
+            }
+            Z3_solver_assert(m_context, m_solver, literal);
+        }
+    }
+
+    void assertText(const std::string &text)
+    {
+        Z3_ast_vector assertions = Z3_parse_smtlib2_string(m_context, text.c_str(), 0, NULL, NULL, 0, NULL, NULL);
+        if (Z3_get_error_code(m_context) != Z3_OK) {
+            std::cerr << "Z3 could not parse query: " << Z3_get_error_msg(m_context, Z3_get_error_code(m_context)) << " (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+            exit(277);
+        }
+        Z3_ast_vector_inc_ref(m_context, assertions);
+        for (unsigned int i = 0, e = Z3_ast_vector_size(m_context, assertions); i < e; ++i) {
+            Z3_solver_assert(m_context, m_solver, Z3_ast_vector_get(m_context, assertions, i));
+        }
+        Z3_ast_vector_dec_ref(m_context, assertions);
+    }
+
+private:
+    Z3Context(const Z3Context &);
+    Z3Context &operator=(const Z3Context &);
+};
+
+class Z3LibraryEliminate : public EliminateClass
+{
+public:
+    Z3LibraryEliminate(unsigned int workers)
+      : EliminateClass(workers),
+        m_contexts()
+    {
+        // contexts must not be shared between threads
+        for (unsigned int i = 0; i < m_workers; ++i) {
+            m_contexts.push_back(new Z3Context());
+        }
+    }
+
+    ~Z3LibraryEliminate()
+    {
+        for (std::vector<Z3Context*>::iterator i = m_contexts.begin(), e = m_contexts.end(); i != e; ++i) {
+            delete *i;
+        }
+    }
+
+protected:
+    virtual Answer decide(const Query &query, unsigned long timeout, unsigned int worker)
+    {
+        Z3_lbool res = m_contexts[worker]->decide(query, timeout);
+        if (res == Z3_L_FALSE) {
+            return Unsat;
+        } else if (res == Z3_L_UNDEF) {
+            return Unknown;
+        } else {
+            return Sat;
+        }
+    }
+
+    virtual bool isIncremental() const
+    {
+        return true;
+    }
+
+    virtual void pushPrefix(const Query &prefix, unsigned int worker)
+    {
+        m_contexts[worker]->pushPrefix(prefix);
+    }
+
+    virtual Answer decideExtension(const Query &extension, unsigned long timeout, unsigned int worker)
+    {
+        // the variables of the prefix are shared through the canonical numbering
+        return decide(extension, timeout, worker);
+    }
+
+    virtual void popPrefix(unsigned int worker)
+    {
+        m_contexts[worker]->popPrefix();
+    }
+
+public:
+    virtual bool callSolver(const std::string &, const std::string &, unsigned long, bool &)
+    {
+        std::cerr << "Internal error in Z3LibraryEliminate class (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+        exit(277);
+    }
+
+private:
+    std::vector<Z3Context*> m_contexts;
+};
+#endif
+
+class BuiltinEliminate : public EliminateClass
+{
+public:
+    BuiltinEliminate()
+      : EliminateClass(1)
+    {}
+
+    virtual void shouldEliminateGroups(const std::vector<ClauseGroup> &groups, std::vector<std::vector<bool> > &res)
+    {
+        res.resize(groups.size());
+        for (unsigned int g = 0; g < groups.size(); ++g) {
+            const std::vector<ref<Constraint> > &clauses = groups[g].clauses;
+            if (groups[g].prefix->getCType() != Constraint::CTrue && m_checker.check(groups[g].prefix) == LinearChecker::Unsat) {
+                res[g].assign(clauses.size(), true);
+                continue;
+            }
+            res[g].clear();
+            for (std::vector<ref<Constraint> >::const_iterator i = clauses.begin(), e = clauses.end(); i != e; ++i) {
+                res[g].push_back(m_checker.check(*i) == LinearChecker::Unsat);
+            }
+        }
+    }
+
+    virtual bool callSolver(const std::string &, const std::string &, unsigned long, bool &)
+    {
+        std::cerr << "Internal error in BuiltinEliminate class (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+        exit(277);
     }
 };
 
 class NoEliminate : public EliminateClass
 {
 public:
-    virtual bool shouldEliminate(ref<Constraint> c)
+    NoEliminate()
+      : EliminateClass(1)
+    {}
+
+    virtual void shouldEliminateGroups(const std::vector<ClauseGroup> &groups, std::vector<std::vector<bool> > &res)
     {
-        return false;
+        res.resize(groups.size());
+        for (unsigned int g = 0; g < groups.size(); ++g) {
+            res[g].assign(groups[g].clauses.size(), false);
+        }
     }
 
-    virtual bool callSolver(const std::string &filename_in, const std::string &filename_out)
+    virtual bool callSolver(const std::string &, const std::string &, unsigned long, bool &)
     {
         std::cerr << "Internal error in NoEliminate class (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
         exit(277);
     }
 };
 
-EliminateClass::EliminateClass()
+EliminateClass::Query::Query()
+  : text(),
+    isCanonical(false),
+    canonical()
 {}
 
-EliminateClass::~EliminateClass()
+EliminateClass::ClauseGroup::ClauseGroup()
+  : prefix(),
+    extensions(),
+    clauses()
+{}
+
+EliminateClass::Job::Job()
+  : clauses(),
+    incremental(false),
+    prefix(),
+    extensions()
 {}
 
+class EliminateClass::DecideTasks : public TaskPool
+{
+public:
+    DecideTasks(EliminateClass *elim)
+      : m_elim(elim),
+        m_jobs(NULL),
+        m_answers(NULL)
+    {}
+
+    void decide(const std::vector<Job> &jobs, std::vector<std::vector<char> > &answers)
+    {
+        m_jobs = &jobs;
+        m_answers = &answers;
+        run(static_cast<unsigned int>(jobs.size()), m_elim->m_workers);
+        m_jobs = NULL;
+        m_answers = NULL;
+    }
+
+protected:
+    virtual void runTask(unsigned int index, unsigned int worker)
+    {
+        m_elim->decideJob((*m_jobs)[index], worker, (*m_answers)[index]);
+    }
+
+private:
+    EliminateClass *m_elim;
+    const std::vector<Job> *m_jobs;
+    std::vector<std::vector<char> > *m_answers;
+
+private:
+    DecideTasks(const DecideTasks &);
+    DecideTasks &operator=(const DecideTasks &);
+};
+
+EliminateClass::EliminateClass(unsigned int workers)
+  : m_cache(NULL),
+    m_limits(NULL),
+    m_checker(16, 256),
+    m_fallbackChecker(256, 65536),
+    m_workers(workers == 0 ? 1 : workers),
+    m_tasks(new DecideTasks(this))
+{}
+
+EliminateClass::~EliminateClass()
+{
+    delete m_tasks;
+}
+
 std::pair<std::string, int> EliminateClass::makeTempFile(const char templ[])
 {
     std::ostringstream sstr;
@@ -125,17 +601,272 @@ std::pair<std::string, int> EliminateClass::makeTempFile(const char templ[])
     return std::make_pair(filename_string, fd);
 }
 
-bool EliminateClass::shouldEliminateInternal(ref<Constraint> c)
+void EliminateClass::setCache(QueryCache *cache)
 {
-    // Build SMT query
+    m_cache = cache;
+}
+
+void EliminateClass::setLimits(SolverLimits *limits)
+{
+    m_limits = limits;
+}
+
+bool EliminateClass::shouldEliminate(ref<Constraint> c)
+{
+    std::vector<ref<Constraint> > cs(1, c);
+    std::vector<bool> res;
+    shouldEliminateAll(cs, res);
+    return res[0];
+}
+
+void EliminateClass::shouldEliminateAll(const std::vector<ref<Constraint> > &cs, std::vector<bool> &res)
+{
+    // every clause forms a group of its own
+    std::vector<ClauseGroup> groups(cs.size());
+    for (unsigned int i = 0; i < cs.size(); ++i) {
+        groups[i].prefix = Constraint::_true;
+        groups[i].extensions.push_back(cs[i]);
+        groups[i].clauses.push_back(cs[i]);
+    }
+    std::vector<std::vector<bool> > groupRes;
+    shouldEliminateGroups(groups, groupRes);
+    res.clear();
+    for (std::vector<std::vector<bool> >::iterator i = groupRes.begin(), e = groupRes.end(); i != e; ++i) {
+        res.push_back(i->front());
+    }
+}
+
+void EliminateClass::shouldEliminateGroups(const std::vector<ClauseGroup> &groups, std::vector<std::vector<bool> > &res)
+{
+    res.resize(groups.size());
+
+    // the clauses are decided locally where possible and the remaining
+    // (distinct) queries are sent to the solver as one batch of jobs
+    std::vector<Job> jobs;
+    std::map<std::string, std::pair<unsigned int, unsigned int> > queryIndex;
+    // job and query deciding each clause that needs the solver
+    std::vector<std::vector<std::pair<unsigned int, unsigned int> > > clauseToQuery(groups.size());
+    std::vector<std::vector<bool> > needsSolver(groups.size());
+    for (unsigned int g = 0; g < groups.size(); ++g) {
+        const ClauseGroup &group = groups[g];
+        unsigned int size = static_cast<unsigned int>(group.clauses.size());
+        res[g].assign(size, false);
+        clauseToQuery[g].resize(size);
+        needsSolver[g].assign(size, false);
+        bool hasPrefix = (group.prefix->getCType() != Constraint::CTrue);
+        if (hasPrefix && m_checker.check(group.prefix) == LinearChecker::Unsat) {
+            res[g].assign(size, true);
+            continue;
+        }
+        std::vector<unsigned int> pending;
+        std::vector<Query> pendingQueries;
+        std::vector<std::pair<unsigned int, std::string> > duplicates;
+        for (unsigned int i = 0; i < size; ++i) {
+            // most clauses are small enough to be decided without the external solver
+            LinearChecker::Result checked = m_checker.check(group.clauses[i]);
+            if (checked == LinearChecker::Unsat) {
+                res[g][i] = true;
+                continue;
+            } else if (checked == LinearChecker::Sat) {
+                continue;
+            }
+            Query query;
+            getQuery(group.clauses[i], query);
+            bool unsat;
+            if (m_cache != NULL && m_cache->lookup(query.text, unsat)) {
+                res[g][i] = unsat;
+                continue;
+            }
+            needsSolver[g][i] = true;
+            std::map<std::string, std::pair<unsigned int, unsigned int> >::iterator found = queryIndex.find(query.text);
+            if (found != queryIndex.end()) {
+                // placed once this group is done
+                duplicates.push_back(std::make_pair(i, query.text));
+                continue;
+            }
+            // not yet placed in a job
+            queryIndex.insert(std::make_pair(query.text, std::make_pair(0U, 0U)));
+            pending.push_back(i);
+            pendingQueries.push_back(query);
+        }
+        if (!pending.empty()) {
+            placeQueries(group, hasPrefix, pending, pendingQueries, jobs, clauseToQuery[g], queryIndex);
+        }
+        for (std::vector<std::pair<unsigned int, std::string> >::iterator i = duplicates.begin(), e = duplicates.end(); i != e; ++i) {
+            clauseToQuery[g][i->first] = queryIndex[i->second];
+        }
+    }
+    if (jobs.empty()) {
+        return;
+    }
+
+    std::vector<std::vector<char> > answers;
+    decideAll(jobs, answers);
+
+    for (unsigned int g = 0; g < groups.size(); ++g) {
+        for (unsigned int i = 0; i < res[g].size(); ++i) {
+            if (!needsSolver[g][i]) {
+                continue;
+            }
+            char answer = answers[clauseToQuery[g][i].first][clauseToQuery[g][i].second];
+            if (answer == Unknown) {
+                // the clause is kept unless the fallback shows it to be
+                // unsatisfiable; without limits there is no fallback
+                res[g][i] = (m_limits != NULL && m_limits->getPolicy() == FallBackToChecker && m_fallbackChecker.check(groups[g].clauses[i]) == LinearChecker::Unsat);
+            } else {
+                res[g][i] = (answer == Unsat);
+            }
+        }
+    }
+    if (m_cache != NULL) {
+        for (unsigned int j = 0; j < jobs.size(); ++j) {
+            for (unsigned int q = 0; q < jobs[j].clauses.size(); ++q) {
+                if (answers[j][q] != Unknown) {
+                    m_cache->insert(jobs[j].clauses[q].text, answers[j][q] == Unsat);
+                }
+            }
+        }
+    }
+}
+
+bool EliminateClass::isIncremental() const
+{
+    return false;
+}
+
+void EliminateClass::pushPrefix(const Query &, unsigned int)
+{
+    std::cerr << "Internal error in EliminateClass class (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+    exit(277);
+}
+
+EliminateClass::Answer EliminateClass::decideExtension(const Query &, unsigned long, unsigned int)
+{
+    std::cerr << "Internal error in EliminateClass class (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+    exit(277);
+}
+
+void EliminateClass::popPrefix(unsigned int)
+{
+    std::cerr << "Internal error in EliminateClass class (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+    exit(277);
+}
+
+void EliminateClass::placeQueries(const ClauseGroup &group, bool hasPrefix, const std::vector<unsigned int> &pending, const std::vector<Query> &pendingQueries, std::vector<Job> &jobs, std::vector<std::pair<unsigned int, unsigned int> > &clauseToQuery, std::map<std::string, std::pair<unsigned int, unsigned int> > &queryIndex)
+{
+    Job job;
+    if (hasPrefix && pending.size() > 1 && isIncremental()) {
+        std::map<Symbol, unsigned int> numbering;
+        job.incremental = QueryCanonicalizer::canonicalize(group.prefix, numbering, job.prefix.canonical);
+        job.prefix.isCanonical = true;
+        job.prefix.text = job.prefix.canonical.toSMTString();
+        for (std::vector<unsigned int>::const_iterator i = pending.begin(), e = pending.end(); i != e && job.incremental; ++i) {
+            std::map<Symbol, unsigned int> extensionNumbering = numbering;
+            Query extension;
+            job.incremental = QueryCanonicalizer::canonicalize(group.extensions[*i], extensionNumbering, extension.canonical);
+            extension.isCanonical = true;
+            extension.text = extension.canonical.toSMTString();
+            job.extensions.push_back(extension);
+        }
+    }
+    if (job.incremental) {
+        job.clauses = pendingQueries;
+        jobs.push_back(job);
+    }
+    for (unsigned int p = 0; p < pending.size(); ++p) {
+        // otherwise, every query is a job of its own
+        if (!job.incremental) {
+            jobs.push_back(Job());
+            jobs.back().clauses.push_back(pendingQueries[p]);
+        }
+        std::pair<unsigned int, unsigned int> index(static_cast<unsigned int>(jobs.size() - 1), job.incremental ? p : 0);
+        clauseToQuery[pending[p]] = index;
+        queryIndex[pendingQueries[p].text] = index;
+    }
+}
+
+static unsigned long now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<unsigned long>(ts.tv_sec) * 1000 + static_cast<unsigned long>(ts.tv_nsec) / 1000000;
+}
+
+EliminateClass::Answer EliminateClass::decideWithinLimits(const Query &query, bool extension, unsigned int worker)
+{
+    if (m_limits == NULL) {
+        return extension ? decideExtension(query, 0, worker) : decide(query, 0, worker);
+    }
+    unsigned long timeout;
+    if (!m_limits->getTimeout(timeout)) {
+        m_limits->addSkipped();
+        return Unknown;
+    }
+    unsigned long start = now();
+    Answer res = extension ? decideExtension(query, timeout, worker) : decide(query, timeout, worker);
+    m_limits->addTime(now() - start);
+    if (res == Unknown) {
+        m_limits->addTimeout();
+    }
+    return res;
+}
+
+void EliminateClass::decideJob(const Job &job, unsigned int worker, std::vector<char> &answers)
+{
+    answers.assign(job.clauses.size(), static_cast<char>(Sat));
+    if (!job.incremental) {
+        for (unsigned int q = 0; q < job.clauses.size(); ++q) {
+            answers[q] = static_cast<char>(decideWithinLimits(job.clauses[q], false, worker));
+        }
+        return;
+    }
+    pushPrefix(job.prefix, worker);
+    // an unsatisfiable prefix rules out all extensions
+    Query empty;
+    empty.isCanonical = true;
+    empty.canonical.variables = job.prefix.canonical.variables;
+    empty.canonical.declared = job.prefix.canonical.variables;
+    if (decideWithinLimits(empty, true, worker) == Unsat) {
+        answers.assign(job.clauses.size(), static_cast<char>(Unsat));
+    } else {
+        for (unsigned int q = 0; q < job.extensions.size(); ++q) {
+            answers[q] = static_cast<char>(decideWithinLimits(job.extensions[q], true, worker));
+        }
+    }
+    popPrefix(worker);
+}
+
+void EliminateClass::decideAll(const std::vector<Job> &jobs, std::vector<std::vector<char> > &answers)
+{
+    answers.resize(jobs.size());
+    m_tasks->decide(jobs, answers);
+}
+
+void EliminateClass::getQuery(ref<Constraint> c, Query &query)
+{
+    query.isCanonical = QueryCanonicalizer::canonicalize(c, query.canonical);
+    if (query.isCanonical) {
+        query.text = query.canonical.toSMTString();
+        return;
+    }
     std::ostringstream sstr;
-    sstr << "(set-logic QF_LIA)\n";
+    std::set<Symbol> symbols;
+    c->addVariablesToSet(symbols);
     std::set<std::string> vars;
-    c->addVariablesToSet(vars);
+    addNamesToSet(symbols, vars);
     for (std::set<std::string>::iterator vi = vars.begin(), ve = vars.end(); vi != ve; ++vi) {
         sstr << "(declare-fun " << *vi << " () Int)\n";
     }
     sstr << c->toSMTString(/* onlyLinearPart = */ true);
+    query.text = sstr.str();
+}
+
+EliminateClass::Answer EliminateClass::decide(const Query &query, unsigned long timeout, unsigned int)
+{
+    // Build SMT query
+    std::ostringstream sstr;
+    sstr << "(set-logic QF_LIA)\n";
+    sstr << query.text;
     sstr << "(check-sat)\n";
 
 
@@ -163,9 +894,13 @@ bool EliminateClass::shouldEliminateInternal(ref<Constraint> c)
     }
     close(file_out.second);
 
-    if (!callSolver(file_in.first, file_out.first)) {
+    bool timedOut = false;
+    if (!callSolver(file_in.first, file_out.first, timeout, timedOut)) {
         unlink(file_in.first.c_str());
         unlink(file_out.first.c_str());
+        if (timedOut) {
+            return Unknown;
+        }
         std::cerr << "Call to external solver failed (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
         exit(277);
     }
@@ -185,23 +920,48 @@ bool EliminateClass::shouldEliminateInternal(ref<Constraint> c)
     unlink(file_out.first.c_str());
 
     if (line == "unsat") {
-        return true;
+        return Unsat;
+    } else if (line == "unknown") {
+        return Unknown;
     } else {
-        return false;
+        return Sat;
     }
 }
 
-EliminateClass *eliminateClassFactory(SMTSolver solver)
+static const char *const cvc4Command[] = { "cvc4", "--lang=smt2", "--incremental", NULL };
+static const char *const mathSAT5Command[] = { "mathsat", NULL };
+static const char *const yices2Command[] = { "yices-smt2", "--incremental", NULL };
+static const char *const z3Command[] = { "z3", "-smt2", "-in", NULL };
+
+EliminateClass *eliminateClassFactory(SMTSolver solver, bool persistent, unsigned int workers)
 {
     switch (solver) {
     case CVC4Solver:
-        return new CVC4Eliminate();
+        if (persistent) {
+            return new SessionEliminate(cvc4Command, workers);
+        }
+        return new CVC4Eliminate(workers);
     case MathSAT5Solver:
-        return new MathSAT5Eliminate();
+        if (persistent) {
+            return new SessionEliminate(mathSAT5Command, workers);
+        }
+        return new MathSAT5Eliminate(workers);
     case Yices2Solver:
-        return new Yices2Eliminate();
+        if (persistent) {
+            return new SessionEliminate(yices2Command, workers);
+        }
+        return new Yices2Eliminate(workers);
     case Z3Solver:
-        return new Z3Eliminate();
+#if defined(LLVM2KITTEL_Z3_API)
+        return new Z3LibraryEliminate(workers);
+#else
+        if (persistent) {
+            return new SessionEliminate(z3Command, workers);
+        }
+        return new Z3Eliminate(workers);
+#endif
+    case BuiltinSolver:
+        return new BuiltinEliminate();
     case NoSolver:
         return new NoEliminate();
     default:
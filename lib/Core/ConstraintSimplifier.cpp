@@ -50,10 +50,10 @@ static std::list<ref<Atom> > getAtoms(ref<Constraint> c)
     return res;
 }
 
-static bool disjoint(std::set<std::string> &vars, std::set<std::string> &avars)
+static bool disjoint(std::set<Symbol> &vars, std::set<Symbol> &avars)
 {
-    for (std::set<std::string>::iterator i = avars.begin(), e = avars.end(); i != e; ++i) {
-        std::string v = *i;
+    for (std::set<Symbol>::iterator i = avars.begin(), e = avars.end(); i != e; ++i) {
+        Symbol v = *i;
         if (vars.find(v) != vars.end()) {
             return false;
         }
@@ -61,25 +61,16 @@ static bool disjoint(std::set<std::string> &vars, std::set<std::string> &avars)
     return true;
 }
 
-static bool alreadyThere(ref<Atom> a, std::list<ref<Atom> > &atoms)
-{
-    for (std::list<ref<Atom> >::iterator i = atoms.begin(), e = atoms.end(); i != e; ++i) {
-        ref<Atom> aa = *i;
-        if (a->equals(aa)) {
-            return true;
-        }
-    }
-    return false;
-}
-
-static std::list<ref<Atom> > filterAtoms(std::list<ref<Atom> > &atoms, std::set<std::string> &vars)
+static std::list<ref<Atom> > filterAtoms(std::list<ref<Atom> > &atoms, std::set<Symbol> &vars)
 {
     std::list<ref<Atom> > res;
+    // atoms are hash-consed, so duplicates are the same object
+    std::set<Atom*> seen;
     for (std::list<ref<Atom> >::iterator i = atoms.begin(), e = atoms.end(); i != e; ++i) {
         ref<Atom> a = *i;
-        std::set<std::string> avars;
+        std::set<Symbol> avars;
         a->addVariablesToSet(avars);
-        if (!disjoint(vars, avars) && !alreadyThere(a, res)) {
+        if (!disjoint(vars, avars) && seen.insert(a.get()).second) {
             res.push_back(a);
         }
     }
@@ -103,7 +94,7 @@ static ref<Rule> simplifyConstraints(ref<Rule> rule)
     if (c->getCType() == Constraint::CTrue) {
         return rule;
     }
-    std::set<std::string> vars;
+    std::set<Symbol> vars;
     lhs->addVariablesToSet(vars);
     rhs->addVariablesToSet(vars);
     std::list<ref<Atom> > atoms = getAtoms(c);
@@ -117,10 +108,10 @@ static ref<Rule> simplifyConstraints(ref<Rule> rule)
     }
 }
 
-std::list<ref<Rule> > simplifyConstraints(std::list<ref<Rule> > rules)
+std::list<ref<Rule> > simplifyConstraints(const std::list<ref<Rule> > &rules)
 {
     std::list<ref<Rule> > res;
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         res.push_back(simplifyConstraints(*i));
     }
     return res;
@@ -46,6 +46,7 @@ Converter::Converter(const llvm::Type *boolType, bool assumeIsControl, bool sele
     m_rules(),
     m_vars(),
     m_lhs(),
+    m_varIndex(),
     m_counter(0),
     m_phase1(true),
     m_globals(),
@@ -64,6 +65,7 @@ Converter::Converter(const llvm::Type *boolType, bool assumeIsControl, bool sele
     m_function(NULL),
     m_scc(),
     m_phiVars(),
+    m_phiTables(),
     m_boundedIntegers(boundedIntegers),
     m_unsignedEncoding(unsignedEncoding),
     m_bitwidthMap(),
@@ -124,12 +126,14 @@ void Converter::phase1(llvm::Function *function, std::set<llvm::Function*> &scc,
     m_rules.clear();
     m_vars.clear();
     m_lhs.clear();
+    m_varIndex.clear();
     m_returns.clear();
     m_idMap.clear();
     m_phiVars.clear();
+    m_phiTables.clear();
     m_controlPoints.clear();
-    m_controlPoints.insert(getEval(m_function, "start"));
-    m_controlPoints.insert(getEval(m_function, "stop"));
+    m_controlPoints.insert(Symbol(getEval(m_function, "start")));
+    m_controlPoints.insert(Symbol(getEval(m_function, "stop")));
     m_counter = 0;
     m_nondef = 0;
     m_entryBlock = &function->getEntryBlock();
@@ -137,35 +141,31 @@ void Converter::phase1(llvm::Function *function, std::set<llvm::Function*> &scc,
 
     for (llvm::Function::arg_iterator i = function->arg_begin(), e = function->arg_end(); i != e; ++i) {
         if (i->getType()->isIntegerTy() && i->getType() != m_boolType) {
-            m_vars.push_back(getVar(&*i));
+            addVar(&*i);
         }
     }
     llvm::Module *module = function->getParent();
     for (llvm::Module::global_iterator global = module->global_begin(), globale = module->global_end(); global != globale; ++global) {
         const llvm::Type *globalType = llvm::cast<llvm::PointerType>(global->getType())->getContainedType(0);
         if (globalType->isIntegerTy() && globalType != m_boolType) {
-            std::string var = getVar(&*global);
+            Symbol var = addVar(&*global);
             m_globals.push_back(&*global);
-            m_vars.push_back(var);
             if (m_boundedIntegers) {
-                m_bitwidthMap.insert(std::make_pair(var, llvm::cast<llvm::IntegerType>(globalType)->getBitWidth()));
+                m_bitwidthMap.insert(std::make_pair(var.getName(), llvm::cast<llvm::IntegerType>(globalType)->getBitWidth()));
             }
         }
     }
     if (!m_trivial) {
         m_phase1 = true;
         visit(function);
-    }
-
-    for (std::list<std::string>::iterator i = m_vars.begin(), e = m_vars.end(); i != e; ++i) {
-        m_lhs.push_back(Polynomial::create(*i));
+        buildPhiTables();
     }
 }
 
 void Converter::phase2(llvm::Function *function, std::set<llvm::Function*> &scc, MayMustMap &mmMap, std::map<llvm::Function*, std::set<llvm::GlobalVariable*> > &funcMayZap, TrueFalseMap &tfMap, std::set<llvm::BasicBlock*> &lcbs, ConditionMap &elcMap)
 {
     if (m_trivial) {
-        m_rules.push_back(Rule::create(Term::create(getEval(m_function, "start"), m_lhs), Term::create(getEval(m_function, "stop"), m_lhs), Constraint::_true));
+        m_rules.push_back(Transition(State(getEval(m_function, "start")), State(getEval(m_function, "stop")), Constraint::_true));
         return;
     }
     m_function = function;
@@ -183,65 +183,197 @@ void Converter::phase2(llvm::Function *function, std::set<llvm::Function*> &scc,
 
     // add rules from returns to stop
     for (std::list<llvm::BasicBlock*>::iterator i = m_returns.begin(), e = m_returns.end(); i != e; ++i) {
-        ref<Term> lhs = Term::create(getEval(*i, "out"), m_lhs);
-        ref<Term> rhs = Term::create(getEval(m_function, "stop"), m_lhs);
-        ref<Rule> rule = Rule::create(lhs, rhs, Constraint::_true);
+        State lhs(getEval(*i, "out"));
+        State rhs(getEval(m_function, "stop"));
+        Transition rule(lhs, rhs, Constraint::_true);
         m_rules.push_back(rule);
     }
 }
 
+Converter::State::State(const std::string &loc)
+  : location(loc),
+    updates(),
+    isForeign(false),
+    args()
+{}
+
+Converter::State::State(const std::string &loc, const Updates &newArgs)
+  : location(loc),
+    updates(newArgs),
+    isForeign(false),
+    args()
+{}
+
+Converter::State::State(const std::string &loc, const std::list<ref<Polynomial> > &foreignArgs)
+  : location(loc),
+    updates(),
+    isForeign(true),
+    args(foreignArgs)
+{}
+
+Converter::Transition::Transition(const State &from, const State &to, ref<Constraint> c)
+  : lhs(from),
+    rhs(to),
+    constraint(c)
+{}
+
 std::list<ref<Rule> > Converter::getRules()
 {
-    return m_rules;
+    std::list<ref<Rule> > res;
+    for (std::list<Transition>::iterator i = m_rules.begin(), e = m_rules.end(); i != e; ++i) {
+        res.push_back(Rule::create(toTerm(i->lhs), toTerm(i->rhs), i->constraint));
+    }
+    return res;
 }
 
+class Converter::Chain
+{
+public:
+    Chain(const State &to)
+      : rhs(to),
+        constraints()
+    {}
+
+    // over the variables of the starting location
+    State rhs;
+    // the constraints of the composed rules, in order
+    std::vector<ref<Constraint> > constraints;
+};
+
 std::list<ref<Rule> > Converter::getCondensedRules()
 {
-    std::list<ref<Rule> > good;
-    std::list<ref<Rule> > junk;
+    std::list<Transition> good;
+    RuleIndex junk;
     std::list<ref<Rule> > res;
-    for (std::list<ref<Rule> >::iterator i = m_rules.begin(), e = m_rules.end(); i != e; ++i) {
-        ref<Rule> rule = *i;
-        std::string f = rule->getLeft()->getFunctionSymbol();
+    for (std::list<Transition>::iterator i = m_rules.begin(), e = m_rules.end(); i != e; ++i) {
+        Symbol f = i->lhs.location;
         if (m_controlPoints.find(f) != m_controlPoints.end()) {
-            good.push_back(rule);
+            good.push_back(*i);
         } else {
-            junk.push_back(rule);
+            junk[f].push_back(*i);
         }
     }
-    for (std::list<ref<Rule> >::iterator i = good.begin(), e = good.end(); i != e; ++i) {
-        ref<Rule> rule = *i;
-        std::vector<ref<Rule> > todo;
-        todo.push_back(rule);
-        while (!todo.empty()) {
-            ref<Rule> r = *todo.begin();
-            todo.erase(todo.begin());
-            ref<Term> rhs = r->getRight();
-            std::string f = rhs->getFunctionSymbol();
-            if (m_controlPoints.find(f) != m_controlPoints.end()) {
-                res.push_back(r);
-            } else {
-                std::list<ref<Rule> > newtodo;
-                for (std::list<ref<Rule> >::iterator ii = junk.begin(), ee = junk.end(); ii != ee; ++ii) {
-                    ref<Rule> junkrule = *ii;
-                    if (junkrule->getLeft()->getFunctionSymbol() == f) {
-                        std::map<std::string, ref<Polynomial> > subby;
-                        std::list<ref<Polynomial> > rhsargs = rhs->getArgs();
-                        std::list<ref<Polynomial> >::iterator ai = rhsargs.begin();
-                        for (std::list<std::string>::iterator vi = m_vars.begin(), ve = m_vars.end(); vi != ve; ++vi, ++ai) {
-                            subby.insert(std::make_pair(*vi, *ai));
-                        }
-                        ref<Rule> newRule = Rule::create(r->getLeft(), junkrule->getRight()->instantiate(&subby), Operator::create(r->getConstraint(), junkrule->getConstraint()->instantiate(&subby), Operator::And));
-                        newtodo.push_back(newRule);
-                    }
-                }
-                todo.insert(todo.begin(), newtodo.begin(), newtodo.end());
+    // the chains from a non-control location are shared by all rules leading to it
+    std::map<Symbol, std::list<Chain> > chains;
+    for (std::list<Transition>::iterator i = good.begin(), e = good.end(); i != e; ++i) {
+        ref<Term> lhs = toTerm(i->lhs);
+        Symbol f = i->rhs.location;
+        if (m_controlPoints.find(f) != m_controlPoints.end()) {
+            res.push_back(Rule::create(lhs, toTerm(i->rhs), i->constraint));
+            continue;
+        }
+        const std::list<Chain> &fchains = getChains(f, junk, chains);
+        Updates &subby = i->rhs.updates;
+        for (std::list<Chain>::const_iterator ci = fchains.begin(), ce = fchains.end(); ci != ce; ++ci) {
+            ref<Constraint> c = i->constraint;
+            for (std::vector<ref<Constraint> >::const_iterator ki = ci->constraints.begin(), ke = ci->constraints.end(); ki != ke; ++ki) {
+                c = Operator::create(c, (*ki)->instantiate(&subby), Operator::And);
             }
+            res.push_back(Rule::create(lhs, toTerm(compose(ci->rhs, subby)), c));
         }
     }
     return res;
 }
 
+const std::list<Converter::Chain> &Converter::getChains(const Symbol &f, RuleIndex &outgoing, std::map<Symbol, std::list<Chain> > &chains)
+{
+    // the chains of a location are composed once those of its successors are known
+    std::vector<Symbol> todo;
+    todo.push_back(f);
+    while (!todo.empty()) {
+        Symbol g = todo.back();
+        if (chains.find(g) != chains.end()) {
+            todo.pop_back();
+            continue;
+        }
+        RuleIndex::iterator out = outgoing.find(g);
+        bool ready = true;
+        if (out != outgoing.end()) {
+            for (std::list<Transition>::iterator i = out->second.begin(), e = out->second.end(); i != e; ++i) {
+                Symbol h = i->rhs.location;
+                if (m_controlPoints.find(h) == m_controlPoints.end() && chains.find(h) == chains.end()) {
+                    todo.push_back(h);
+                    ready = false;
+                }
+            }
+        }
+        if (!ready) {
+            continue;
+        }
+        todo.pop_back();
+        std::list<Chain> &gchains = chains[g];
+        if (out == outgoing.end()) {
+            continue;
+        }
+        for (std::list<Transition>::iterator i = out->second.begin(), e = out->second.end(); i != e; ++i) {
+            Symbol h = i->rhs.location;
+            if (m_controlPoints.find(h) != m_controlPoints.end()) {
+                Chain chain(i->rhs);
+                chain.constraints.push_back(i->constraint);
+                gchains.push_back(chain);
+                continue;
+            }
+            const std::list<Chain> &hchains = chains[h];
+            Updates &subby = i->rhs.updates;
+            for (std::list<Chain>::const_iterator ci = hchains.begin(), ce = hchains.end(); ci != ce; ++ci) {
+                Chain chain(compose(ci->rhs, subby));
+                chain.constraints.push_back(i->constraint);
+                for (std::vector<ref<Constraint> >::const_iterator ki = ci->constraints.begin(), ke = ci->constraints.end(); ki != ke; ++ki) {
+                    chain.constraints.push_back((*ki)->instantiate(&subby));
+                }
+                gchains.push_back(chain);
+            }
+        }
+    }
+    return chains[f];
+}
+
+// the state reached by first applying updates and then going to state
+Converter::State Converter::compose(const State &state, Updates &updates)
+{
+    if (state.isForeign) {
+        std::list<ref<Polynomial> > args;
+        for (std::list<ref<Polynomial> >::const_iterator i = state.args.begin(), e = state.args.end(); i != e; ++i) {
+            args.push_back((*i)->instantiate(&updates));
+        }
+        return State(state.location.getName(), args);
+    }
+    Updates res = updates;
+    for (Updates::const_iterator i = state.updates.begin(), e = state.updates.end(); i != e; ++i) {
+        res[i->first] = i->second->instantiate(&updates);
+    }
+    return State(state.location.getName(), res);
+}
+
+ref<Term> Converter::toTerm(const State &state)
+{
+    if (state.isForeign) {
+        return Term::create(state.location, state.args);
+    } else if (state.updates.empty()) {
+        return Term::create(state.location, m_lhs);
+    }
+    std::list<ref<Polynomial> > args;
+    std::vector<ref<Polynomial> >::iterator pp = m_lhs.begin();
+    for (std::vector<Symbol>::iterator i = m_vars.begin(), e = m_vars.end(); i != e; ++i, ++pp) {
+        Updates::const_iterator found = state.updates.find(*i);
+        if (found == state.updates.end()) {
+            args.push_back(*pp);
+        } else {
+            args.push_back(found->second);
+        }
+    }
+    return Term::create(state.location, args);
+}
+
+Symbol Converter::addVar(llvm::Value *V)
+{
+    Symbol var(getVar(V));
+    m_varIndex.insert(std::make_pair(V, static_cast<unsigned int>(m_vars.size())));
+    m_vars.push_back(var);
+    m_lhs.push_back(Polynomial::create(var));
+    return var;
+}
+
 std::string Converter::getVar(llvm::Value *V)
 {
     std::string name = V->getName();
@@ -267,7 +399,7 @@ std::string Converter::getEval(llvm::BasicBlock *bb, std::string inout)
     tmp << "eval_" << bb->getName().str() << '_' << inout;
     std::string res = tmp.str();
     if (inout == "in" && (!m_onlyMultiPredIsControl || bb->getUniquePredecessor() == NULL)) {
-        m_controlPoints.insert(res);
+        m_controlPoints.insert(Symbol(res));
     }
     return res;
 }
@@ -282,98 +414,58 @@ std::string Converter::getEval(llvm::Function *func, std::string startstop)
 ref<Polynomial> Converter::getPolynomial(llvm::Value *V)
 {
     if (llvm::isa<llvm::ConstantInt>(V)) {
-        mpz_t value;
-        mpz_init(value);
         if (m_boundedIntegers && m_unsignedEncoding) {
             uint64_t cv = static_cast<llvm::ConstantInt*>(V)->getZExtValue();
-            std::ostringstream tmp;
-            tmp << cv;
-            gmp_sscanf(tmp.str().data(), "%Zu", value);
+            return Polynomial::create(Integer::fromUnsigned(cv));
         } else {
             int64_t cv = static_cast<llvm::ConstantInt*>(V)->getSExtValue();
-            std::ostringstream tmp;
-            tmp << cv;
-            gmp_sscanf(tmp.str().data(), "%Zd", value);
+            return Polynomial::create(Integer(cv));
         }
-        ref<Polynomial> res = Polynomial::create(value);
-        mpz_clear(value);
-        return res;
     } else if (llvm::isa<llvm::Instruction>(V) || llvm::isa<llvm::Argument>(V) || llvm::isa<llvm::GlobalVariable>(V)) {
+        std::map<llvm::Value*, unsigned int>::iterator found = m_varIndex.find(V);
+        if (found != m_varIndex.end()) {
+            return m_lhs[found->second];
+        }
         return Polynomial::create(getVar(V));
     } else {
         return Polynomial::create(getNondef(V));
     }
 }
 
-std::list<ref<Polynomial> > Converter::getNewArgs(llvm::Value &V, ref<Polynomial> p)
+Converter::Updates Converter::getNewArgs(llvm::Value &V, ref<Polynomial> p)
 {
-    std::list<ref<Polynomial> > res;
-    std::string Vname = getVar(&V);
-    std::list<ref<Polynomial> >::iterator pp = m_lhs.begin();
-    for (std::list<std::string>::iterator i = m_vars.begin(), e = m_vars.end(); i != e; ++i, ++pp) {
-        if (Vname == *i) {
-            res.push_back(p);
-        } else {
-            res.push_back(*pp);
-        }
+    Updates res;
+    std::map<llvm::Value*, unsigned int>::iterator found = m_varIndex.find(&V);
+    if (found != m_varIndex.end()) {
+        res.insert(std::make_pair(m_vars[found->second], p));
     }
     return res;
 }
 
-std::list<ref<Polynomial> > Converter::getZappedArgs(std::set<llvm::GlobalVariable*> toZap)
+Converter::Updates Converter::getZappedArgs(const std::set<llvm::GlobalVariable*> &toZap)
 {
-    std::list<ref<Polynomial> > res;
-    std::list<ref<Polynomial> >::iterator pp = m_lhs.begin();
-    for (std::list<std::string>::iterator i = m_vars.begin(), e = m_vars.end(); i != e; ++i, ++pp) {
-        bool doZap = false;
-        const llvm::Type *zapType = NULL;
-        for (std::set<llvm::GlobalVariable*>::iterator zap = toZap.begin(), zape = toZap.end(); zap != zape; ++zap) {
-            if (getVar(*zap) == *i) {
-                doZap = true;
-                zapType = llvm::cast<llvm::PointerType>((*zap)->getType())->getContainedType(0);
-                break;
-            }
+    Updates res;
+    // the globals are in the same order as their variables
+    for (std::list<llvm::GlobalVariable*>::iterator i = m_globals.begin(), e = m_globals.end(); i != e; ++i) {
+        if (toZap.find(*i) == toZap.end()) {
+            continue;
         }
-        if (doZap) {
-            std::string nondef = getNondef(NULL);
-            if (m_boundedIntegers) {
-                m_bitwidthMap.insert(std::make_pair(nondef, llvm::cast<llvm::IntegerType>(zapType)->getBitWidth()));
-            }
-            res.push_back(Polynomial::create(nondef));
-        } else {
-            res.push_back(*pp);
+        const llvm::Type *zapType = llvm::cast<llvm::PointerType>((*i)->getType())->getContainedType(0);
+        std::string nondef = getNondef(NULL);
+        if (m_boundedIntegers) {
+            m_bitwidthMap.insert(std::make_pair(nondef, llvm::cast<llvm::IntegerType>(zapType)->getBitWidth()));
         }
+        res.insert(std::make_pair(m_vars[m_varIndex[*i]], Polynomial::create(nondef)));
     }
     return res;
 }
 
-std::list<ref<Polynomial> > Converter::getZappedArgs(std::set<llvm::GlobalVariable*> toZap, llvm::Value &V, ref<Polynomial> p)
+Converter::Updates Converter::getZappedArgs(const std::set<llvm::GlobalVariable*> &toZap, llvm::Value &V, ref<Polynomial> p)
 {
-    std::list<ref<Polynomial> > res;
-    std::string Vname = getVar(&V);
-    std::list<ref<Polynomial> >::iterator pp = m_lhs.begin();
-    for (std::list<std::string>::iterator i = m_vars.begin(), e = m_vars.end(); i != e; ++i, ++pp) {
-        bool doZap = false;
-        const llvm::Type *zapType = NULL;
-        for (std::set<llvm::GlobalVariable*>::iterator zap = toZap.begin(), zape = toZap.end(); zap != zape; ++zap) {
-            if (getVar(*zap) == *i) {
-                doZap = true;
-                zapType = llvm::cast<llvm::PointerType>((*zap)->getType())->getContainedType(0);
-                break;
-            }
-        }
-        if (doZap) {
-            std::string nondef = getNondef(NULL);
-            if (m_boundedIntegers) {
-                m_bitwidthMap.insert(std::make_pair(nondef, llvm::cast<llvm::IntegerType>(zapType)->getBitWidth()));
-            }
-            res.push_back(Polynomial::create(nondef));
-        } else if (Vname == *i) {
-            res.push_back(p);
-        } else {
-            res.push_back(*pp);
-        }
-    }
+    Updates res = getZappedArgs(toZap);
+    Updates value = getNewArgs(V, p);
+    // zapping takes precedence
+    res.insert(value.begin(), value.end());
     return res;
 }
 
@@ -645,9 +737,9 @@ void Converter::visitBB(llvm::BasicBlock *bb)
 {
     // start
     if (bb == m_entryBlock) {
-        ref<Term> lhs = Term::create(getEval(m_function, "start"), m_lhs);
-        ref<Term> rhs = Term::create(getEval(bb, "in"), m_lhs);
-        ref<Rule> rule = Rule::create(lhs, rhs, Constraint::_true);
+        State lhs(getEval(m_function, "start"));
+        State rhs(getEval(bb, "in"));
+        Transition rule(lhs, rhs, Constraint::_true);
         m_rules.push_back(rule);
     }
 
@@ -690,14 +782,14 @@ void Converter::visitBB(llvm::BasicBlock *bb)
         }
     }
     if (first != NULL) {
-        ref<Term> lhs = Term::create(getEval(bb, "in"), m_lhs);
-        ref<Term> rhs = Term::create(getEval(firstID), m_lhs);
-        ref<Rule> rule = Rule::create(lhs, rhs, cond);
+        State lhs(getEval(bb, "in"));
+        State rhs(getEval(firstID));
+        Transition rule(lhs, rhs, cond);
         m_rules.push_back(rule);
     } else {
-        ref<Term> lhs = Term::create(getEval(bb, "in"), m_lhs);
-        ref<Term> rhs = Term::create(getEval(bb, "out"), m_lhs);
-        ref<Rule> rule = Rule::create(lhs, rhs, cond);
+        State lhs(getEval(bb, "in"));
+        State rhs(getEval(bb, "out"));
+        Transition rule(lhs, rhs, cond);
         m_rules.push_back(rule);
     }
 
@@ -716,10 +808,10 @@ void Converter::visitBB(llvm::BasicBlock *bb)
         }
     }
     if (last != NULL) {
-        ref<Term> lhs = Term::create(getEval(lastID+1), m_lhs);
+        State lhs(getEval(lastID+1));
         m_counter++;
-        ref<Term> rhs = Term::create(getEval(bb, "out"), m_lhs);
-        ref<Rule> rule = Rule::create(lhs, rhs, Constraint::_true);
+        State rhs(getEval(bb, "out"));
+        Transition rule(lhs, rhs, Constraint::_true);
         m_rules.push_back(rule);
     }
 
@@ -727,68 +819,77 @@ void Converter::visitBB(llvm::BasicBlock *bb)
     llvm::TerminatorInst *terminator = bb->getTerminator();
     if (llvm::isa<llvm::ReturnInst>(terminator)) {
     } else if (llvm::isa<llvm::UnreachableInst>(terminator)) {
-        ref<Term> lhs = Term::create(getEval(bb, "out"), m_lhs);
-        ref<Term> rhs = Term::create(getEval(m_function, "stop"), m_lhs);
-        ref<Rule> rule = Rule::create(lhs, rhs, Constraint::_true);
+        State lhs(getEval(bb, "out"));
+        State rhs(getEval(m_function, "stop"));
+        Transition rule(lhs, rhs, Constraint::_true);
         m_rules.push_back(rule);
     } else {
         llvm::BranchInst *branch = llvm::cast<llvm::BranchInst>(terminator);
         bool useCondition = (!m_onlyLoopConditions || m_loopConditionBlocks.find(bb) != m_loopConditionBlocks.end());
         if (branch->isUnconditional()) {
-            ref<Term> lhs = Term::create(getEval(bb, "out"), m_lhs);
-            ref<Term> rhs = Term::create(getEval(branch->getSuccessor(0), "in"), getArgsWithPhis(bb, branch->getSuccessor(0)));
-            ref<Rule> rule = Rule::create(lhs, rhs, Constraint::_true);
+            State lhs(getEval(bb, "out"));
+            State rhs(getEval(branch->getSuccessor(0), "in"), getArgsWithPhis(bb, branch->getSuccessor(0)));
+            Transition rule(lhs, rhs, Constraint::_true);
             m_rules.push_back(rule);
         } else {
-            ref<Term> lhs = Term::create(getEval(bb, "out"), m_lhs);
-            ref<Term> rhs1 = Term::create(getEval(branch->getSuccessor(0), "in"), getArgsWithPhis(bb, branch->getSuccessor(0)));
-            ref<Term> rhs2 = Term::create(getEval(branch->getSuccessor(1), "in"), getArgsWithPhis(bb, branch->getSuccessor(1)));
+            State lhs(getEval(bb, "out"));
+            State rhs1(getEval(branch->getSuccessor(0), "in"), getArgsWithPhis(bb, branch->getSuccessor(0)));
+            State rhs2(getEval(branch->getSuccessor(1), "in"), getArgsWithPhis(bb, branch->getSuccessor(1)));
             ref<Constraint> c = getConditionFromValue(branch->getCondition());
-            ref<Rule> rule1 = Rule::create(lhs, rhs1, useCondition ? c->toNNF(false) : Constraint::_true);
+            Transition rule1(lhs, rhs1, useCondition ? c->toNNF(false) : Constraint::_true);
             m_rules.push_back(rule1);
-            ref<Rule> rule2 = Rule::create(lhs, rhs2, useCondition ? c->toNNF(true) : Constraint::_true);
+            Transition rule2(lhs, rhs2, useCondition ? c->toNNF(true) : Constraint::_true);
             m_rules.push_back(rule2);
         }
     }
 }
 
-std::list<ref<Polynomial> > Converter::getArgsWithPhis(llvm::BasicBlock *from, llvm::BasicBlock *to)
+void Converter::buildPhiTables()
 {
-    std::list<ref<Polynomial> > res;
-    std::map<std::string, ref<Polynomial> > phiValues;
-    for (llvm::BasicBlock::iterator i = to->begin(), e = to->end(); i != e; ++i) {
-        if (!llvm::isa<llvm::PHINode>(*i)) {
-            break;
-        }
-        llvm::PHINode *phi = llvm::cast<llvm::PHINode>(i);
-        if (phi->getType() == m_boolType || !phi->getType()->isIntegerTy()) {
-            continue;
-        }
-        std::string PHIName = getVar(phi);
-        phiValues.insert(std::make_pair(PHIName, getPolynomial(phi->getIncomingValueForBlock(from))));
-    }
-    std::list<ref<Polynomial> >::iterator pp = m_lhs.begin();
-    for (std::list<std::string>::iterator i = m_vars.begin(), e = m_vars.end(); i != e; ++i, ++pp) {
-        std::map<std::string, ref<Polynomial> >::iterator found = phiValues.find(*i);
-        if (found == phiValues.end()) {
-            res.push_back(*pp);
-        } else {
-            res.push_back(found->second);
+    for (llvm::Function::iterator bb = m_function->begin(), end = m_function->end(); bb != end; ++bb) {
+        for (llvm::BasicBlock::iterator i = bb->begin(), e = bb->end(); i != e; ++i) {
+            if (!llvm::isa<llvm::PHINode>(*i)) {
+                break;
+            }
+            llvm::PHINode *phi = llvm::cast<llvm::PHINode>(i);
+            if (phi->getType() == m_boolType || !phi->getType()->isIntegerTy()) {
+                continue;
+            }
+            unsigned int position = m_varIndex[phi];
+            for (unsigned int in = 0, ine = phi->getNumIncomingValues(); in < ine; ++in) {
+                PhiTable &table = m_phiTables[std::make_pair(phi->getIncomingBlock(in), &*bb)];
+                // a predecessor with several edges to bb occurs more than once
+                if (table.empty() || table.back().first != position) {
+                    table.push_back(std::make_pair(position, phi->getIncomingValue(in)));
+                }
+            }
         }
     }
-    return res;
+}
+
+Converter::Updates Converter::getArgsWithPhis(llvm::BasicBlock *from, llvm::BasicBlock *to)
+{
+    Updates phiValues;
+    std::map<std::pair<llvm::BasicBlock*, llvm::BasicBlock*>, PhiTable>::iterator found = m_phiTables.find(std::make_pair(from, to));
+    if (found == m_phiTables.end()) {
+        return phiValues;
+    }
+    for (PhiTable::iterator i = found->second.begin(), e = found->second.end(); i != e; ++i) {
+        phiValues.insert(std::make_pair(m_vars[i->first], getPolynomial(i->second)));
+    }
+    return phiValues;
 }
 
 void Converter::visitTerminatorInst(llvm::TerminatorInst&)
 {}
 
-void Converter::visitGenericInstruction(llvm::Instruction &I, std::list<ref<Polynomial> > newArgs, ref<Constraint> c)
+void Converter::visitGenericInstruction(llvm::Instruction &I, const Updates &newArgs, ref<Constraint> c)
 {
     m_idMap.insert(std::make_pair(&I, m_counter));
-    ref<Term> lhs = Term::create(getEval(m_counter), m_lhs);
+    State lhs(getEval(m_counter));
     ++m_counter;
-    ref<Term> rhs = Term::create(getEval(m_counter), newArgs);
-    ref<Rule> rule = Rule::create(lhs, rhs, c);
+    State rhs(getEval(m_counter), newArgs);
+    Transition rule(lhs, rhs, c);
     m_blockRules.push_back(rule);
 }
 
@@ -803,7 +904,7 @@ void Converter::visitAdd(llvm::BinaryOperator &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         ref<Polynomial> p1 = getPolynomial(I.getOperand(0));
         ref<Polynomial> p2 = getPolynomial(I.getOperand(1));
@@ -817,7 +918,7 @@ void Converter::visitSub(llvm::BinaryOperator &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         ref<Polynomial> p1 = getPolynomial(I.getOperand(0));
         ref<Polynomial> p2 = getPolynomial(I.getOperand(1));
@@ -831,7 +932,7 @@ void Converter::visitMul(llvm::BinaryOperator &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         ref<Polynomial> p1 = getPolynomial(I.getOperand(0));
         ref<Polynomial> p2 = getPolynomial(I.getOperand(1));
@@ -1017,7 +1118,7 @@ void Converter::visitSDiv(llvm::BinaryOperator &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         ref<Polynomial> nondef = Polynomial::create(getNondef(&I));
         ref<Constraint> divC;
@@ -1116,7 +1217,7 @@ void Converter::visitUDiv(llvm::BinaryOperator &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         ref<Polynomial> nondef = Polynomial::create(getNondef(&I));
         ref<Constraint> divC;
@@ -1255,7 +1356,7 @@ void Converter::visitSRem(llvm::BinaryOperator &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         ref<Polynomial> nondef = Polynomial::create(getNondef(&I));
         ref<Constraint> remC;
@@ -1347,7 +1448,7 @@ void Converter::visitURem(llvm::BinaryOperator &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         ref<Polynomial> nondef = Polynomial::create(getNondef(&I));
         ref<Constraint> remC;
@@ -1412,7 +1513,7 @@ void Converter::visitAnd(llvm::BinaryOperator &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         if (m_boundedIntegers && m_bitwiseConditions) {
             ref<Polynomial> x = getPolynomial(I.getOperand(0));
@@ -1473,7 +1574,7 @@ void Converter::visitOr(llvm::BinaryOperator &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         if (m_boundedIntegers && m_bitwiseConditions) {
             ref<Polynomial> x = getPolynomial(I.getOperand(0));
@@ -1494,7 +1595,7 @@ void Converter::visitXor(llvm::BinaryOperator &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         if (llvm::isa<llvm::ConstantInt>(I.getOperand(1)) && llvm::cast<llvm::ConstantInt>(I.getOperand(1))->isAllOnesValue()) {
             // it is xor %i, -1 --> actually, it is -%i - 1
@@ -1512,7 +1613,7 @@ void Converter::visitCallInst(llvm::CallInst &I)
 {
     if (m_phase1) {
         if (I.getType() != m_boolType && I.getType()->isIntegerTy()) {
-            m_vars.push_back(getVar(&I));
+            addVar(&I);
         }
     } else {
         llvm::CallSite callSite(&I);
@@ -1521,10 +1622,10 @@ void Converter::visitCallInst(llvm::CallInst &I)
             llvm::StringRef functionName = calledFunction->getName();
             if (functionName == "__kittel_assume") {
                 if (m_assumeIsControl) {
-                    m_controlPoints.insert(getEval(m_counter));
+                    m_controlPoints.insert(Symbol(getEval(m_counter)));
                 }
                 ref<Constraint> c = m_onlyLoopConditions ? Constraint::_true : getConditionFromValue(callSite.getArgument(0));
-                visitGenericInstruction(I, m_lhs, c->toNNF(false));
+                visitGenericInstruction(I, Updates(), c->toNNF(false));
                 return;
             } else if (functionName.startswith("__kittel_nondef")) {
                 ref<Polynomial> nondef = Polynomial::create(getNondef(&I));
@@ -1533,9 +1634,9 @@ void Converter::visitCallInst(llvm::CallInst &I)
             }
         }
         if (m_complexityTuples) {
-            m_controlPoints.insert(getEval(m_counter));
-            m_controlPoints.insert(getEval(m_counter + 1));
-            m_complexityLHSs.insert(getEval(m_counter));
+            m_controlPoints.insert(Symbol(getEval(m_counter)));
+            m_controlPoints.insert(Symbol(getEval(m_counter + 1)));
+            m_complexityLHSs.insert(Symbol(getEval(m_counter)));
         }
         // "random" functions
         if (I.getType()->isIntegerTy() || I.getType()->isVoidTy() || I.getType()->isFloatingPointTy() || I.getType()->isPointerTy() || I.getType()->isVectorTy() || I.getType()->isStructTy() || I.getType()->isArrayTy()) {
@@ -1547,7 +1648,7 @@ void Converter::visitCallInst(llvm::CallInst &I)
             }
             std::set<llvm::GlobalVariable*> toZap;
             m_idMap.insert(std::make_pair(&I, m_counter));
-            ref<Term> lhs = Term::create(getEval(m_counter), m_lhs);
+            State lhs(getEval(m_counter));
             for (std::list<llvm::Function*>::iterator cf = callees.begin(), cfe = callees.end(); cf != cfe; ++cf) {
                 llvm::Function *callee = *cf;
                 if (m_scc.find(callee) != m_scc.end() || m_complexityTuples) {
@@ -1561,9 +1662,9 @@ void Converter::visitCallInst(llvm::CallInst &I)
                     for (std::list<llvm::GlobalVariable*>::iterator i = m_globals.begin(), e = m_globals.end(); i != e; ++i) {
                         callArgs.push_back(getPolynomial(*i));
                     }
-                    m_controlPoints.insert(getEval(callee, "start"));
-                    ref<Term> rhs2 = Term::create(getEval(callee, "start"), callArgs);
-                    ref<Rule> rule2 = Rule::create(lhs, rhs2, Constraint::_true);
+                    m_controlPoints.insert(Symbol(getEval(callee, "start")));
+                    State rhs2(getEval(callee, "start"), callArgs);
+                    Transition rule2(lhs, rhs2, Constraint::_true);
                     m_blockRules.push_back(rule2);
                 }
                 if (callee->isDeclaration()) {
@@ -1580,15 +1681,15 @@ void Converter::visitCallInst(llvm::CallInst &I)
             }
             m_counter++;
             // zap!
-            std::list<ref<Polynomial> > newArgs;
+            Updates newArgs;
             if (I.getType()->isIntegerTy() && I.getType() != m_boolType) {
                 ref<Polynomial> nondef = Polynomial::create(getNondef(&I));
                 newArgs = getZappedArgs(toZap, I, nondef);
             } else {
                 newArgs = getZappedArgs(toZap);
             }
-            ref<Term> rhs1 = Term::create(getEval(m_counter), newArgs);
-            ref<Rule> rule1 = Rule::create(lhs, rhs1, Constraint::_true);
+            State rhs1(getEval(m_counter), newArgs);
+            Transition rule1(lhs, rhs1, Constraint::_true);
             m_blockRules.push_back(rule1);
             return;
         } else {
@@ -1631,20 +1732,20 @@ void Converter::visitSelectInst(llvm::SelectInst &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         if (m_selectIsControl) {
-            m_controlPoints.insert(getEval(m_counter));
+            m_controlPoints.insert(Symbol(getEval(m_counter)));
         }
         m_idMap.insert(std::make_pair(&I, m_counter));
-        ref<Term> lhs = Term::create(getEval(m_counter), m_lhs);
+        State lhs(getEval(m_counter));
         m_counter++;
-        ref<Term> rhs1 = Term::create(getEval(m_counter), getNewArgs(I, getPolynomial(I.getTrueValue())));
-        ref<Term> rhs2 = Term::create(getEval(m_counter), getNewArgs(I, getPolynomial(I.getFalseValue())));
+        State rhs1(getEval(m_counter), getNewArgs(I, getPolynomial(I.getTrueValue())));
+        State rhs2(getEval(m_counter), getNewArgs(I, getPolynomial(I.getFalseValue())));
         ref<Constraint> c = getConditionFromValue(I.getCondition());
-        ref<Rule> rule1 = Rule::create(lhs, rhs1, m_onlyLoopConditions ? Constraint::_true : c->toNNF(false));
+        Transition rule1(lhs, rhs1, m_onlyLoopConditions ? Constraint::_true : c->toNNF(false));
         m_blockRules.push_back(rule1);
-        ref<Rule> rule2 = Rule::create(lhs, rhs2, m_onlyLoopConditions ? Constraint::_true : c->toNNF(true));
+        Transition rule2(lhs, rhs2, m_onlyLoopConditions ? Constraint::_true : c->toNNF(true));
         m_blockRules.push_back(rule2);
     }
 }
@@ -1655,9 +1756,7 @@ void Converter::visitPHINode(llvm::PHINode &I)
         return;
     }
     if (m_phase1) {
-        std::string phiVar = getVar(&I);
-        m_vars.push_back(phiVar);
-        m_phiVars.insert(phiVar);
+        m_phiVars.insert(addVar(&I));
     } else {
     }
 }
@@ -1674,7 +1773,7 @@ void Converter::visitBitCastInst(llvm::BitCastInst &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         ref<Polynomial> value = getPolynomial(&I);
         visitGenericInstruction(I, value);
@@ -1684,7 +1783,7 @@ void Converter::visitBitCastInst(llvm::BitCastInst &I)
 void Converter::visitPtrToIntInst(llvm::PtrToIntInst &I)
 {
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         ref<Polynomial> nondef = Polynomial::create(getNondef(&I));
         visitGenericInstruction(I, nondef);
@@ -1697,7 +1796,7 @@ void Converter::visitLoadInst(llvm::LoadInst &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         MayMustMap::iterator it = m_mmMap.find(&I);
         if (it == m_mmMap.end()) {
@@ -1710,16 +1809,16 @@ void Converter::visitLoadInst(llvm::LoadInst &I)
         ref<Polynomial> newArg;
         if (musts.size() == 1 && mays.size() == 0) {
             // unique!
-            newArg = Polynomial::create(getVar(*musts.begin()));
+            newArg = getPolynomial(*musts.begin());
         } else {
             // nondef...
             newArg = Polynomial::create(getNondef(&I));
         }
         m_idMap.insert(std::make_pair(&I, m_counter));
-        ref<Term> lhs = Term::create(getEval(m_counter), m_lhs);
+        State lhs(getEval(m_counter));
         ++m_counter;
-        ref<Term> rhs = Term::create(getEval(m_counter), getNewArgs(I, newArg));
-        ref<Rule> rule = Rule::create(lhs, rhs, Constraint::_true);
+        State rhs(getEval(m_counter), getNewArgs(I, newArg));
+        Transition rule(lhs, rhs, Constraint::_true);
         m_blockRules.push_back(rule);
     }
 }
@@ -1737,7 +1836,7 @@ void Converter::visitStoreInst(llvm::StoreInst &I)
         MayMustPair mmp = it->second;
         std::set<llvm::GlobalVariable*> mays = mmp.first;
         std::set<llvm::GlobalVariable*> musts = mmp.second;
-        std::list<ref<Polynomial> > newArgs;
+        Updates newArgs;
         if (musts.size() == 1 && mays.size() == 0) {
             // unique!
             newArgs = getNewArgs(**musts.begin(), getPolynomial(val));
@@ -1749,10 +1848,10 @@ void Converter::visitStoreInst(llvm::StoreInst &I)
             newArgs = getZappedArgs(mays);
         }
         m_idMap.insert(std::make_pair(&I, m_counter));
-        ref<Term> lhs = Term::create(getEval(m_counter), m_lhs);
+        State lhs(getEval(m_counter));
         ++m_counter;
-        ref<Term> rhs = Term::create(getEval(m_counter), newArgs);
-        ref<Rule> rule = Rule::create(lhs, rhs, Constraint::_true);
+        State rhs(getEval(m_counter), newArgs);
+        Transition rule(lhs, rhs, Constraint::_true);
         m_blockRules.push_back(rule);
     }
 }
@@ -1763,7 +1862,7 @@ void Converter::visitAllocaInst(llvm::AllocaInst &)
 void Converter::visitFPToSIInst(llvm::FPToSIInst &I)
 {
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         ref<Polynomial> nondef = Polynomial::create(getNondef(&I));
         visitGenericInstruction(I, nondef);
@@ -1773,7 +1872,7 @@ void Converter::visitFPToSIInst(llvm::FPToSIInst &I)
 void Converter::visitFPToUIInst(llvm::FPToUIInst &I)
 {
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         ref<Polynomial> nondef = Polynomial::create(getNondef(&I));
         visitGenericInstruction(I, nondef);
@@ -1786,7 +1885,7 @@ void Converter::visitInstruction(llvm::Instruction &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         ref<Polynomial> nondef = Polynomial::create(getNondef(&I));
         visitGenericInstruction(I, nondef);
@@ -1796,10 +1895,10 @@ void Converter::visitInstruction(llvm::Instruction &I)
 void Converter::visitSExtInst(llvm::SExtInst &I)
 {
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         m_idMap.insert(std::make_pair(&I, m_counter));
-        ref<Term> lhs = Term::create(getEval(m_counter), m_lhs);
+        State lhs(getEval(m_counter));
         ref<Polynomial> copy = getPolynomial(I.getOperand(0));
         ++m_counter;
         if (m_boundedIntegers && m_unsignedEncoding) {
@@ -1810,18 +1909,18 @@ void Converter::visitSExtInst(llvm::SExtInst &I)
             ref<Polynomial> sizeDiff = sizeNew->sub(sizeOld);
             ref<Polynomial> intmaxOld = Polynomial::simax(bitwidthOld);
             ref<Polynomial> converted = sizeDiff->add(copy);
-            ref<Term> rhs1 = Term::create(getEval(m_counter), getNewArgs(I, copy));
-            ref<Term> rhs2 = Term::create(getEval(m_counter), getNewArgs(I, converted));
+            State rhs1(getEval(m_counter), getNewArgs(I, copy));
+            State rhs2(getEval(m_counter), getNewArgs(I, converted));
             ref<Constraint> c1 = Atom::create(copy, intmaxOld, Atom::Leq);
             ref<Constraint> c2 = Atom::create(copy, intmaxOld, Atom::Gtr);
-            ref<Rule> rule1 = Rule::create(lhs, rhs1, c1);
-            ref<Rule> rule2 = Rule::create(lhs, rhs2, c2);
+            Transition rule1(lhs, rhs1, c1);
+            Transition rule2(lhs, rhs2, c2);
             m_blockRules.push_back(rule1);
             m_blockRules.push_back(rule2);
         } else {
             // mathematical integers or bounded integers with signed encoding
-            ref<Term> rhs = Term::create(getEval(m_counter), getNewArgs(I, copy));
-            ref<Rule> rule = Rule::create(lhs, rhs, Constraint::_true);
+            State rhs(getEval(m_counter), getNewArgs(I, copy));
+            Transition rule(lhs, rhs, Constraint::_true);
             m_blockRules.push_back(rule);
         }
     }
@@ -1833,19 +1932,19 @@ void Converter::visitZExtInst(llvm::ZExtInst &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         m_idMap.insert(std::make_pair(&I, m_counter));
-        ref<Term> lhs = Term::create(getEval(m_counter), m_lhs);
+        State lhs(getEval(m_counter));
         ++m_counter;
         if (I.getOperand(0)->getType() == m_boolType) {
             ref<Polynomial> zero = Polynomial::null;
             ref<Polynomial> one = Polynomial::one;
-            ref<Term> rhszero = Term::create(getEval(m_counter), getNewArgs(I, zero));
-            ref<Term> rhsone = Term::create(getEval(m_counter), getNewArgs(I, one));
+            State rhszero(getEval(m_counter), getNewArgs(I, zero));
+            State rhsone(getEval(m_counter), getNewArgs(I, one));
             ref<Constraint> c = getConditionFromValue(I.getOperand(0));
-            ref<Rule> rulezero = Rule::create(lhs, rhszero, c->toNNF(true));
-            ref<Rule> ruleone = Rule::create(lhs, rhsone, c->toNNF(false));
+            Transition rulezero(lhs, rhszero, c->toNNF(true));
+            Transition ruleone(lhs, rhsone, c->toNNF(false));
             m_blockRules.push_back(rulezero);
             m_blockRules.push_back(ruleone);
         } else {
@@ -1854,19 +1953,19 @@ void Converter::visitZExtInst(llvm::ZExtInst &I)
                 unsigned int bitwidthOld = llvm::cast<llvm::IntegerType>(I.getOperand(0)->getType())->getBitWidth();
                 ref<Polynomial> shifter = Polynomial::power_of_two(bitwidthOld);
                 ref<Polynomial> converted = shifter->add(copy);
-                ref<Term> rhs1 = Term::create(getEval(m_counter), getNewArgs(I, copy));
-                ref<Term> rhs2 = Term::create(getEval(m_counter), getNewArgs(I, converted));
+                State rhs1(getEval(m_counter), getNewArgs(I, copy));
+                State rhs2(getEval(m_counter), getNewArgs(I, converted));
                 ref<Polynomial> zero = Polynomial::null;
                 ref<Constraint> c1 = Atom::create(copy, zero, Atom::Geq);
                 ref<Constraint> c2 = Atom::create(copy, zero, Atom::Lss);
-                ref<Rule> rule1 = Rule::create(lhs, rhs1, c1);
-                ref<Rule> rule2 = Rule::create(lhs, rhs2, c2);
+                Transition rule1(lhs, rhs1, c1);
+                Transition rule2(lhs, rhs2, c2);
                 m_blockRules.push_back(rule1);
                 m_blockRules.push_back(rule2);
             } else {
                 // mathematical integers of bounded integers with unsigned encoding
-                ref<Term> rhs = Term::create(getEval(m_counter), getNewArgs(I, copy));
-                ref<Rule> rule = Rule::create(lhs, rhs, Constraint::_true);
+                State rhs(getEval(m_counter), getNewArgs(I, copy));
+                Transition rule(lhs, rhs, Constraint::_true);
                 m_blockRules.push_back(rule);
             }
         }
@@ -1879,10 +1978,10 @@ void Converter::visitTruncInst(llvm::TruncInst &I)
         return;
     }
     if (m_phase1) {
-        m_vars.push_back(getVar(&I));
+        addVar(&I);
     } else {
         m_idMap.insert(std::make_pair(&I, m_counter));
-        ref<Term> lhs = Term::create(getEval(m_counter), m_lhs);
+        State lhs(getEval(m_counter));
         ref<Polynomial> val;
         if (m_boundedIntegers) {
             val = Polynomial::create(getNondef(&I));
@@ -1890,8 +1989,8 @@ void Converter::visitTruncInst(llvm::TruncInst &I)
             val = getPolynomial(I.getOperand(0));
         }
         m_counter++;
-        ref<Term> rhs = Term::create(getEval(m_counter), getNewArgs(I, val));
-        ref<Rule> rule = Rule::create(lhs, rhs, Constraint::_true);
+        State rhs(getEval(m_counter), getNewArgs(I, val));
+        Transition rule(lhs, rhs, Constraint::_true);
         m_blockRules.push_back(rule);
     }
 }
@@ -1924,7 +2023,7 @@ bool Converter::isAssumeArg(llvm::ZExtInst &I)
     return false;
 }
 
-std::set<std::string> Converter::getPhiVariables()
+std::set<Symbol> Converter::getPhiVariables()
 {
     return m_phiVars;
 }
@@ -1934,7 +2033,7 @@ std::map<std::string, unsigned int> Converter::getBitwidthMap()
     return m_bitwidthMap;
 }
 
-std::set<std::string> Converter::getComplexityLHSs()
+std::set<Symbol> Converter::getComplexityLHSs()
 {
     return m_complexityLHSs;
 }
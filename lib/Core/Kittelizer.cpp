@@ -7,75 +7,259 @@
 
 #include "llvm2kittel/Kittelizer.h"
 #include "llvm2kittel/IntTRS/Constraint.h"
+#include "llvm2kittel/IntTRS/DNF.h"
 #include "llvm2kittel/IntTRS/Term.h"
 #include "llvm2kittel/IntTRS/Rule.h"
+#include "llvm2kittel/Util/TaskPool.h"
 
 // C++ includes
-#include <iostream>
-#include <cstdlib>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
 
-ref<Constraint> simplify(ref<Constraint> c)
+// Upper bound on the number of clauses in the DNF of c (negated if negate),
+// saturating above cap
+static unsigned long estimateDNFSize(ref<Constraint> c, bool negate, unsigned long cap)
 {
     Constraint::CType type = c->getCType();
-    if (type == Constraint::CTrue || type == Constraint::CFalse || type == Constraint::CNondef || type == Constraint::CAtom) {
-        return c;
-    }
-    ref<Operator> op = static_cast<Operator*>(c.get());
-    if (op->getOType() == Operator::And) {
-        std::list<ref<Constraint> > atomics;
-        op->addAtomicsToList(atomics);
-        std::list<ref<Constraint> > usedAtomics;
-        for (std::list<ref<Constraint> >::iterator i = atomics.begin(), e = atomics.end(); i != e; ++i) {
-            ref<Constraint> cc = *i;
-            Constraint::CType ccType = cc->getCType();
-            if (ccType == Constraint::CFalse) {
-                return Constraint::_false;
-            } else if (ccType == Constraint::CTrue || ccType == Constraint::CNondef) {
-                // don't add to usedAtomics
+    if (type == Constraint::CNegation) {
+        return estimateDNFSize(static_cast<Negation*>(c.get())->getNegated(), !negate, cap);
+    } else if (type == Constraint::CAtom) {
+        // Neq atoms are split into two clauses
+        Atom::AType atype = static_cast<Atom*>(c.get())->getAType();
+        return (atype == (negate ? Atom::Equ : Atom::Neq)) ? 2 : 1;
+    } else if (type != Constraint::COperator) {
+        return 1;
+    }
+    Operator *op = static_cast<Operator*>(c.get());
+    unsigned long lhs = estimateDNFSize(op->getLeft(), negate, cap);
+    unsigned long rhs = estimateDNFSize(op->getRight(), negate, cap);
+    unsigned long res;
+    if ((op->getOType() == Operator::Or) != negate) {
+        res = lhs + rhs;
+    } else if (rhs != 0 && lhs > (cap + 1) / rhs) {
+        res = cap + 1;
+    } else {
+        res = lhs * rhs;
+    }
+    return (res > cap) ? cap + 1 : res;
+}
+
+static void addConjunctsToList(ref<Constraint> c, bool negate, std::vector<ref<Constraint> > &res)
+{
+    Constraint::CType type = c->getCType();
+    if (type == Constraint::CNegation) {
+        addConjunctsToList(static_cast<Negation*>(c.get())->getNegated(), !negate, res);
+        return;
+    } else if (type == Constraint::COperator) {
+        Operator *op = static_cast<Operator*>(c.get());
+        if ((op->getOType() == Operator::And) != negate) {
+            addConjunctsToList(op->getLeft(), negate, res);
+            addConjunctsToList(op->getRight(), negate, res);
+            return;
+        }
+    }
+    res.push_back(negate ? Negation::create(c) : c);
+}
+
+static void addClauses(ref<Constraint> c, EliminateClass *elim, std::vector<ref<Constraint> > &res)
+{
+    DNF dnf = DNF::create(c, elim);
+    // the empty clause gives "TRUE"
+    const std::vector<DNF::Clause> &clauses = dnf.getClauses();
+    for (std::vector<DNF::Clause>::const_iterator ci = clauses.begin(), ce = clauses.end(); ci != ce; ++ci) {
+        res.push_back(DNF::toConstraint(*ci));
+    }
+}
+
+static unsigned int findComponent(std::vector<unsigned int> &parent, unsigned int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// Splits the conjuncts of c into groups whose DNFs fit the budget; the rule
+// is then chained through fresh locations that pass on the arguments of the
+// lhs. Conjuncts sharing a variable that is not bound by the lhs stay in the
+// same group; those sharing one with the rhs end up in the last group.
+static void splitConstraint(ref<Term> lhs, ref<Term> rhs, ref<Constraint> c, unsigned int budget, std::vector<ref<Constraint> > &groups)
+{
+    std::vector<ref<Constraint> > conjuncts;
+    addConjunctsToList(c, false, conjuncts);
+    unsigned int num = static_cast<unsigned int>(conjuncts.size());
+
+    std::set<Symbol> lhsVars;
+    lhs->addVariablesToSet(lhsVars);
+
+    // conjunct num stands in for the rhs
+    std::vector<unsigned int> parent;
+    for (unsigned int i = 0; i <= num; ++i) {
+        parent.push_back(i);
+    }
+    std::map<Symbol, unsigned int> owner;
+    for (unsigned int i = 0; i <= num; ++i) {
+        std::set<Symbol> vars;
+        if (i < num) {
+            conjuncts[i]->addVariablesToSet(vars);
+        } else {
+            rhs->addVariablesToSet(vars);
+        }
+        for (std::set<Symbol>::iterator vi = vars.begin(), ve = vars.end(); vi != ve; ++vi) {
+            if (lhsVars.find(*vi) != lhsVars.end()) {
+                continue;
+            }
+            std::map<Symbol, unsigned int>::iterator found = owner.find(*vi);
+            if (found == owner.end()) {
+                owner.insert(std::make_pair(*vi, i));
             } else {
-                usedAtomics.push_back(cc);
+                parent[findComponent(parent, i)] = findComponent(parent, found->second);
             }
         }
-        if (usedAtomics.size() == 0) {
-            return Constraint::_true;
+    }
+
+    // units in order of their first conjunct, the one of the rhs last
+    std::vector<std::vector<unsigned int> > units;
+    std::map<unsigned int, unsigned int> unitOf;
+    unsigned int rhsComponent = findComponent(parent, num);
+    std::vector<unsigned int> lastUnit;
+    for (unsigned int i = 0; i < num; ++i) {
+        unsigned int comp = findComponent(parent, i);
+        if (comp == rhsComponent) {
+            lastUnit.push_back(i);
+            continue;
         }
-        ref<Constraint> res = *usedAtomics.rbegin();
-        usedAtomics.erase(--usedAtomics.end());
-        for (std::list<ref<Constraint> >::reverse_iterator ri = usedAtomics.rbegin(), re = usedAtomics.rend(); ri != re; ++ri) {
-            res = Operator::create(*ri, res, Operator::And);
+        std::map<unsigned int, unsigned int>::iterator found = unitOf.find(comp);
+        if (found == unitOf.end()) {
+            found = unitOf.insert(std::make_pair(comp, static_cast<unsigned int>(units.size()))).first;
+            units.push_back(std::vector<unsigned int>());
         }
-        return res;
+        units[found->second].push_back(i);
+    }
+    units.push_back(lastUnit);
+
+    // greedily pack the units into groups
+    ref<Constraint> group = Constraint::_true;
+    for (std::vector<std::vector<unsigned int> >::iterator ui = units.begin(), ue = units.end(); ui != ue; ++ui) {
+        ref<Constraint> unit = Constraint::_true;
+        for (std::vector<unsigned int>::iterator ci = ui->begin(), ce = ui->end(); ci != ce; ++ci) {
+            unit = Operator::create(unit, conjuncts[*ci], Operator::And);
+        }
+        ref<Constraint> joined = Operator::create(group, unit, Operator::And);
+        if (group->getCType() != Constraint::CTrue && estimateDNFSize(joined, false, budget) > budget) {
+            groups.push_back(group);
+            group = unit;
+        } else {
+            group = joined;
+        }
+    }
+    groups.push_back(group);
+
+    if (groups.size() == 1) {
+        groups.back() = c;
+    }
+}
+
+// The clauses of the constraint of a rule, one list per link in its chain
+typedef std::vector<std::vector<ref<Constraint> > > KittelizedRule;
+
+static void kittelizeRule(ref<Rule> rule, EliminateClass *elim, unsigned int budget, KittelizedRule &res)
+{
+    ref<Constraint> c = rule->getConstraint();
+    std::vector<ref<Constraint> > groups;
+    if (budget != 0 && estimateDNFSize(c, false, budget) > budget) {
+        splitConstraint(rule->getLeft(), rule->getRight(), c, budget, groups);
     } else {
-        std::cerr << "Internal error in Kittelizer::simplify (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
-        exit(0xBABE);
+        groups.push_back(c);
+    }
+    res.assign(groups.size(), std::vector<ref<Constraint> >());
+    for (unsigned int g = 0; g < groups.size(); ++g) {
+        addClauses(groups[g], elim, res[g]);
     }
 }
 
-std::list<ref<Rule> > kittelize(std::list<ref<Rule> > rules, SMTSolver solver)
+// The fresh locations are only named here, in the order of the rules, so
+// that the output does not depend on the order in which rules are processed
+static void addRules(ref<Rule> rule, const KittelizedRule &kittelized, unsigned int &splitCount, std::list<ref<Rule> > &res)
 {
-    std::list<ref<Rule> > res;
-    EliminateClass *elim = eliminateClassFactory(solver);
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
-        ref<Rule> rule = *i;
-        ref<Term> lhs = rule->getLeft();
-        ref<Term> rhs = rule->getRight();
-        ref<Constraint> con = rule->getConstraint()->evaluateTrivialAtoms()->eliminateNeq()->toDNF(elim);
-        std::list<ref<Constraint> > dcs;
-        con->addDualClausesToList(dcs);
-        for (std::list<ref<Constraint> >::iterator ci = dcs.begin(), ce = dcs.end(); ci != ce; ++ci) {
-            ref<Constraint> c = simplify(*ci);
-            Constraint::CType type = c->getCType();
-            if (type == Constraint::CFalse) {
-                // no rule
-            } else if (c->getCType() == Constraint::CNondef) {
-                // rule with "TRUE"
-                res.push_back(Rule::create(lhs, rhs, Constraint::_true));
-            } else {
-                // rule with c
-                res.push_back(Rule::create(lhs, rhs, c));
-            }
+    ref<Term> lhs = rule->getLeft();
+    ref<Term> from = lhs;
+    for (unsigned int g = 0; g < kittelized.size(); ++g) {
+        ref<Term> to = rule->getRight();
+        if (g + 1 < kittelized.size()) {
+            std::ostringstream name;
+            name << lhs->getFunctionSymbol().getName() << "_dnf" << ++splitCount;
+            to = Term::create(name.str(), lhs->getArgs());
         }
+        for (std::vector<ref<Constraint> >::const_iterator ci = kittelized[g].begin(), ce = kittelized[g].end(); ci != ce; ++ci) {
+            res.push_back(Rule::create(from, to, *ci));
+        }
+        from = to;
+    }
+}
+
+namespace
+{
+
+class KittelizeTasks : public TaskPool
+{
+public:
+    KittelizeTasks(const std::vector<ref<Rule> > &rules, const std::vector<EliminateClass*> &elims, unsigned int budget)
+      : m_rules(rules),
+        m_elims(elims),
+        m_budget(budget),
+        m_results(rules.size())
+    {}
+
+    const KittelizedRule &getResult(unsigned int index)
+    {
+        return m_results[index];
+    }
+
+protected:
+    virtual void runTask(unsigned int index, unsigned int worker)
+    {
+        kittelizeRule(m_rules[index], m_elims[worker], m_budget, m_results[index]);
+    }
+
+private:
+    const std::vector<ref<Rule> > &m_rules;
+    const std::vector<EliminateClass*> &m_elims;
+    unsigned int m_budget;
+    // written by one task each
+    std::vector<KittelizedRule> m_results;
+
+};
+
+}
+
+std::list<ref<Rule> > kittelize(const std::list<ref<Rule> > &rules, EliminateClass *elim, unsigned int budget, unsigned int &splitCount)
+{
+    std::list<ref<Rule> > res;
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+        KittelizedRule kittelized;
+        kittelizeRule(*i, elim, budget, kittelized);
+        addRules(*i, kittelized, splitCount, res);
     }
-    delete elim;
     return res;
 }
+
+std::list<ref<Rule> > kittelize(const std::list<ref<Rule> > &rules, const std::vector<EliminateClass*> &elims, unsigned int budget, unsigned int &splitCount)
+{
+#ifdef LLVM2KITTEL_ATOMIC_REFCOUNT
+    if (elims.size() > 1 && rules.size() > 1) {
+        std::vector<ref<Rule> > ruleVector(rules.begin(), rules.end());
+        KittelizeTasks tasks(ruleVector, elims, budget);
+        tasks.run(static_cast<unsigned int>(ruleVector.size()), static_cast<unsigned int>(elims.size()));
+        std::list<ref<Rule> > res;
+        for (unsigned int i = 0; i < ruleVector.size(); ++i) {
+            addRules(ruleVector[i], tasks.getResult(i), splitCount, res);
+        }
+        return res;
+    }
+#endif
+    return kittelize(rules, elims.front(), budget, splitCount);
+}
@@ -0,0 +1,395 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#include "llvm2kittel/LinearChecker.h"
+#include "llvm2kittel/IntTRS/Constraint.h"
+#include "llvm2kittel/IntTRS/Polynomial.h"
+
+// bounds propagation does not necessarily reach a fixpoint over the integers,
+// e.g., for x > y /\ y > x
+static const unsigned int PropagationRounds = 16;
+
+enum Normalized {
+    Proper,
+    Trivial,
+    Infeasible
+};
+
+// Divides by the gcd of the coefficients, rounding the constant of an
+// inequality down; this is where integrality is exploited.
+static Normalized normalize(std::pair<std::map<Symbol, mpz_class>, mpz_class> &l, bool equality)
+{
+    std::map<Symbol, mpz_class> &coeffs = l.first;
+    mpz_class g = 0;
+    for (std::map<Symbol, mpz_class>::iterator i = coeffs.begin(), e = coeffs.end(); i != e; ) {
+        if (i->second == 0) {
+            coeffs.erase(i++);
+        } else {
+            g = gcd(g, i->second);
+            ++i;
+        }
+    }
+    if (coeffs.empty()) {
+        if (equality ? l.second == 0 : l.second >= 0) {
+            return Trivial;
+        } else {
+            return Infeasible;
+        }
+    }
+    if (g != 1) {
+        if (equality) {
+            if (mpz_divisible_p(l.second.get_mpz_t(), g.get_mpz_t()) == 0) {
+                return Infeasible;
+            }
+            mpz_divexact(l.second.get_mpz_t(), l.second.get_mpz_t(), g.get_mpz_t());
+        } else {
+            mpz_fdiv_q(l.second.get_mpz_t(), l.second.get_mpz_t(), g.get_mpz_t());
+        }
+        for (std::map<Symbol, mpz_class>::iterator i = coeffs.begin(), e = coeffs.end(); i != e; ++i) {
+            mpz_divexact(i->second.get_mpz_t(), i->second.get_mpz_t(), g.get_mpz_t());
+        }
+    }
+    return Proper;
+}
+
+static void negate(std::pair<std::map<Symbol, mpz_class>, mpz_class> &l)
+{
+    for (std::map<Symbol, mpz_class>::iterator i = l.first.begin(), e = l.first.end(); i != e; ++i) {
+        i->second = -i->second;
+    }
+    l.second = -l.second;
+}
+
+// Replaces x in l, where x = factor * (rest.first + rest.second)
+static void substitute(std::pair<std::map<Symbol, mpz_class>, mpz_class> &l, Symbol x, std::pair<std::map<Symbol, mpz_class>, mpz_class> &rest, mpz_class &factor)
+{
+    std::map<Symbol, mpz_class>::iterator found = l.first.find(x);
+    if (found == l.first.end()) {
+        return;
+    }
+    mpz_class mult = factor * found->second;
+    l.first.erase(found);
+    for (std::map<Symbol, mpz_class>::iterator i = rest.first.begin(), e = rest.first.end(); i != e; ++i) {
+        l.first[i->first] += mult * i->second;
+    }
+    l.second += mult * rest.second;
+}
+
+LinearChecker::Interval::Interval()
+  : hasLower(false),
+    lower(),
+    hasUpper(false),
+    upper()
+{}
+
+LinearChecker::LinearChecker(unsigned int maxVariables, unsigned int maxConstraints)
+  : m_maxVariables(maxVariables),
+    m_maxConstraints(maxConstraints)
+{}
+
+LinearChecker::~LinearChecker()
+{}
+
+LinearChecker::Result LinearChecker::check(ref<Constraint> c)
+{
+    std::list<Linear> geqs;
+    std::list<Linear> equs;
+    bool exact = true;
+    if (!collect(c, geqs, equs, exact)) {
+        return Unknown;
+    }
+    std::map<Symbol, Interval> bounds;
+    if (propagateBounds(geqs, equs, bounds) == Unsat) {
+        return Unsat;
+    }
+    Result res = eliminateEqualities(geqs, equs);
+    if (res != Unknown) {
+        return res;
+    }
+    return eliminateVariables(geqs, exact);
+}
+
+LinearChecker::Result LinearChecker::getBounds(ref<Constraint> c, std::map<Symbol, Interval> &bounds)
+{
+    std::list<Linear> geqs;
+    std::list<Linear> equs;
+    bool exact = true;
+    if (!collect(c, geqs, equs, exact)) {
+        return Unknown;
+    }
+    return propagateBounds(geqs, equs, bounds);
+}
+
+LinearChecker::Result LinearChecker::propagateBounds(const std::list<Linear> &geqs, const std::list<Linear> &equs, std::map<Symbol, Interval> &bounds)
+{
+    for (unsigned int round = 0; round < PropagationRounds; ++round) {
+        bool changed = false;
+        for (std::list<Linear>::const_iterator i = geqs.begin(), e = geqs.end(); i != e; ++i) {
+            if (propagateBounds(*i, false, bounds, changed) == Unsat) {
+                return Unsat;
+            }
+        }
+        for (std::list<Linear>::const_iterator i = equs.begin(), e = equs.end(); i != e; ++i) {
+            if (propagateBounds(*i, false, bounds, changed) == Unsat || propagateBounds(*i, true, bounds, changed) == Unsat) {
+                return Unsat;
+            }
+        }
+        if (!changed) {
+            break;
+        }
+    }
+    return Unknown;
+}
+
+// Tightens the bounds using sum a_i * x_i + c >= 0 (or <= 0 if negated): for
+// every x_j, a_j * x_j >= -c - (sum over i != j of the maximum of a_i * x_i)
+LinearChecker::Result LinearChecker::propagateBounds(const Linear &l, bool negated, std::map<Symbol, Interval> &bounds, bool &changed)
+{
+    mpz_class sign = negated ? -1 : 1;
+    mpz_class rhs = -sign * l.second;
+    std::map<Symbol, mpz_class> maxima;
+    mpz_class sum = 0;
+    unsigned int unbounded = 0;
+    Symbol unboundedVar;
+    for (Coeffs::const_iterator i = l.first.begin(), e = l.first.end(); i != e; ++i) {
+        mpz_class a = sign * i->second;
+        if (a == 0) {
+            continue;
+        }
+        Interval &b = bounds[i->first];
+        if (a > 0 ? b.hasUpper : b.hasLower) {
+            mpz_class max = a * (a > 0 ? b.upper : b.lower);
+            sum += max;
+            maxima.insert(std::make_pair(i->first, max));
+        } else {
+            ++unbounded;
+            unboundedVar = i->first;
+        }
+    }
+    if (unbounded == 0 && sum < rhs) {
+        return Unsat;
+    }
+    if (unbounded > 1) {
+        return Unknown;
+    }
+    for (Coeffs::const_iterator i = l.first.begin(), e = l.first.end(); i != e; ++i) {
+        mpz_class a = sign * i->second;
+        if (a == 0) {
+            continue;
+        }
+        mpz_class bound;
+        std::map<Symbol, mpz_class>::iterator found = maxima.find(i->first);
+        if (found != maxima.end()) {
+            if (unbounded != 0) {
+                continue;
+            }
+            bound = rhs - (sum - found->second);
+        } else if (i->first == unboundedVar) {
+            bound = rhs - sum;
+        } else {
+            continue;
+        }
+        Interval &b = bounds[i->first];
+        if (a > 0) {
+            mpz_cdiv_q(bound.get_mpz_t(), bound.get_mpz_t(), a.get_mpz_t());
+            if (!b.hasLower || bound > b.lower) {
+                b.hasLower = true;
+                b.lower = bound;
+                changed = true;
+            }
+        } else {
+            mpz_fdiv_q(bound.get_mpz_t(), bound.get_mpz_t(), a.get_mpz_t());
+            if (!b.hasUpper || bound < b.upper) {
+                b.hasUpper = true;
+                b.upper = bound;
+                changed = true;
+            }
+        }
+        if (b.hasLower && b.hasUpper && b.lower > b.upper) {
+            return Unsat;
+        }
+    }
+    return Unknown;
+}
+
+bool LinearChecker::collect(ref<Constraint> c, std::list<Linear> &geqs, std::list<Linear> &equs, bool &exact)
+{
+    Constraint::CType type = c->getCType();
+    if (type == Constraint::CTrue || type == Constraint::CNondef) {
+        return true;
+    } else if (type == Constraint::CFalse) {
+        geqs.push_back(Linear(Coeffs(), -1));
+        return true;
+    } else if (type == Constraint::COperator) {
+        Operator *op = static_cast<Operator*>(c.get());
+        if (op->getOType() != Operator::And) {
+            return false;
+        }
+        return collect(op->getLeft(), geqs, equs, exact) && collect(op->getRight(), geqs, equs, exact);
+    } else if (type == Constraint::CAtom) {
+        Atom *atom = static_cast<Atom*>(c.get());
+        ref<Polynomial> lhs = atom->getLeft();
+        ref<Polynomial> rhs = atom->getRight();
+        if (!lhs->isLinear() || !rhs->isLinear()) {
+            // not part of SMT queries either
+            return true;
+        }
+        ref<Polynomial> diff = lhs->sub(rhs);
+        Linear l;
+        diff->addLinearCoefficientsToMap(l.first);
+        diff->getConst(l.second.get_mpz_t());
+        Atom::AType atype = atom->getAType();
+        if (atype == Atom::Equ) {
+            equs.push_back(l);
+        } else if (atype == Atom::Geq) {
+            geqs.push_back(l);
+        } else if (atype == Atom::Gtr) {
+            l.second -= 1;
+            geqs.push_back(l);
+        } else if (atype == Atom::Leq) {
+            negate(l);
+            geqs.push_back(l);
+        } else if (atype == Atom::Lss) {
+            negate(l);
+            l.second -= 1;
+            geqs.push_back(l);
+        } else {
+            // disequalities are dropped, so we can only conclude unsatisfiability
+            exact = false;
+        }
+        return true;
+    } else {
+        return false;
+    }
+}
+
+LinearChecker::Result LinearChecker::eliminateEqualities(std::list<Linear> &geqs, std::list<Linear> &equs)
+{
+    while (!equs.empty()) {
+        Linear eq = equs.front();
+        equs.pop_front();
+        Normalized n = normalize(eq, true);
+        if (n == Infeasible) {
+            return Unsat;
+        } else if (n == Trivial) {
+            continue;
+        }
+        Coeffs::iterator unit = eq.first.end();
+        for (Coeffs::iterator i = eq.first.begin(), e = eq.first.end(); i != e; ++i) {
+            if (abs(i->second) == 1) {
+                unit = i;
+                break;
+            }
+        }
+        if (unit == eq.first.end()) {
+            // keep as a pair of inequalities
+            geqs.push_back(eq);
+            negate(eq);
+            geqs.push_back(eq);
+            continue;
+        }
+        // a * x + rest = 0 with a = +-1, hence x = -a * rest
+        Symbol x = unit->first;
+        mpz_class factor = -unit->second;
+        eq.first.erase(unit);
+        for (std::list<Linear>::iterator i = equs.begin(), e = equs.end(); i != e; ++i) {
+            substitute(*i, x, eq, factor);
+        }
+        for (std::list<Linear>::iterator i = geqs.begin(), e = geqs.end(); i != e; ++i) {
+            substitute(*i, x, eq, factor);
+        }
+    }
+    return Unknown;
+}
+
+LinearChecker::Result LinearChecker::eliminateVariables(std::list<Linear> &geqs, bool &exact)
+{
+    for (;;) {
+        // normalize, and only keep the strongest constant for each combination of coefficients
+        std::map<Coeffs, mpz_class> strongest;
+        for (std::list<Linear>::iterator i = geqs.begin(), e = geqs.end(); i != e; ++i) {
+            Normalized n = normalize(*i, false);
+            if (n == Infeasible) {
+                return Unsat;
+            } else if (n == Trivial) {
+                continue;
+            }
+            std::map<Coeffs, mpz_class>::iterator found = strongest.find(i->first);
+            if (found == strongest.end()) {
+                strongest.insert(*i);
+            } else if (i->second < found->second) {
+                found->second = i->second;
+            }
+        }
+        if (strongest.empty()) {
+            return exact ? Sat : Unknown;
+        }
+        if (strongest.size() > m_maxConstraints) {
+            return Unknown;
+        }
+
+        // count lower and upper bounds for each variable
+        std::map<Symbol, std::pair<unsigned int, unsigned int> > bounds;
+        for (std::map<Coeffs, mpz_class>::iterator i = strongest.begin(), e = strongest.end(); i != e; ++i) {
+            for (Coeffs::const_iterator ci = i->first.begin(), ce = i->first.end(); ci != ce; ++ci) {
+                std::pair<unsigned int, unsigned int> &b = bounds[ci->first];
+                if (ci->second > 0) {
+                    ++b.first;
+                } else {
+                    ++b.second;
+                }
+            }
+        }
+        if (bounds.size() > m_maxVariables) {
+            return Unknown;
+        }
+
+        // eliminate the variable producing the fewest new constraints
+        Symbol x;
+        unsigned long best = 0;
+        for (std::map<Symbol, std::pair<unsigned int, unsigned int> >::iterator i = bounds.begin(), e = bounds.end(); i != e; ++i) {
+            unsigned long product = static_cast<unsigned long>(i->second.first) * i->second.second;
+            if (i == bounds.begin() || product < best) {
+                x = i->first;
+                best = product;
+            }
+        }
+
+        std::list<Linear> lower;
+        std::list<Linear> upper;
+        geqs.clear();
+        for (std::map<Coeffs, mpz_class>::iterator i = strongest.begin(), e = strongest.end(); i != e; ++i) {
+            Coeffs::const_iterator found = i->first.find(x);
+            if (found == i->first.end()) {
+                geqs.push_back(*i);
+            } else if (found->second > 0) {
+                lower.push_back(*i);
+            } else {
+                upper.push_back(*i);
+            }
+        }
+        // if x is only bounded from one side, its constraints can always be satisfied
+        for (std::list<Linear>::iterator li = lower.begin(), le = lower.end(); li != le; ++li) {
+            mpz_class a = li->first[x];
+            for (std::list<Linear>::iterator ui = upper.begin(), ue = upper.end(); ui != ue; ++ui) {
+                mpz_class b = -ui->first[x];
+                if (a != 1 && b != 1) {
+                    exact = false;
+                }
+                Linear combined;
+                for (Coeffs::iterator ci = li->first.begin(), ce = li->first.end(); ci != ce; ++ci) {
+                    combined.first[ci->first] += b * ci->second;
+                }
+                for (Coeffs::iterator ci = ui->first.begin(), ce = ui->first.end(); ci != ce; ++ci) {
+                    combined.first[ci->first] += a * ci->second;
+                }
+                combined.second = b * li->second + a * ui->second;
+                geqs.push_back(combined);
+            }
+        }
+    }
+}
@@ -0,0 +1,134 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#include "llvm2kittel/QueryCache.h"
+
+// C/C++ includes
+#include <cstdio>
+#include <cstdlib>
+#include <errno.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <vector>
+
+QueryCache::QueryCache(const std::string &directory)
+  : m_directory(directory),
+    m_memory(),
+    m_mutex()
+{
+    if (!m_directory.empty() && mkdir(m_directory.c_str(), 0777) != 0 && errno != EEXIST) {
+        std::cerr << "Could not create cache directory \"" << m_directory << "\" (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+        exit(277);
+    }
+}
+
+QueryCache::~QueryCache()
+{}
+
+unsigned long long QueryCache::hash(const std::string &str)
+{
+    // 64-bit FNV-1a
+    unsigned long long res = 14695981039346656037ULL;
+    for (std::string::const_iterator i = str.begin(), e = str.end(); i != e; ++i) {
+        res ^= static_cast<unsigned char>(*i);
+        res *= 1099511628211ULL;
+    }
+    return res;
+}
+
+bool QueryCache::lookup(const std::string &query, bool &unsat)
+{
+    unsigned long long key = hash(query);
+    ScopedLock<Mutex> lock(m_mutex);
+    std::map<unsigned long long, std::list<std::pair<std::string, bool> > >::iterator found = m_memory.find(key);
+    if (found != m_memory.end()) {
+        for (std::list<std::pair<std::string, bool> >::iterator i = found->second.begin(), e = found->second.end(); i != e; ++i) {
+            if (i->first == query) {
+                unsat = i->second;
+                return true;
+            }
+        }
+    }
+    if (!m_directory.empty() && lookupDisk(key, query, unsat)) {
+        insertMemory(key, query, unsat);
+        return true;
+    }
+    return false;
+}
+
+void QueryCache::insert(const std::string &query, bool unsat)
+{
+    unsigned long long key = hash(query);
+    ScopedLock<Mutex> lock(m_mutex);
+    insertMemory(key, query, unsat);
+    if (!m_directory.empty()) {
+        insertDisk(key, query, unsat);
+    }
+}
+
+void QueryCache::insertMemory(unsigned long long key, const std::string &query, bool unsat)
+{
+    m_memory[key].push_back(std::make_pair(query, unsat));
+}
+
+std::string QueryCache::getFileName(unsigned long long key)
+{
+    std::ostringstream sstr;
+    sstr << m_directory;
+    if (m_directory[m_directory.size() - 1] != '/') {
+        sstr << '/';
+    }
+    sstr << std::hex << std::setw(16) << std::setfill('0') << key << ".smt2";
+    return sstr.str();
+}
+
+bool QueryCache::lookupDisk(unsigned long long key, const std::string &query, bool &unsat)
+{
+    std::ifstream file(getFileName(key).c_str());
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string result;
+    std::getline(file, result);
+    std::ostringstream stored;
+    stored << file.rdbuf();
+    // guard against hash collisions and truncated entries
+    if (stored.str() != query) {
+        return false;
+    }
+    if (result == "unsat") {
+        unsat = true;
+    } else if (result == "sat") {
+        unsat = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void QueryCache::insertDisk(unsigned long long key, const std::string &query, bool unsat)
+{
+    // write to a temporary file first so that concurrent runs never see partial entries
+    std::string tmpName = m_directory + "/.query.XXXXXX";
+    std::vector<char> tmpl(tmpName.begin(), tmpName.end());
+    tmpl.push_back('\0');
+    int fd = mkstemp(&tmpl[0]);
+    if (fd == -1) {
+        return;
+    }
+    std::string data = (unsat ? "unsat\n" : "sat\n") + query;
+    ssize_t written = write(fd, data.c_str(), data.size());
+    close(fd);
+    if (written != static_cast<ssize_t>(data.size()) || rename(&tmpl[0], getFileName(key).c_str()) != 0) {
+        unlink(&tmpl[0]);
+    }
+}
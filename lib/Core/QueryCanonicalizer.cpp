@@ -0,0 +1,324 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#include "llvm2kittel/QueryCanonicalizer.h"
+#include "llvm2kittel/IntTRS/Constraint.h"
+#include "llvm2kittel/IntTRS/Polynomial.h"
+
+// C++ includes
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace
+{
+
+struct ShapeLess
+{
+    ShapeLess(const std::vector<std::string> &shapes)
+      : m_shapes(shapes)
+    {}
+
+    bool operator()(unsigned int lhs, unsigned int rhs) const
+    {
+        return m_shapes[lhs] < m_shapes[rhs];
+    }
+
+    const std::vector<std::string> &m_shapes;
+};
+
+// by coefficient, and by name for equal coefficients
+bool variableLess(const std::pair<Symbol, mpz_class> &lhs, const std::pair<Symbol, mpz_class> &rhs)
+{
+    if (lhs.second != rhs.second) {
+        return lhs.second < rhs.second;
+    }
+    return lhs.first.getName() < rhs.first.getName();
+}
+
+}
+
+CanonicalQuery::Literal::Literal()
+  : kind(Geq),
+    coeffs(),
+    constant()
+{}
+
+CanonicalQuery::CanonicalQuery()
+  : variables(0),
+    declared(0),
+    infeasible(false),
+    literals()
+{}
+
+QueryCanonicalizer::Linear::Linear()
+  : kind(CanonicalQuery::Geq),
+    coeffs(),
+    constant(),
+    shape()
+{}
+
+bool QueryCanonicalizer::canonicalize(ref<Constraint> c, CanonicalQuery &res)
+{
+    std::vector<Linear> atoms;
+    bool infeasible = false;
+    if (!collect(c, atoms, infeasible)) {
+        return false;
+    }
+    res = CanonicalQuery();
+    if (infeasible) {
+        res.infeasible = true;
+        return true;
+    }
+
+    // the order of the atoms, and thus the renaming, only depends on their shapes
+    std::vector<std::string> shapes;
+    std::vector<unsigned int> order;
+    for (unsigned int i = 0; i < atoms.size(); ++i) {
+        shapes.push_back(atoms[i].shape);
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), ShapeLess(shapes));
+
+    std::map<Symbol, unsigned int> renaming;
+    std::map<std::string, CanonicalQuery::Literal> printed;
+    for (std::vector<unsigned int>::iterator i = order.begin(), e = order.end(); i != e; ++i) {
+        CanonicalQuery::Literal literal = getLiteral(atoms[*i], renaming);
+        printed.insert(std::make_pair(literal.toSMTString(), literal));
+    }
+
+    res.variables = static_cast<unsigned int>(renaming.size());
+    for (std::map<std::string, CanonicalQuery::Literal>::iterator i = printed.begin(), e = printed.end(); i != e; ++i) {
+        res.literals.push_back(i->second);
+    }
+    return true;
+}
+
+bool QueryCanonicalizer::canonicalize(ref<Constraint> c, std::map<Symbol, unsigned int> &numbering, CanonicalQuery &res)
+{
+    std::vector<Linear> atoms;
+    bool infeasible = false;
+    if (!collect(c, atoms, infeasible)) {
+        return false;
+    }
+    res = CanonicalQuery();
+    res.declared = static_cast<unsigned int>(numbering.size());
+    if (infeasible) {
+        res.infeasible = true;
+    } else {
+        for (std::vector<Linear>::iterator i = atoms.begin(), e = atoms.end(); i != e; ++i) {
+            res.literals.push_back(getLiteral(*i, numbering));
+        }
+    }
+    res.variables = static_cast<unsigned int>(numbering.size());
+    return true;
+}
+
+CanonicalQuery::Literal QueryCanonicalizer::getLiteral(const Linear &l, std::map<Symbol, unsigned int> &numbering)
+{
+    std::vector<std::pair<Symbol, mpz_class> > vars = l.coeffs;
+    std::sort(vars.begin(), vars.end(), variableLess);
+    CanonicalQuery::Literal literal;
+    literal.kind = l.kind;
+    literal.constant = l.constant;
+    for (std::vector<std::pair<Symbol, mpz_class> >::iterator vi = vars.begin(), ve = vars.end(); vi != ve; ++vi) {
+        std::map<Symbol, unsigned int>::iterator found = numbering.find(vi->first);
+        if (found == numbering.end()) {
+            found = numbering.insert(std::make_pair(vi->first, static_cast<unsigned int>(numbering.size()))).first;
+        }
+        literal.coeffs.push_back(std::make_pair(found->second, vi->second));
+    }
+    std::sort(literal.coeffs.begin(), literal.coeffs.end());
+    // the coefficient of the first variable of a (dis)equality is positive
+    if (literal.kind != CanonicalQuery::Geq && literal.coeffs.front().second < 0) {
+        for (std::vector<std::pair<unsigned int, mpz_class> >::iterator ci = literal.coeffs.begin(), ce = literal.coeffs.end(); ci != ce; ++ci) {
+            ci->second = -ci->second;
+        }
+        literal.constant = -literal.constant;
+    }
+    return literal;
+}
+
+bool QueryCanonicalizer::collect(ref<Constraint> c, std::vector<Linear> &atoms, bool &infeasible)
+{
+    Constraint::CType type = c->getCType();
+    if (type == Constraint::CTrue || type == Constraint::CNondef) {
+        return true;
+    } else if (type == Constraint::CFalse) {
+        infeasible = true;
+        return true;
+    } else if (type == Constraint::COperator) {
+        Operator *op = static_cast<Operator*>(c.get());
+        if (op->getOType() != Operator::And) {
+            return false;
+        }
+        return collect(op->getLeft(), atoms, infeasible) && collect(op->getRight(), atoms, infeasible);
+    } else if (type != Constraint::CAtom) {
+        return false;
+    }
+
+    Atom *atom = static_cast<Atom*>(c.get());
+    ref<Polynomial> lhs = atom->getLeft();
+    ref<Polynomial> rhs = atom->getRight();
+    if (!lhs->isLinear() || !rhs->isLinear()) {
+        return true;
+    }
+    ref<Polynomial> diff = lhs->sub(rhs);
+    std::map<Symbol, mpz_class> coeffs;
+    diff->addLinearCoefficientsToMap(coeffs);
+    Linear l;
+    diff->getConst(l.constant.get_mpz_t());
+    bool negate = false;
+    Atom::AType atype = atom->getAType();
+    if (atype == Atom::Equ) {
+        l.kind = CanonicalQuery::Equ;
+    } else if (atype == Atom::Neq) {
+        l.kind = CanonicalQuery::Neq;
+    } else if (atype == Atom::Geq) {
+        l.kind = CanonicalQuery::Geq;
+    } else if (atype == Atom::Gtr) {
+        l.kind = CanonicalQuery::Geq;
+        l.constant -= 1;
+    } else if (atype == Atom::Leq) {
+        l.kind = CanonicalQuery::Geq;
+        negate = true;
+    } else {
+        l.kind = CanonicalQuery::Geq;
+        negate = true;
+        l.constant += 1;
+    }
+    for (std::map<Symbol, mpz_class>::iterator i = coeffs.begin(), e = coeffs.end(); i != e; ++i) {
+        if (i->second != 0) {
+            l.coeffs.push_back(std::make_pair(i->first, negate ? mpz_class(-i->second) : i->second));
+        }
+    }
+    if (negate) {
+        l.constant = -l.constant;
+    }
+    if (normalize(l, infeasible)) {
+        atoms.push_back(l);
+    }
+    return true;
+}
+
+// false if the atom is trivial
+bool QueryCanonicalizer::normalize(Linear &l, bool &infeasible)
+{
+    if (l.coeffs.empty()) {
+        if (l.kind == CanonicalQuery::Geq ? l.constant < 0 : ((l.constant == 0) != (l.kind == CanonicalQuery::Equ))) {
+            infeasible = true;
+        }
+        return false;
+    }
+    mpz_class g = 0;
+    for (std::vector<std::pair<Symbol, mpz_class> >::iterator i = l.coeffs.begin(), e = l.coeffs.end(); i != e; ++i) {
+        g = gcd(g, i->second);
+    }
+    if (g != 1) {
+        if (l.kind == CanonicalQuery::Geq) {
+            mpz_fdiv_q(l.constant.get_mpz_t(), l.constant.get_mpz_t(), g.get_mpz_t());
+        } else if (mpz_divisible_p(l.constant.get_mpz_t(), g.get_mpz_t()) == 0) {
+            // no integer solutions
+            if (l.kind == CanonicalQuery::Equ) {
+                infeasible = true;
+            }
+            return false;
+        } else {
+            mpz_divexact(l.constant.get_mpz_t(), l.constant.get_mpz_t(), g.get_mpz_t());
+        }
+        for (std::vector<std::pair<Symbol, mpz_class> >::iterator i = l.coeffs.begin(), e = l.coeffs.end(); i != e; ++i) {
+            mpz_divexact(i->second.get_mpz_t(), i->second.get_mpz_t(), g.get_mpz_t());
+        }
+    }
+    l.shape = getShape(l, false);
+    if (l.kind != CanonicalQuery::Geq) {
+        // the sign of a (dis)equality is irrelevant, so the smaller shape is chosen
+        std::string negated = getShape(l, true);
+        if (negated < l.shape) {
+            for (std::vector<std::pair<Symbol, mpz_class> >::iterator i = l.coeffs.begin(), e = l.coeffs.end(); i != e; ++i) {
+                i->second = -i->second;
+            }
+            l.constant = -l.constant;
+            l.shape = negated;
+        }
+    }
+    return true;
+}
+
+std::string QueryCanonicalizer::getShape(const Linear &l, bool negated)
+{
+    std::vector<mpz_class> coeffs;
+    for (std::vector<std::pair<Symbol, mpz_class> >::const_iterator i = l.coeffs.begin(), e = l.coeffs.end(); i != e; ++i) {
+        coeffs.push_back(negated ? mpz_class(-i->second) : i->second);
+    }
+    std::sort(coeffs.begin(), coeffs.end());
+    std::ostringstream sstr;
+    sstr << static_cast<int>(l.kind) << ' ' << coeffs.size();
+    for (std::vector<mpz_class>::iterator i = coeffs.begin(), e = coeffs.end(); i != e; ++i) {
+        sstr << ' ' << *i;
+    }
+    sstr << ' ' << (negated ? mpz_class(-l.constant) : l.constant);
+    return sstr.str();
+}
+
+static std::string constantToSMTString(const mpz_class &constant)
+{
+    std::ostringstream sstr;
+    if (constant < 0) {
+        sstr << "(- " << mpz_class(-constant) << ")";
+    } else {
+        sstr << constant;
+    }
+    return sstr.str();
+}
+
+std::string CanonicalQuery::Literal::toSMTString() const
+{
+    std::ostringstream sum;
+    if (coeffs.size() > 1) {
+        sum << "(+";
+    }
+    for (std::vector<std::pair<unsigned int, mpz_class> >::const_iterator i = coeffs.begin(), e = coeffs.end(); i != e; ++i) {
+        if (coeffs.size() > 1) {
+            sum << ' ';
+        }
+        if (i->second == 1) {
+            sum << 'x' << i->first;
+        } else {
+            sum << "(* " << constantToSMTString(i->second) << " x" << i->first << ')';
+        }
+    }
+    if (coeffs.size() > 1) {
+        sum << ')';
+    }
+    std::string bound = constantToSMTString(-constant);
+    std::ostringstream sstr;
+    if (kind == Geq) {
+        sstr << "(assert (>= " << sum.str() << ' ' << bound << "))\n";
+    } else if (kind == Equ) {
+        sstr << "(assert (= " << sum.str() << ' ' << bound << "))\n";
+    } else {
+        sstr << "(assert (not (= " << sum.str() << ' ' << bound << ")))\n";
+    }
+    return sstr.str();
+}
+
+std::string CanonicalQuery::toSMTString() const
+{
+    if (infeasible) {
+        return "(assert false)\n";
+    }
+    std::ostringstream sstr;
+    for (unsigned int v = declared; v < variables; ++v) {
+        sstr << "(declare-fun x" << v << " () Int)\n";
+    }
+    for (std::vector<Literal>::const_iterator i = literals.begin(), e = literals.end(); i != e; ++i) {
+        sstr << i->toSMTString();
+    }
+    return sstr.str();
+}
@@ -30,7 +30,7 @@
 #include <queue>
 #include <vector>
 
-Slicer::Slicer(llvm::Function *F, std::set<std::string> phiVars)
+Slicer::Slicer(llvm::Function *F, const std::set<Symbol> &phiVars)
   : m_F(F),
     m_functionIdx(),
     m_idxFunction(),
@@ -56,7 +56,7 @@ Slicer::~Slicer()
 }
 
 /*
-static void printRules(std::string header, std::list<ref<Rule> > rules)
+static void printRules(Symbol header, const std::list<ref<Rule> > &rules)
 {
     std::cout << header << std::endl;
     for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
@@ -76,40 +76,40 @@ std::set<unsigned int> Slicer::getSet(unsigned int size)
     return res;
 }
 
-std::list<ref<Rule> > Slicer::sliceUsage(std::list<ref<Rule> > rules)
+std::list<ref<Rule> > Slicer::sliceUsage(const std::list<ref<Rule> > &rules)
 {
     if (rules.empty()) {
         return rules;
     }
     std::list<ref<Rule> > res;
-    std::vector<std::string> vars;
-    std::list<ref<Polynomial> > var_args = (*rules.begin())->getLeft()->getArgs();
-    for (std::list<ref<Polynomial> >::iterator i = var_args.begin(), e = var_args.end(); i != e; ++i) {
+    std::vector<Symbol> vars;
+    const std::vector<ref<Polynomial> > &var_args = (*rules.begin())->getLeft()->getArgs();
+    for (std::vector<ref<Polynomial> >::const_iterator i = var_args.begin(), e = var_args.end(); i != e; ++i) {
         ref<Polynomial> tmp = *i;
-        std::set<std::string> tmpVars;
+        std::set<Symbol> tmpVars;
         tmp->addVariablesToSet(tmpVars);
         vars.push_back(*(tmpVars.begin()));
     }
     unsigned int arity = static_cast<unsigned int>(vars.size());
     std::set<unsigned int> notNeeded = getSet(arity);
-    for (std::list<ref<Rule> >::iterator it = rules.begin(), et = rules.end(); it != et; ++it) {
+    for (std::list<ref<Rule> >::const_iterator it = rules.begin(), et = rules.end(); it != et; ++it) {
         ref<Rule> tmp = *it;
-        std::set<std::string> c_vars;
+        std::set<Symbol> c_vars;
         tmp->getConstraint()->addVariablesToSet(c_vars);
-        std::vector<std::set<std::string> > rhsVars;
-        std::set<std::string> allRhsVars;
+        std::vector<std::set<Symbol> > rhsVars;
+        std::set<Symbol> allRhsVars;
         if (isRecursiveCall(tmp->getRight()->getFunctionSymbol())) {
             tmp->getRight()->addVariablesToSet(allRhsVars);
         } else {
             for (unsigned int i = 0; i < arity; ++i) {
-                std::set<std::string> tmpVars;
+                std::set<Symbol> tmpVars;
                 tmp->getRight()->addVariablesToSet(i, tmpVars);
                 rhsVars.push_back(tmpVars);
             }
         }
         unsigned int argc = 0;
-        for (std::vector<std::string>::iterator vi = vars.begin(), ve = vars.end(); vi != ve; ++vi, ++argc) {
-            std::string var = *vi;
+        for (std::vector<Symbol>::iterator vi = vars.begin(), ve = vars.end(); vi != ve; ++vi, ++argc) {
+            Symbol var = *vi;
             if (c_vars.find(var) != c_vars.end()) {
                 // needed because it occurs in the constraint
                 notNeeded.erase(argc);
@@ -121,9 +121,9 @@ std::list<ref<Rule> > Slicer::sliceUsage(std::list<ref<Rule> > rules)
                     }
                 } else {
                     unsigned int rhsc = 0;
-                    for (std::vector<std::set<std::string> >::iterator ri = rhsVars.begin(), re = rhsVars.end(); ri != re; ++ri, ++rhsc) {
+                    for (std::vector<std::set<Symbol> >::iterator ri = rhsVars.begin(), re = rhsVars.end(); ri != re; ++ri, ++rhsc) {
                         if (rhsc != argc) {
-                            std::set<std::string> &r_vars = *ri;
+                            std::set<Symbol> &r_vars = *ri;
                             if (r_vars.find(var) != r_vars.end()) {
                                 // needed because it occurs in different position in rhs
                                 notNeeded.erase(argc);
@@ -154,7 +154,7 @@ std::list<ref<Rule> > Slicer::sliceUsage(std::list<ref<Rule> > rules)
         }
     }
 
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> rule = *i;
         if (!isRecursiveCall(rule->getRight()->getFunctionSymbol())) {
             res.push_back(rule->dropArgs(notNeeded));
@@ -166,17 +166,17 @@ std::list<ref<Rule> > Slicer::sliceUsage(std::list<ref<Rule> > rules)
 }
 
 // Constraint
-std::list<ref<Rule> > Slicer::sliceConstraint(std::list<ref<Rule> > rules)
+std::list<ref<Rule> > Slicer::sliceConstraint(const std::list<ref<Rule> > &rules)
 {
     if (rules.empty()) {
         return rules;
     }
     std::list<ref<Rule> > res;
-    std::vector<std::string> vars;
-    std::list<ref<Polynomial> > var_args = (*rules.begin())->getLeft()->getArgs();
-    for (std::list<ref<Polynomial> >::iterator i = var_args.begin(), e = var_args.end(); i != e; ++i) {
+    std::vector<Symbol> vars;
+    const std::vector<ref<Polynomial> > &var_args = (*rules.begin())->getLeft()->getArgs();
+    for (std::vector<ref<Polynomial> >::const_iterator i = var_args.begin(), e = var_args.end(); i != e; ++i) {
         ref<Polynomial> tmp = *i;
-        std::set<std::string> tmpVars;
+        std::set<Symbol> tmpVars;
         tmp->addVariablesToSet(tmpVars);
         vars.push_back(*(tmpVars.begin()));
     }
@@ -201,7 +201,7 @@ std::list<ref<Rule> > Slicer::sliceConstraint(std::list<ref<Rule> > rules)
         }
     }
     // prepare
-    std::set<std::string> c_vars;
+    std::set<Symbol> c_vars;
     m_depends = new bool[m_numVars * m_numVars];
     for (unsigned int i = 0; i < m_numVars; ++i) {
         for (unsigned int j = 0; j < m_numVars; ++j) {
@@ -209,28 +209,28 @@ std::list<ref<Rule> > Slicer::sliceConstraint(std::list<ref<Rule> > rules)
         }
     }
     unsigned int idx = 0;
-    for (std::vector<std::string>::iterator i = vars.begin(), e = vars.end(); i != e; ++i) {
-        std::string v = *i;
+    for (std::vector<Symbol>::iterator i = vars.begin(), e = vars.end(); i != e; ++i) {
+        Symbol v = *i;
         m_varIdx.insert(std::make_pair(v, idx));
         m_idxVar.insert(std::make_pair(idx, v));
         ++idx;
     }
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> rule = *i;
         rule->getConstraint()->addVariablesToSet(c_vars);
         if (isRecursiveCall(rule->getRight()->getFunctionSymbol())) {
             rule->getRight()->addVariablesToSet(c_vars);
             continue;
         }
-        std::list<ref<Polynomial> > rhsArgs = rule->getRight()->getArgs();
-        std::list<ref<Polynomial> >::iterator ri = rhsArgs.begin();
-        for (std::vector<std::string>::iterator it = vars.begin(), et = vars.end(); it != et; ++it, ++ri) {
-            std::string lvar = *it;
+        const std::vector<ref<Polynomial> > &rhsArgs = rule->getRight()->getArgs();
+        std::vector<ref<Polynomial> >::const_iterator ri = rhsArgs.begin();
+        for (std::vector<Symbol>::iterator it = vars.begin(), et = vars.end(); it != et; ++it, ++ri) {
+            Symbol lvar = *it;
             unsigned int lvarIdx = getIdxVar(lvar);
             ref<Polynomial> inRhs = *ri;
-            std::set<std::string> tmp;
+            std::set<Symbol> tmp;
             inRhs->addVariablesToSet(tmp);
-            for (std::set<std::string>::iterator ii = tmp.begin(), ee = tmp.end(); ii != ee; ++ii) {
+            for (std::set<Symbol>::iterator ii = tmp.begin(), ee = tmp.end(); ii != ee; ++ii) {
                 if (!isNondef(*ii)) {
                     m_depends[lvarIdx + m_numVars * getIdxVar(*ii)] = true;
                 }
@@ -240,7 +240,7 @@ std::list<ref<Rule> > Slicer::sliceConstraint(std::list<ref<Rule> > rules)
     makeDependsTransitive();
 
 /*
-    for (std::vector<std::string>::iterator i = vars.begin(), e = vars.end(); i != e; ++i) {
+    for (std::vector<Symbol>::iterator i = vars.begin(), e = vars.end(); i != e; ++i) {
         std::cout << *i << " depends on ";
         unsigned int iIdx = getIdxVar(*i);
         for (unsigned int ii = 0; ii < m_numVars; ++ii) {
@@ -252,8 +252,8 @@ std::list<ref<Rule> > Slicer::sliceConstraint(std::list<ref<Rule> > rules)
     }
 */
 
-    for (std::set<std::string>::iterator i = c_vars.begin(), e = c_vars.end(); i != e; ++i) {
-        std::string v = *i;
+    for (std::set<Symbol>::iterator i = c_vars.begin(), e = c_vars.end(); i != e; ++i) {
+        Symbol v = *i;
         if (isNondef(v)) {
             continue;
         }
@@ -265,7 +265,7 @@ std::list<ref<Rule> > Slicer::sliceConstraint(std::list<ref<Rule> > rules)
         }
     }
 
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> rule = *i;
         if (!isRecursiveCall(rule->getRight()->getFunctionSymbol())) {
             res.push_back(rule->dropArgs(notNeeded));
@@ -277,30 +277,30 @@ std::list<ref<Rule> > Slicer::sliceConstraint(std::list<ref<Rule> > rules)
 }
 
 // Defined
-std::string Slicer::getVar(std::string name)
+Symbol Slicer::getVar(const std::string &name)
 {
     std::ostringstream tmp;
     tmp << "v_" << name;
-    return tmp.str();
+    return Symbol(tmp.str());
 }
 
-std::string Slicer::getEval(std::string startstop)
+Symbol Slicer::getEval(const std::string &startstop)
 {
     std::ostringstream tmp;
     tmp << "eval_" << m_F->getName().str() << "_" << startstop;
-    return tmp.str();
+    return Symbol(tmp.str());
 }
 
-void Slicer::setUpPreceeds(std::list<ref<Rule> > rules)
+void Slicer::setUpPreceeds(const std::list<ref<Rule> > &rules)
 {
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         m_functions.insert((*i)->getLeft()->getFunctionSymbol());
         m_functions.insert((*i)->getRight()->getFunctionSymbol());
     }
     m_numFunctions = static_cast<unsigned int>(m_functions.size());
     unsigned int idx = 0;
-    for (std::set<std::string>::iterator i = m_functions.begin(), e = m_functions.end(); i != e; ++i) {
-        std::string f = *i;
+    for (std::set<Symbol>::iterator i = m_functions.begin(), e = m_functions.end(); i != e; ++i) {
+        Symbol f = *i;
         m_functionIdx.insert(std::make_pair(f, idx));
         m_idxFunction.insert(std::make_pair(idx, f));
         ++idx;
@@ -311,21 +311,21 @@ void Slicer::setUpPreceeds(std::list<ref<Rule> > rules)
             m_preceeds[i + m_numFunctions * j] = false;
         }
     }
-    std::set<std::string> visited;
-    std::queue<std::string> todo;
+    std::set<Symbol> visited;
+    std::queue<Symbol> todo;
     todo.push(getEval("start"));
 
     do {
-        std::string v = todo.front();
+        Symbol v = todo.front();
         todo.pop();
         visited.insert(v);
-        std::list<std::string> succs;
-        for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+        std::list<Symbol> succs;
+        for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
             ref<Rule> rule = *i;
             if (rule->getLeft()->getFunctionSymbol() == v) {
                 bool have = false;
-                std::string succ = rule->getRight()->getFunctionSymbol();
-                for (std::list<std::string>::iterator si = succs.begin(), se = succs.end(); si != se; ++si) {
+                Symbol succ = rule->getRight()->getFunctionSymbol();
+                for (std::list<Symbol>::iterator si = succs.begin(), se = succs.end(); si != se; ++si) {
                     if (*si == succ) {
                         have = true;
                     }
@@ -335,8 +335,8 @@ void Slicer::setUpPreceeds(std::list<ref<Rule> > rules)
                 }
             }
         }
-        for (std::list<std::string>::iterator i = succs.begin(), e = succs.end(); i != e; ++i) {
-            std::string child = *i;
+        for (std::list<Symbol>::iterator i = succs.begin(), e = succs.end(); i != e; ++i) {
+            Symbol child = *i;
             if (visited.find(child) == visited.end()) {
                 // not yet visited
                 m_preceeds[getIdxFunction(v) + m_numFunctions * getIdxFunction(child)] = true;
@@ -360,23 +360,23 @@ void Slicer::setUpPreceeds(std::list<ref<Rule> > rules)
 */
 }
 
-std::set<std::string> Slicer::computeReachableFuns(std::list<ref<Rule> > rules)
+std::set<Symbol> Slicer::computeReachableFuns(const std::list<ref<Rule> > &rules)
 {
-    std::set<std::string> res;
-    std::queue<std::string> todo;
+    std::set<Symbol> res;
+    std::queue<Symbol> todo;
     todo.push(getEval("start"));
 
     do {
-        std::string v = todo.front();
+        Symbol v = todo.front();
         todo.pop();
         res.insert(v);
-        std::list<std::string> succs;
-        for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+        std::list<Symbol> succs;
+        for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
             ref<Rule> rule = *i;
             if (rule->getLeft()->getFunctionSymbol() == v) {
                 bool have = false;
-                std::string succ = rule->getRight()->getFunctionSymbol();
-                for (std::list<std::string>::iterator si = succs.begin(), se = succs.end(); si != se; ++si) {
+                Symbol succ = rule->getRight()->getFunctionSymbol();
+                for (std::list<Symbol>::iterator si = succs.begin(), se = succs.end(); si != se; ++si) {
                     if (*si == succ) {
                         have = true;
                     }
@@ -386,8 +386,8 @@ std::set<std::string> Slicer::computeReachableFuns(std::list<ref<Rule> > rules)
                 }
             }
         }
-        for (std::list<std::string>::iterator i = succs.begin(), e = succs.end(); i != e; ++i) {
-            std::string child = *i;
+        for (std::list<Symbol>::iterator i = succs.begin(), e = succs.end(); i != e; ++i) {
+            Symbol child = *i;
             if (res.find(child) == res.end()) {
                 // not yet visited
                 todo.push(child);
@@ -398,11 +398,11 @@ std::set<std::string> Slicer::computeReachableFuns(std::list<ref<Rule> > rules)
     return res;
 }
 
-std::list<ref<Rule> > Slicer::sliceDefined(std::list<ref<Rule> > rules)
+std::list<ref<Rule> > Slicer::sliceDefined(const std::list<ref<Rule> > &rules)
 {
-    std::set<std::string> reachableFuns = computeReachableFuns(rules);
+    std::set<Symbol> reachableFuns = computeReachableFuns(rules);
     std::list<ref<Rule> > reachable;
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         if (reachableFuns.find((*i)->getLeft()->getFunctionSymbol()) != reachableFuns.end()) {
             reachable.push_back(*i);
         }
@@ -411,7 +411,7 @@ std::list<ref<Rule> > Slicer::sliceDefined(std::list<ref<Rule> > rules)
         return reachable;
     }
     setUpPreceeds(reachable);
-    std::set<std::string> initial;
+    std::set<Symbol> initial;
     for (llvm::Function::arg_iterator i = m_F->arg_begin(), e = m_F->arg_end(); i != e; ++i) {
         if (llvm::isa<llvm::IntegerType>(i->getType())) {
             initial.insert(getVar(i->getName()));
@@ -433,21 +433,21 @@ std::list<ref<Rule> > Slicer::sliceDefined(std::list<ref<Rule> > rules)
             // already have this one
             continue;
         }
-        std::list<ref<Polynomial> > largs = left->getArgs();
-        std::list<ref<Polynomial> > rargs = right->getArgs();
-        std::set<std::string> defs;
-        for (std::list<ref<Polynomial> >::iterator li = largs.begin(), le = largs.end(), ri = rargs.begin(); li != le; ++li, ++ri) {
+        const std::vector<ref<Polynomial> > &largs = left->getArgs();
+        const std::vector<ref<Polynomial> > &rargs = right->getArgs();
+        std::set<Symbol> defs;
+        for (std::vector<ref<Polynomial> >::const_iterator li = largs.begin(), le = largs.end(), ri = rargs.begin(); li != le; ++li, ++ri) {
             ref<Polynomial> lpol = *li;
             ref<Polynomial> rpol = *ri;
-            std::set<std::string> ltmpVars;
+            std::set<Symbol> ltmpVars;
             lpol->addVariablesToSet(ltmpVars);
-            std::string lvar = *ltmpVars.begin();
+            Symbol lvar = *ltmpVars.begin();
             if (!rpol->isVar()) {
                 defs.insert(lvar);
             } else {
-                std::set<std::string> rtmpVars;
+                std::set<Symbol> rtmpVars;
                 rpol->addVariablesToSet(rtmpVars);
-                std::string rvar = *rtmpVars.begin();
+                Symbol rvar = *rtmpVars.begin();
                 if (lvar != rvar) {
                     defs.insert(lvar);
                 }
@@ -457,14 +457,14 @@ std::list<ref<Rule> > Slicer::sliceDefined(std::list<ref<Rule> > rules)
     }
 
 /*
-    for (std::set<std::string>::iterator i = m_functions.begin(), e = m_functions.end(); i != e; ++i) {
-        std::map<std::string, std::set<std::string> >::iterator found = m_defined.find(*i);
+    for (std::set<Symbol>::iterator i = m_functions.begin(), e = m_functions.end(); i != e; ++i) {
+        std::map<Symbol, std::set<Symbol> >::iterator found = m_defined.find(*i);
         if (found == m_defined.end()) {
             continue;
         }
         std::cout << "Defined by " << *i << ": ";
-        std::set<std::string> defd = found->second;
-        for (std::set<std::string>::iterator vi = defd.begin(), ve = defd.end(); vi != ve;) {
+        std::set<Symbol> defd = found->second;
+        for (std::set<Symbol>::iterator vi = defd.begin(), ve = defd.end(); vi != ve;) {
             std::cout << *vi;
             if (++vi != ve) {
                 std::cout << ", ";
@@ -472,8 +472,8 @@ std::list<ref<Rule> > Slicer::sliceDefined(std::list<ref<Rule> > rules)
         }
         std::cout << std::endl;
         std::cout << "Known by " << *i << ": ";
-        std::set<std::string> known = getKnownVars(*i);
-        for (std::set<std::string>::iterator vi = known.begin(), ve = known.end(); vi != ve;) {
+        std::set<Symbol> known = getKnownVars(*i);
+        for (std::set<Symbol>::iterator vi = known.begin(), ve = known.end(); vi != ve;) {
             std::cout << *vi;
             if (++vi != ve) {
                 std::cout << ", ";
@@ -484,10 +484,10 @@ std::list<ref<Rule> > Slicer::sliceDefined(std::list<ref<Rule> > rules)
 */
 
     std::list<ref<Rule> > res;
-    std::list<std::string> vars;
-    std::list<ref<Polynomial> > polys = (*reachable.begin())->getLeft()->getArgs();
-    for (std::list<ref<Polynomial> >::iterator i = polys.begin(), e = polys.end(); i != e; ++i) {
-        std::set<std::string> tmpVars;
+    std::list<Symbol> vars;
+    const std::vector<ref<Polynomial> > &polys = (*reachable.begin())->getLeft()->getArgs();
+    for (std::vector<ref<Polynomial> >::const_iterator i = polys.begin(), e = polys.end(); i != e; ++i) {
+        std::set<Symbol> tmpVars;
         (*i)->addVariablesToSet(tmpVars);
         vars.push_back(*tmpVars.begin());
     }
@@ -496,7 +496,7 @@ std::list<ref<Rule> > Slicer::sliceDefined(std::list<ref<Rule> > rules)
         std::set<unsigned int> lnotneeded = getNotNeeded(rule->getLeft()->getFunctionSymbol(), vars);
         std::set<unsigned int> rnotneeded;
         if (rule->getRight()->getFunctionSymbol() == getEval("stop")) {
-            rnotneeded = getSet(static_cast<unsigned int>(rule->getRight()->getArgs().size()));
+            rnotneeded = getSet(static_cast<unsigned int>(rule->getRight()->getArity()));
         } else if (isRecursiveCall(rule->getRight()->getFunctionSymbol())) {
             // keep everything
         } else {
@@ -509,12 +509,12 @@ std::list<ref<Rule> > Slicer::sliceDefined(std::list<ref<Rule> > rules)
     return res;
 }
 
-std::set<unsigned int> Slicer::getNotNeeded(std::string f, std::list<std::string> vars)
+std::set<unsigned int> Slicer::getNotNeeded(Symbol f, const std::list<Symbol> &vars)
 {
     std::set<unsigned int> res;
     unsigned int tmp = 0;
-    std::set<std::string> known = getKnownVars(f);
-    for (std::list<std::string>::iterator vi = vars.begin(), ve = vars.end(); vi != ve; ++vi) {
+    std::set<Symbol> known = getKnownVars(f);
+    for (std::list<Symbol>::const_iterator vi = vars.begin(), ve = vars.end(); vi != ve; ++vi) {
         if (known.find(*vi) == known.end()) {
             res.insert(tmp);
         }
@@ -523,15 +523,15 @@ std::set<unsigned int> Slicer::getNotNeeded(std::string f, std::list<std::string
     return res;
 }
 
-std::set<std::string> Slicer::getKnownVars(std::string f)
+std::set<Symbol> Slicer::getKnownVars(Symbol f)
 {
-    std::set<std::string> res;
-    std::set<std::string> fdefines = m_defined.find(f)->second;
+    std::set<Symbol> res;
+    std::set<Symbol> fdefines = m_defined.find(f)->second;
     res.insert(fdefines.begin(), fdefines.end());
     unsigned int fidx = getIdxFunction(f) * m_numFunctions;
     for (unsigned int i = 0; i < m_numFunctions; ++i) {
         if (m_preceeds[i + fidx]) {
-            std::set<std::string> pdefines = m_defined.find(getFunction(i))->second;
+            std::set<Symbol> pdefines = m_defined.find(getFunction(i))->second;
             res.insert(pdefines.begin(), pdefines.end());
         }
     }
@@ -539,16 +539,16 @@ std::set<std::string> Slicer::getKnownVars(std::string f)
 }
 
 // Still Used
-void Slicer::setUpCalls(std::list<ref<Rule> > rules)
+void Slicer::setUpCalls(const std::list<ref<Rule> > &rules)
 {
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         m_functions.insert((*i)->getLeft()->getFunctionSymbol());
         m_functions.insert((*i)->getRight()->getFunctionSymbol());
     }
     m_numFunctions = static_cast<unsigned int>(m_functions.size());
     unsigned int idx = 0;
-    for (std::set<std::string>::iterator i = m_functions.begin(), e = m_functions.end(); i != e; ++i) {
-        std::string f = *i;
+    for (std::set<Symbol>::iterator i = m_functions.begin(), e = m_functions.end(); i != e; ++i) {
+        Symbol f = *i;
         m_functionIdx.insert(std::make_pair(f, idx));
         m_idxFunction.insert(std::make_pair(idx, f));
         ++idx;
@@ -559,21 +559,21 @@ void Slicer::setUpCalls(std::list<ref<Rule> > rules)
             m_calls[i + m_numFunctions * j] = false;
         }
     }
-    std::set<std::string> visited;
-    std::queue<std::string> todo;
+    std::set<Symbol> visited;
+    std::queue<Symbol> todo;
     todo.push(getEval("start"));
 
     do {
-        std::string v = todo.front();
+        Symbol v = todo.front();
         todo.pop();
         visited.insert(v);
-        std::list<std::string> succs;
-        for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+        std::list<Symbol> succs;
+        for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
             ref<Rule> rule = *i;
             if (rule->getLeft()->getFunctionSymbol() == v) {
                 bool have = false;
-                std::string succ = rule->getRight()->getFunctionSymbol();
-                for (std::list<std::string>::iterator si = succs.begin(), se = succs.end(); si != se; ++si) {
+                Symbol succ = rule->getRight()->getFunctionSymbol();
+                for (std::list<Symbol>::iterator si = succs.begin(), se = succs.end(); si != se; ++si) {
                     if (*si == succ) {
                         have = true;
                     }
@@ -583,8 +583,8 @@ void Slicer::setUpCalls(std::list<ref<Rule> > rules)
                 }
             }
         }
-        for (std::list<std::string>::iterator i = succs.begin(), e = succs.end(); i != e; ++i) {
-            std::string child = *i;
+        for (std::list<Symbol>::iterator i = succs.begin(), e = succs.end(); i != e; ++i) {
+            Symbol child = *i;
             m_calls[getIdxFunction(v) + m_numFunctions * getIdxFunction(child)] = true;
             if (visited.find(child) == visited.end()) {
                 // not yet visited
@@ -608,11 +608,11 @@ void Slicer::setUpCalls(std::list<ref<Rule> > rules)
 */
 }
 
-std::list<ref<Rule> > Slicer::sliceStillUsed(std::list<ref<Rule> > rules, bool conservative)
+std::list<ref<Rule> > Slicer::sliceStillUsed(const std::list<ref<Rule> > &rules, bool conservative)
 {
-    std::set<std::string> reachableFuns = computeReachableFuns(rules);
+    std::set<Symbol> reachableFuns = computeReachableFuns(rules);
     std::list<ref<Rule> > reachable;
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         if (reachableFuns.find((*i)->getLeft()->getFunctionSymbol()) != reachableFuns.end()) {
             reachable.push_back(*i);
         }
@@ -623,8 +623,8 @@ std::list<ref<Rule> > Slicer::sliceStillUsed(std::list<ref<Rule> > rules, bool c
     setUpCalls(reachable);
 
     // simple cases first
-    m_stillUsed.insert(std::make_pair(getEval("stop"), std::set<std::string>()));
-    std::set<std::string> initial;
+    m_stillUsed.insert(std::make_pair(getEval("stop"), std::set<Symbol>()));
+    std::set<Symbol> initial;
     for (llvm::Function::arg_iterator i = m_F->arg_begin(), e = m_F->arg_end(); i != e; ++i) {
         if (llvm::isa<llvm::IntegerType>(i->getType())) {
             initial.insert(getVar(i->getName()));
@@ -644,31 +644,31 @@ std::list<ref<Rule> > Slicer::sliceStillUsed(std::list<ref<Rule> > rules, bool c
         ref<Rule> tmp = *i;
         ref<Term> left = tmp->getLeft();
         ref<Term> right = tmp->getRight();
-        std::set<std::string> c_vars;
+        std::set<Symbol> c_vars;
         tmp->getConstraint()->addVariablesToSet(c_vars);
-        std::list<ref<Polynomial> > largs = left->getArgs();
+        const std::vector<ref<Polynomial> > &largs = left->getArgs();
         size_t largsSize = largs.size();
-        std::list<ref<Polynomial> > rargs = right->getArgs();
-        std::set<std::string> used;
-        std::set<std::string> interestingVars;
-        std::set<std::string> seenVars;
+        const std::vector<ref<Polynomial> > &rargs = right->getArgs();
+        std::set<Symbol> used;
+        std::set<Symbol> interestingVars;
+        std::set<Symbol> seenVars;
         size_t counter = 0;
         if (isRecursiveCall(right->getFunctionSymbol())) {
             right->addVariablesToSet(interestingVars);
         } else {
-            for (std::list<ref<Polynomial> >::iterator ri = rargs.begin(), re = rargs.end(), li = largs.begin(); ri != re; ++ri, ++li, ++counter) {
+            for (std::vector<ref<Polynomial> >::const_iterator ri = rargs.begin(), re = rargs.end(), li = largs.begin(); ri != re; ++ri, ++li, ++counter) {
                 ref<Polynomial> rpol = *ri;
                 if (rpol->isVar()) {
-                    std::set<std::string> rvarsTmp;
+                    std::set<Symbol> rvarsTmp;
                     rpol->addVariablesToSet(rvarsTmp);
-                    std::string rvar = *rvarsTmp.begin();
+                    Symbol rvar = *rvarsTmp.begin();
                     if (counter >= largsSize) {
                         // "new"
                         interestingVars.insert(rvar);
                     } else {
-                        std::set<std::string> lvarsTmp;
+                        std::set<Symbol> lvarsTmp;
                         (*li)->addVariablesToSet(lvarsTmp);
-                        std::string lvar = *lvarsTmp.begin();
+                        Symbol lvar = *lvarsTmp.begin();
                         if (lvar != rvar) {
                             // in different position
                             interestingVars.insert(rvar);
@@ -688,16 +688,16 @@ std::list<ref<Rule> > Slicer::sliceStillUsed(std::list<ref<Rule> > rules, bool c
                 }
             }
         }
-        for (std::list<ref<Polynomial> >::iterator li = largs.begin(), le = largs.end(); li != le; ++li) {
+        for (std::vector<ref<Polynomial> >::const_iterator li = largs.begin(), le = largs.end(); li != le; ++li) {
             ref<Polynomial> lpol = *li;
-            std::set<std::string> tmpVars;
+            std::set<Symbol> tmpVars;
             lpol->addVariablesToSet(tmpVars);
-            std::string lvar = *tmpVars.begin();
+            Symbol lvar = *tmpVars.begin();
             if (c_vars.find(lvar) != c_vars.end() || interestingVars.find(lvar) != interestingVars.end()) {
                 used.insert(lvar);
             }
         }
-        std::map<std::string, std::set<std::string> >::iterator found = m_stillUsed.find(left->getFunctionSymbol());
+        std::map<Symbol, std::set<Symbol> >::iterator found = m_stillUsed.find(left->getFunctionSymbol());
         if (found == m_stillUsed.end()) {
             m_stillUsed.insert(std::make_pair(left->getFunctionSymbol(), used));
         } else {
@@ -708,14 +708,14 @@ std::list<ref<Rule> > Slicer::sliceStillUsed(std::list<ref<Rule> > rules, bool c
     }
 
 /*
-    for (std::set<std::string>::iterator i = m_functions.begin(), e = m_functions.end(); i != e; ++i) {
-        std::map<std::string, std::set<std::string> >::iterator found = m_stillUsed.find(*i);
+    for (std::set<Symbol>::iterator i = m_functions.begin(), e = m_functions.end(); i != e; ++i) {
+        std::map<Symbol, std::set<Symbol> >::iterator found = m_stillUsed.find(*i);
         if (found == m_stillUsed.end()) {
             continue;
         }
         std::cout << "Directly still used by " << *i << ": ";
-        std::set<std::string> used = found->second;
-        for (std::set<std::string>::iterator vi = used.begin(), ve = used.end(); vi != ve;) {
+        std::set<Symbol> used = found->second;
+        for (std::set<Symbol>::iterator vi = used.begin(), ve = used.end(); vi != ve;) {
             std::cout << *vi;
             if (++vi != ve) {
                 std::cout << ", ";
@@ -723,8 +723,8 @@ std::list<ref<Rule> > Slicer::sliceStillUsed(std::list<ref<Rule> > rules, bool c
         }
         std::cout << std::endl;
         std::cout << "Transitively still used by " << *i << ": ";
-        std::set<std::string> stillUsed = getStillUsed(*i);
-        for (std::set<std::string>::iterator vi = stillUsed.begin(), ve = stillUsed.end(); vi != ve;) {
+        std::set<Symbol> stillUsed = getStillUsed(*i);
+        for (std::set<Symbol>::iterator vi = stillUsed.begin(), ve = stillUsed.end(); vi != ve;) {
             std::cout << *vi;
             if (++vi != ve) {
                 std::cout << ", ";
@@ -735,20 +735,20 @@ std::list<ref<Rule> > Slicer::sliceStillUsed(std::list<ref<Rule> > rules, bool c
 */
 
     std::list<ref<Rule> > res;
-    std::map<std::string, std::set<std::string> > stillusedMap;
-    std::map<std::string, std::set<unsigned int> > notneededMap;
-    std::map<std::string, std::list<std::string> > varsMap;
+    std::map<Symbol, std::set<Symbol> > stillusedMap;
+    std::map<Symbol, std::set<unsigned int> > notneededMap;
+    std::map<Symbol, std::list<Symbol> > varsMap;
     for (std::list<ref<Rule> >::iterator i = reachable.begin(), e = reachable.end(); i != e; ++i) {
         ref<Rule> rule = *i;
-        std::string leftF = rule->getLeft()->getFunctionSymbol();
+        Symbol leftF = rule->getLeft()->getFunctionSymbol();
         if (stillusedMap.find(leftF) == stillusedMap.end()) {
             stillusedMap.insert(std::make_pair(leftF, getStillUsed(leftF)));
         }
         if (varsMap.find(leftF) == varsMap.end()) {
-            std::list<ref<Polynomial> > polys = rule->getLeft()->getArgs();
-            std::list<std::string> vars;
-            for (std::list<ref<Polynomial> >::iterator it = polys.begin(), et = polys.end(); it != et; ++it) {
-                std::set<std::string> tmpVars;
+            const std::vector<ref<Polynomial> > &polys = rule->getLeft()->getArgs();
+            std::list<Symbol> vars;
+            for (std::vector<ref<Polynomial> >::const_iterator it = polys.begin(), et = polys.end(); it != et; ++it) {
+                std::set<Symbol> tmpVars;
                 (*it)->addVariablesToSet(tmpVars);
                 vars.push_back(*tmpVars.begin());
             }
@@ -757,7 +757,7 @@ std::list<ref<Rule> > Slicer::sliceStillUsed(std::list<ref<Rule> > rules, bool c
     }
     for (std::list<ref<Rule> >::iterator i = reachable.begin(), e = reachable.end(); i != e; ++i) {
         ref<Rule> rule = *i;
-        std::string rightF = rule->getRight()->getFunctionSymbol();
+        Symbol rightF = rule->getRight()->getFunctionSymbol();
         if (stillusedMap.find(rightF) == stillusedMap.end()) {
             if (isRecursiveCall(rightF) && notneededMap.find(rightF) == notneededMap.end()) {
                 // keep everything
@@ -767,17 +767,17 @@ std::list<ref<Rule> > Slicer::sliceStillUsed(std::list<ref<Rule> > rules, bool c
             }
         }
     }
-    for (std::map<std::string, std::set<std::string> >::iterator it = stillusedMap.begin(), et = stillusedMap.end(); it != et; ++it) {
-        std::string f = it->first;
+    for (std::map<Symbol, std::set<Symbol> >::iterator it = stillusedMap.begin(), et = stillusedMap.end(); it != et; ++it) {
+        Symbol f = it->first;
         if (notneededMap.find(f) == notneededMap.end()) {
-            std::set<std::string> stillused = it->second;
-            std::map<std::string, std::list<std::string> >::iterator varsi = varsMap.find(f);
+            std::set<Symbol> stillused = it->second;
+            std::map<Symbol, std::list<Symbol> >::iterator varsi = varsMap.find(f);
             std::set<unsigned int> notneeded;
             if (varsi != varsMap.end()) {
                 unsigned int i = 0;
-                std::list<std::string> vars = varsi->second;
-                for (std::list<std::string>::iterator vi = vars.begin(), ve = vars.end(); vi != ve; ++vi, ++i) {
-                    std::string var = *vi;
+                std::list<Symbol> vars = varsi->second;
+                for (std::list<Symbol>::iterator vi = vars.begin(), ve = vars.end(); vi != ve; ++vi, ++i) {
+                    Symbol var = *vi;
                     if (stillused.find(var) == stillused.end()) {
                         notneeded.insert(i);
                     }
@@ -797,15 +797,15 @@ std::list<ref<Rule> > Slicer::sliceStillUsed(std::list<ref<Rule> > rules, bool c
     return res;
 }
 
-std::set<std::string> Slicer::getStillUsed(std::string f)
+std::set<Symbol> Slicer::getStillUsed(Symbol f)
 {
-    std::set<std::string> res;
-    std::set<std::string> fstillused = m_stillUsed.find(f)->second;
+    std::set<Symbol> res;
+    std::set<Symbol> fstillused = m_stillUsed.find(f)->second;
     res.insert(fstillused.begin(), fstillused.end());
     unsigned int fidx = getIdxFunction(f);
     for (unsigned int i = 0; i < m_numFunctions; ++i) {
         if (m_calls[fidx + i * m_numFunctions] && !isRecursiveCall(getFunction(i))) {
-            std::set<std::string> sstillused = m_stillUsed.find(getFunction(i))->second;
+            std::set<Symbol> sstillused = m_stillUsed.find(getFunction(i))->second;
             res.insert(sstillused.begin(), sstillused.end());
         }
     }
@@ -864,9 +864,9 @@ void Slicer::makeDependsTransitive(void)
     }
 }
 
-std::string Slicer::getFunction(unsigned int idx)
+Symbol Slicer::getFunction(unsigned int idx)
 {
-    std::map<unsigned int, std::string>::iterator found = m_idxFunction.find(idx);
+    std::map<unsigned int, Symbol>::iterator found = m_idxFunction.find(idx);
     if (found == m_idxFunction.end()) {
         std::cerr << "Internal error in Slicer::getFunction (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
         exit(123);
@@ -875,9 +875,9 @@ std::string Slicer::getFunction(unsigned int idx)
     }
 }
 
-unsigned int Slicer::getIdxFunction(std::string f)
+unsigned int Slicer::getIdxFunction(Symbol f)
 {
-    std::map<std::string, unsigned int>::iterator found = m_functionIdx.find(f);
+    std::map<Symbol, unsigned int>::iterator found = m_functionIdx.find(f);
     if (found == m_functionIdx.end()) {
         std::cerr << "Internal error in Slicer::getIdxFunction (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
         exit(123);
@@ -886,9 +886,9 @@ unsigned int Slicer::getIdxFunction(std::string f)
     }
 }
 
-std::string Slicer::getVar(unsigned int idx)
+Symbol Slicer::getVar(unsigned int idx)
 {
-    std::map<unsigned int, std::string>::iterator found = m_idxVar.find(idx);
+    std::map<unsigned int, Symbol>::iterator found = m_idxVar.find(idx);
     if (found == m_idxVar.end()) {
         std::cerr << "Internal error in Slicer::getVar (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
         exit(123);
@@ -897,9 +897,9 @@ std::string Slicer::getVar(unsigned int idx)
     }
 }
 
-unsigned int Slicer::getIdxVar(std::string v)
+unsigned int Slicer::getIdxVar(Symbol v)
 {
-    std::map<std::string, unsigned int>::iterator found = m_varIdx.find(v);
+    std::map<Symbol, unsigned int>::iterator found = m_varIdx.find(v);
     if (found == m_varIdx.end()) {
         std::cerr << "Internal error in Slicer::getIdxVar (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
         exit(123);
@@ -908,18 +908,18 @@ unsigned int Slicer::getIdxVar(std::string v)
     }
 }
 
-bool Slicer::isRecursiveCall(std::string f)
+bool Slicer::isRecursiveCall(Symbol f)
 {
-    std::string end = f.substr(f.length() - 5);
-    return (end == "start");
+    const std::string &name = f.getName();
+    return (name.compare(name.length() - 5, 5, "start") == 0);
 }
 
-bool Slicer::isNondef(std::string v)
+bool Slicer::isNondef(Symbol v)
 {
-    return (v.substr(0, 7) == "nondef.");
+    return (v.getName().compare(0, 7, "nondef.") == 0);
 }
 
-std::list<ref<Rule> > Slicer::sliceTrivialNondefConstraints(std::list<ref<Rule> > rules)
+std::list<ref<Rule> > Slicer::sliceTrivialNondefConstraints(const std::list<ref<Rule> > &rules)
 {
     // Remove constraints of the form 'Polynomial Operator nondef' if nondef is not
     // used anywhere else, i.e. on a rhs or in another constraint. A constraint of
@@ -927,18 +927,17 @@ std::list<ref<Rule> > Slicer::sliceTrivialNondefConstraints(std::list<ref<Rule>
 
     std::list<ref<Rule> > res;
 
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> rule = *i;
-        std::list<ref<Polynomial> > rhsArgs = rule->getRight()->getArgs();
-        std::set<std::string> rhsVars;
+        std::set<Symbol> rhsVars;
         rule->getRight()->addVariablesToSet(rhsVars);
 
         // Map from a nondef variable name to its atomic. If the nondef variable name is
         // used more than once in a constraint, or used on the right-hand side of a rewrite
         // rule we map the variable name to NULL.
-        std::map<std::string, ref<Constraint> > nondefToAtomic;
+        std::map<Symbol, ref<Constraint> > nondefToAtomic;
 
-        for (std::set<std::string>::iterator vi = rhsVars.begin(), ve = rhsVars.end(); vi != ve; ++vi) {
+        for (std::set<Symbol>::iterator vi = rhsVars.begin(), ve = rhsVars.end(); vi != ve; ++vi) {
             if (isNondef(*vi)) {
                 nondefToAtomic[*vi] = NULL;
             }
@@ -947,9 +946,9 @@ std::list<ref<Rule> > Slicer::sliceTrivialNondefConstraints(std::list<ref<Rule>
         std::list<ref<Constraint> > atomics;
         rule->getConstraint()->addAtomicsToList(atomics);
         for (std::list<ref<Constraint> >::iterator ai = atomics.begin(), ae = atomics.end(); ai != ae; ++ai) {
-            std::set<std::string> tmp;
+            std::set<Symbol> tmp;
             (*ai)->addVariablesToSet(tmp);
-            for (std::set<std::string>::iterator vi = tmp.begin(), ve = tmp.end(); vi != ve; ++vi) {
+            for (std::set<Symbol>::iterator vi = tmp.begin(), ve = tmp.end(); vi != ve; ++vi) {
                 if (isNondef(*vi)) {
                     if (nondefToAtomic.find(*vi) != nondefToAtomic.end()) {
                         nondefToAtomic[*vi] = NULL;
@@ -961,13 +960,13 @@ std::list<ref<Rule> > Slicer::sliceTrivialNondefConstraints(std::list<ref<Rule>
         }
 
         ref<Constraint> newConstraint = rule->getConstraint();
-        for (std::map<std::string, ref<Constraint> >::iterator ai = nondefToAtomic.begin(), ae = nondefToAtomic.end(); ai != ae; ++ai) {
+        for (std::map<Symbol, ref<Constraint> >::iterator ai = nondefToAtomic.begin(), ae = nondefToAtomic.end(); ai != ae; ++ai) {
             if (ai->second.isNull()) {
                 continue;
             }
             ref<Atom> atomic = static_cast<Atom*>(ai->second.get());
-            std::set<std::string> tmpLeft;
-            std::set<std::string> tmpRight;
+            std::set<Symbol> tmpLeft;
+            std::set<Symbol> tmpRight;
             atomic->getLeft()->addVariablesToSet(tmpLeft);
             atomic->getRight()->addVariablesToSet(tmpRight);
 
@@ -985,18 +984,22 @@ std::list<ref<Rule> > Slicer::sliceTrivialNondefConstraints(std::list<ref<Rule>
     return res;
 }
 
-std::list<ref<Rule> > Slicer::sliceDuplicates(std::list<ref<Rule> > rules)
+std::list<ref<Rule> > Slicer::sliceDuplicates(const std::list<ref<Rule> > &rules)
 {
     std::list<ref<Rule> > res;
+    std::map<unsigned long, std::list<ref<Rule> > > seen;
 
-    for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+    for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+        std::list<ref<Rule> > &bucket = seen[(*i)->getHash()];
         bool newRule = true;
-        for (std::list<ref<Rule> >::iterator ri = res.begin(), re = res.end(); ri != re; ++ri) {
+        for (std::list<ref<Rule> >::iterator ri = bucket.begin(), re = bucket.end(); ri != re; ++ri) {
             if ((*i)->equals(*ri)) {
                 newRule = false;
+                break;
             }
         }
         if (newRule) {
+            bucket.push_back(*i);
             res.push_back(*i);
         }
     }
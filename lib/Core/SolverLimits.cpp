@@ -0,0 +1,125 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#include "llvm2kittel/SolverLimits.h"
+
+SolverLimits::SolverLimits(unsigned long queryTimeout, unsigned long sccBudget, unsigned long runBudget, TimeoutPolicy policy)
+  : m_run(NULL),
+    m_queryTimeout(queryTimeout),
+    m_sccBudget(sccBudget),
+    m_runBudget(runBudget),
+    m_policy(policy),
+    m_sccTime(0),
+    m_runTime(0),
+    m_timeouts(0),
+    m_skipped(0),
+    m_mutex()
+{}
+
+SolverLimits::SolverLimits(SolverLimits &run)
+  : m_run(&run),
+    m_queryTimeout(run.m_queryTimeout),
+    m_sccBudget(run.m_sccBudget),
+    m_runBudget(0),
+    m_policy(run.m_policy),
+    m_sccTime(0),
+    m_runTime(0),
+    m_timeouts(0),
+    m_skipped(0),
+    m_mutex()
+{}
+
+SolverLimits::~SolverLimits()
+{}
+
+static void limitTimeout(unsigned long budget, unsigned long used, unsigned long &timeout)
+{
+    if (budget == 0) {
+        return;
+    }
+    unsigned long left = budget - used;
+    if (timeout == 0 || left < timeout) {
+        timeout = left;
+    }
+}
+
+bool SolverLimits::getTimeout(unsigned long &timeout)
+{
+    timeout = m_queryTimeout;
+    if (m_run != NULL && !m_run->limitRun(timeout)) {
+        return false;
+    }
+    ScopedLock<Mutex> lock(m_mutex);
+    if ((m_sccBudget != 0 && m_sccTime >= m_sccBudget) || (m_runBudget != 0 && m_runTime >= m_runBudget)) {
+        return false;
+    }
+    limitTimeout(m_sccBudget, m_sccTime, timeout);
+    limitTimeout(m_runBudget, m_runTime, timeout);
+    return true;
+}
+
+// only the run budget, as the SCC budgets are kept by the SCCs
+bool SolverLimits::limitRun(unsigned long &timeout)
+{
+    ScopedLock<Mutex> lock(m_mutex);
+    if (m_runBudget != 0 && m_runTime >= m_runBudget) {
+        return false;
+    }
+    limitTimeout(m_runBudget, m_runTime, timeout);
+    return true;
+}
+
+void SolverLimits::addTime(unsigned long time)
+{
+    if (m_run != NULL) {
+        m_run->addTime(time);
+    }
+    ScopedLock<Mutex> lock(m_mutex);
+    m_sccTime += time;
+    m_runTime += time;
+}
+
+void SolverLimits::addTimeout()
+{
+    if (m_run != NULL) {
+        m_run->addTimeout();
+    }
+    ScopedLock<Mutex> lock(m_mutex);
+    ++m_timeouts;
+}
+
+void SolverLimits::addSkipped()
+{
+    if (m_run != NULL) {
+        m_run->addSkipped();
+    }
+    ScopedLock<Mutex> lock(m_mutex);
+    ++m_skipped;
+}
+
+void SolverLimits::startSCC()
+{
+    ScopedLock<Mutex> lock(m_mutex);
+    m_sccTime = 0;
+}
+
+TimeoutPolicy SolverLimits::getPolicy()
+{
+    return m_policy;
+}
+
+unsigned long SolverLimits::getTimeouts()
+{
+    ScopedLock<Mutex> lock(m_mutex);
+    return m_timeouts;
+}
+
+unsigned long SolverLimits::getSkipped()
+{
+    ScopedLock<Mutex> lock(m_mutex);
+    return m_skipped;
+}
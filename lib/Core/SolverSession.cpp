@@ -0,0 +1,258 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#include "llvm2kittel/SolverSession.h"
+
+// C/C++ includes
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+SolverSession::SolverSession(const std::vector<std::string> &command, const std::string &prologue)
+  : m_command(command),
+    m_prologue(prologue),
+    m_pid(-1),
+    m_toSolver(-1),
+    m_fromSolver(-1),
+    m_buffer()
+{}
+
+SolverSession::~SolverSession()
+{
+    if (m_pid != -1) {
+        send("(exit)\n");
+    }
+    stop();
+}
+
+// Sessions may be started from several solver workers at once; serializing
+// the starts ensures no child inherits the pipes of another session
+static pthread_mutex_t startLock = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned long now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<unsigned long>(ts.tv_sec) * 1000 + static_cast<unsigned long>(ts.tv_nsec) / 1000000;
+}
+
+bool SolverSession::start()
+{
+    // set up argv before forking, the child must not allocate
+    std::vector<char*> argv;
+    for (std::vector<std::string>::iterator i = m_command.begin(), e = m_command.end(); i != e; ++i) {
+        argv.push_back(const_cast<char*>(i->c_str()));
+    }
+    argv.push_back(NULL);
+
+    pthread_mutex_lock(&startLock);
+
+    int toSolver[2];
+    int fromSolver[2];
+    if (pipe(toSolver) != 0) {
+        pthread_mutex_unlock(&startLock);
+        return false;
+    }
+    if (pipe(fromSolver) != 0) {
+        close(toSolver[0]);
+        close(toSolver[1]);
+        pthread_mutex_unlock(&startLock);
+        return false;
+    }
+    // Do not leak our ends into solver processes started later on
+    fcntl(toSolver[1], F_SETFD, FD_CLOEXEC);
+    fcntl(fromSolver[0], F_SETFD, FD_CLOEXEC);
+
+    // A solver that dies must not take us down with it; writes then fail with EPIPE
+    signal(SIGPIPE, SIG_IGN);
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(toSolver[0]);
+        close(toSolver[1]);
+        close(fromSolver[0]);
+        close(fromSolver[1]);
+        pthread_mutex_unlock(&startLock);
+        return false;
+    }
+
+    if (pid == 0) {
+        dup2(toSolver[0], STDIN_FILENO);
+        dup2(fromSolver[1], STDOUT_FILENO);
+        close(toSolver[0]);
+        close(toSolver[1]);
+        close(fromSolver[0]);
+        close(fromSolver[1]);
+        execvp(argv[0], &argv[0]);
+        _exit(127);
+    }
+
+    close(toSolver[0]);
+    close(fromSolver[1]);
+    pthread_mutex_unlock(&startLock);
+
+    m_pid = pid;
+    m_toSolver = toSolver[1];
+    m_fromSolver = fromSolver[0];
+    m_buffer.clear();
+    return true;
+}
+
+void SolverSession::stop()
+{
+    if (m_pid == -1) {
+        return;
+    }
+    close(m_toSolver);
+    close(m_fromSolver);
+    kill(m_pid, SIGTERM);
+    int status;
+    while (waitpid(m_pid, &status, 0) == -1 && errno == EINTR) {
+        // retry
+    }
+    m_pid = -1;
+    m_toSolver = -1;
+    m_fromSolver = -1;
+    m_buffer.clear();
+}
+
+bool SolverSession::send(const std::string &commands)
+{
+    std::string data;
+    if (m_pid == -1) {
+        if (!start()) {
+            return false;
+        }
+        data = m_prologue;
+    }
+    data += commands;
+
+    const char *ptr = data.c_str();
+    size_t left = data.size();
+    while (left > 0) {
+        ssize_t written = write(m_toSolver, ptr, left);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            stop();
+            return false;
+        }
+        ptr += written;
+        left -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool SolverSession::readLine(std::string &line)
+{
+    bool timedOut;
+    return readLine(line, 0, timedOut);
+}
+
+bool SolverSession::readLine(std::string &line, unsigned long timeout, bool &timedOut)
+{
+    timedOut = false;
+    if (m_pid == -1) {
+        return false;
+    }
+    unsigned long deadline = now() + timeout;
+    std::string::size_type newline;
+    while ((newline = m_buffer.find('\n')) == std::string::npos) {
+        if (timeout != 0) {
+            unsigned long current = now();
+            struct pollfd pfd;
+            pfd.fd = m_fromSolver;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            int ready = (current < deadline) ? poll(&pfd, 1, static_cast<int>(deadline - current)) : 0;
+            if (ready == -1 && errno == EINTR) {
+                continue;
+            }
+            if (ready == 0) {
+                // the solver is busy with the query; a fresh process is started for the next one
+                stop();
+                timedOut = true;
+                return false;
+            }
+        }
+        char chunk[4096];
+        ssize_t got = read(m_fromSolver, chunk, sizeof(chunk));
+        if (got == -1 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            stop();
+            return false;
+        }
+        m_buffer.append(chunk, static_cast<size_t>(got));
+    }
+    line = m_buffer.substr(0, newline);
+    m_buffer.erase(0, newline + 1);
+    if (!line.empty() && line[line.size() - 1] == '\r') {
+        line.erase(line.size() - 1);
+    }
+    return true;
+}
+
+bool SolverSession::run(const std::string &command, unsigned long timeout, bool &timedOut)
+{
+    timedOut = false;
+    pthread_mutex_lock(&startLock);
+    pid_t pid = fork();
+    if (pid == -1) {
+        pthread_mutex_unlock(&startLock);
+        return false;
+    }
+    if (pid == 0) {
+        // own process group, so that the solver is killed along with the shell
+        setpgid(0, 0);
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(NULL));
+        _exit(127);
+    }
+    setpgid(pid, pid);
+    pthread_mutex_unlock(&startLock);
+
+    int status;
+    if (timeout == 0) {
+        while (waitpid(pid, &status, 0) == -1 && errno == EINTR) {
+            // retry
+        }
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    unsigned long deadline = now() + timeout;
+    struct timespec pause;
+    pause.tv_sec = 0;
+    pause.tv_nsec = 1000000;
+    for (;;) {
+        pid_t done = waitpid(pid, &status, WNOHANG);
+        if (done == pid) {
+            return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        } else if (done == -1 && errno != EINTR) {
+            return false;
+        }
+        if (now() >= deadline) {
+            kill(-pid, SIGKILL);
+            while (waitpid(pid, &status, 0) == -1 && errno == EINTR) {
+                // retry
+            }
+            timedOut = true;
+            return false;
+        }
+        nanosleep(&pause, NULL);
+        // poll less often for long-running solvers
+        if (pause.tv_nsec < 16000000) {
+            pause.tv_nsec *= 2;
+        }
+    }
+}
@@ -55,20 +55,22 @@ static std::string toCIntString(std::list<ref<Rule> > &rules)
 
 static void printVars(std::list<ref<Rule> > &rules, std::ostream &stream)
 {
-    std::set<std::string> varsSet;
-
+    std::set<Symbol> symbols;
     for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
-        (*i)->addVariablesToSet(varsSet);
+        (*i)->addVariablesToSet(symbols);
     }
 
+    std::set<std::string> varsSet;
+    addNamesToSet(symbols, varsSet);
+
     for (std::set<std::string>::iterator i = varsSet.begin(), e = varsSet.end(); i != e; ++i) {
         stream << ' ' << *i;
     }
 }
 
-void printComplexityTuples(std::list<ref<Rule> > &rules, std::set<std::string> &complexityLHSs, std::ostream &stream)
+void printComplexityTuples(std::list<ref<Rule> > &rules, std::set<Symbol> &complexityLHSs, std::ostream &stream)
 {
-    std::set<std::string> todoComplexityLHSs;
+    std::set<Symbol> todoComplexityLHSs;
     todoComplexityLHSs.insert(complexityLHSs.begin(), complexityLHSs.end());
 
     stream << "(GOAL COMPLEXITY)\n(STARTTERM CONSTRUCTOR-BASED)" << std::endl;
@@ -79,7 +81,7 @@ void printComplexityTuples(std::list<ref<Rule> > &rules, std::set<std::string> &
 
     for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> rule = *i;
-        std::string lhsFun = rule->getLeft()->getFunctionSymbol();
+        Symbol lhsFun = rule->getLeft()->getFunctionSymbol();
         if (complexityLHSs.find(lhsFun) == complexityLHSs.end()) {
             stream << "  " << toCIntString(rule) << std::endl;
         } else {
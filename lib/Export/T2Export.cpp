@@ -17,29 +17,30 @@
 #include <algorithm>
 #include <list>
 #include <map>
+#include <vector>
 #include <set>
 
-static std::pair<std::map<std::string, int>, std::map<std::string, std::list<std::string> > > getFunToLocIDAndLhsNames(std::list<ref<Rule> > rules)
+static std::pair<std::map<Symbol, int>, std::map<Symbol, std::list<std::string> > > getFunToLocIDAndLhsNames(const std::list<ref<Rule> > &rules)
 {
-  std::map<std::string, int> funToLocId;
-  std::map<std::string, std::list<std::string> > funToLhsNames;
+  std::map<Symbol, int> funToLocId;
+  std::map<Symbol, std::list<std::string> > funToLhsNames;
   int nextLocId = 1;
-  for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
+  for (std::list<ref<Rule> >::const_iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
     //Get the location IDs:
-    std::string lhsFunSym = (*i)->getLeft()->getFunctionSymbol();
+    Symbol lhsFunSym = (*i)->getLeft()->getFunctionSymbol();
     if (!funToLocId.count(lhsFunSym)) {
       funToLocId[lhsFunSym] = nextLocId++;
     }
 
-    std::string rhsFunSym = (*i)->getRight()->getFunctionSymbol();
+    Symbol rhsFunSym = (*i)->getRight()->getFunctionSymbol();
     if (!funToLocId.count(rhsFunSym)) {
       funToLocId[rhsFunSym] = nextLocId++;
     }
 
     //Now get the default parameter names:
-    std::list<ref<Polynomial> > lhsArgs = (*i)->getLeft()->getArgs();
+    const std::vector<ref<Polynomial> > &lhsArgs = (*i)->getLeft()->getArgs();
     std::list<std::string> lhsNames;
-    for (std::list<ref<Polynomial> >::iterator argi = lhsArgs.begin(), arge = lhsArgs.end(); argi != arge; ++argi) {
+    for (std::vector<ref<Polynomial> >::const_iterator argi = lhsArgs.begin(), arge = lhsArgs.end(); argi != arge; ++argi) {
       lhsNames.push_back((*argi)->toString());
     }
     if (funToLhsNames.count(lhsFunSym)) {
@@ -58,7 +59,7 @@ static std::pair<std::map<std::string, int>, std::map<std::string, std::list<std
   return std::make_pair(funToLocId, funToLhsNames);
 }
 
-static void printT2Rule(ref<Rule> rule, std::map<std::string, int> funToLocId, std::map<std::string, std::list<std::string> > funToLhsNames, std::ostream &stream)
+static void printT2Rule(ref<Rule> rule, std::map<Symbol, int> &funToLocId, std::map<Symbol, std::list<std::string> > &funToLhsNames, std::ostream &stream)
 {
    /*
    * Input: f(x1, ..., xn) -> g(t1, ..., tm) [ COND ]
@@ -77,8 +78,8 @@ static void printT2Rule(ref<Rule> rule, std::map<std::string, int> funToLocId, s
    *       ...
    *       ym := sigma(tm)
    */
-  std::string lhsFun = rule->getLeft()->getFunctionSymbol();
-  std::string rhsFun = rule->getRight()->getFunctionSymbol();
+  Symbol lhsFun = rule->getLeft()->getFunctionSymbol();
+  Symbol rhsFun = rule->getRight()->getFunctionSymbol();
   std::list<std::string> preVarLhsNames = funToLhsNames[lhsFun];
   std::list<std::string> postVarLhsNames = funToLhsNames[rhsFun];
 
@@ -87,8 +88,8 @@ static void printT2Rule(ref<Rule> rule, std::map<std::string, int> funToLocId, s
   std::set<std::string> changedPostVars;
   { //I blame not having boost, and don't want to polute the outside scope
     std::list<std::string>::iterator postVarNameIt = postVarLhsNames.begin();
-    std::list<ref<Polynomial> > rhsArgs = rule->getRight()->getArgs();
-    std::list<ref<Polynomial> >::iterator rhsArgIt = rhsArgs.begin();
+    const std::vector<ref<Polynomial> > &rhsArgs = rule->getRight()->getArgs();
+    std::vector<ref<Polynomial> >::const_iterator rhsArgIt = rhsArgs.begin();
     while (rhsArgIt != rhsArgs.end() && postVarNameIt != postVarLhsNames.end()) {
       if ((*rhsArgIt)->toString().compare(*postVarNameIt) != 0) {
         changedPostVars.insert(*postVarNameIt);
@@ -99,18 +100,20 @@ static void printT2Rule(ref<Rule> rule, std::map<std::string, int> funToLocId, s
   }
 
   //Step (2)
-  std::map<std::string, ref<Polynomial> > sigma;
+  std::map<Symbol, ref<Polynomial> > sigma;
   for (std::list<std::string>::iterator i = preVarLhsNames.begin(), e = preVarLhsNames.end(); i != e; ++i) {
     if (changedPostVars.count(*i)) {
       std::string preVarNameCopy = "kittel_old__" + *i;
       stream << "  " << preVarNameCopy << " := " << *i << ";" << std::endl;
-      sigma[*i] = Polynomial::create(preVarNameCopy);
+      sigma[Symbol(*i)] = Polynomial::create(preVarNameCopy);
     }
   }
 
   //Step (3)
+  std::set<Symbol> ruleVariables;
+  rule->addVariablesToSet(ruleVariables);
   std::set<std::string> freeVariables;
-  rule->addVariablesToSet(freeVariables);
+  addNamesToSet(ruleVariables, freeVariables);
   for (std::list<std::string>::iterator i = preVarLhsNames.begin(), e = preVarLhsNames.end(); i != e; ++i) {
     freeVariables.erase(*i);
   }
@@ -126,10 +129,10 @@ static void printT2Rule(ref<Rule> rule, std::map<std::string, int> funToLocId, s
   }
 
   //Step (5)
-  std::list<ref<Polynomial> > renamedRhsArgs = renamedRule->getRight()->getArgs();
+  const std::vector<ref<Polynomial> > &renamedRhsArgs = renamedRule->getRight()->getArgs();
   { // Again, I don't have boost
     std::list<std::string>::iterator postVarNameIt = postVarLhsNames.begin();
-    std::list<ref<Polynomial> >::iterator rhsArgIt = renamedRhsArgs.begin();
+    std::vector<ref<Polynomial> >::const_iterator rhsArgIt = renamedRhsArgs.begin();
     while (rhsArgIt != renamedRhsArgs.end() && postVarNameIt != postVarLhsNames.end()) {
       std::string postVarName = *postVarNameIt;
       if (changedPostVars.count(postVarName)) {
@@ -146,10 +149,10 @@ static void printT2Rule(ref<Rule> rule, std::map<std::string, int> funToLocId, s
 
 void printT2System(std::list<ref<Rule> > &rules, std::string &startFun, std::ostream &stream)
 {
-  std::pair<std::map<std::string, int>, std::map<std::string, std::list<std::string > > > t = getFunToLocIDAndLhsNames(rules);
-  std::map<std::string, int> funToLocId = t.first;
+  std::pair<std::map<Symbol, int>, std::map<Symbol, std::list<std::string > > > t = getFunToLocIDAndLhsNames(rules);
+  std::map<Symbol, int> funToLocId = t.first;
 
-  stream << "START: " << funToLocId[startFun] << ";" << std::endl << std::endl;
+  stream << "START: " << funToLocId[Symbol(startFun)] << ";" << std::endl << std::endl;
   for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
     printT2Rule(*i, funToLocId, t.second, stream);
   }
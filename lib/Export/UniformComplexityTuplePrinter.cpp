@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <list>
 #include <map>
+#include <vector>
 
 static void printVars(std::list<std::string> &vars, std::ostream &stream, std::string sep)
 {
@@ -31,16 +32,15 @@ static void printVars(std::list<std::string> &vars, std::ostream &stream, std::s
 static std::string getLeftString(ref<Rule> rule, std::list<std::string> &vars)
 {
     std::ostringstream res;
-    std::string lhsFun = rule->getLeft()->getFunctionSymbol();
-    res << lhsFun << '(';
+    res << rule->getLeft()->getFunctionSymbol().getName() << '(';
     printVars(vars, res, ", ");
     res << ')';
     return res.str();
 }
 
-static ref<Polynomial> getArg(std::string &var, std::list<std::string> &lhsNames, std::list<ref<Polynomial> > &args)
+static ref<Polynomial> getArg(std::string &var, std::list<std::string> &lhsNames, const std::vector<ref<Polynomial> > &args)
 {
-    std::list<ref<Polynomial> >::iterator a = args.begin();
+    std::vector<ref<Polynomial> >::const_iterator a = args.begin();
     for (std::list<std::string>::iterator i = lhsNames.begin(), e = lhsNames.end(); i != e; ++i, ++a) {
         if (*i == var) {
             return *a;
@@ -49,18 +49,18 @@ static ref<Polynomial> getArg(std::string &var, std::list<std::string> &lhsNames
     return ref<Polynomial>();
 }
 
-static std::string getRightString(ref<Rule> rule, std::list<std::string> &vars, std::map<std::string, std::list<std::string> > &argNames)
+static std::string getRightString(ref<Rule> rule, std::list<std::string> &vars, std::map<Symbol, std::list<std::string> > &argNames)
 {
     std::ostringstream res;
-    std::string rhsFun = rule->getRight()->getFunctionSymbol();
-    std::map<std::string, std::list<std::string> >::iterator found = argNames.find(rhsFun);
+    Symbol rhsFun = rule->getRight()->getFunctionSymbol();
+    std::map<Symbol, std::list<std::string> >::iterator found = argNames.find(rhsFun);
     if (found == argNames.end()) {
-        res << rhsFun << '(';
+        res << rhsFun.getName() << '(';
         printVars(vars, res, ", ");
         res << ')';
     } else {
-        std::list<ref<Polynomial> > args = rule->getRight()->getArgs();
-        res << rhsFun << '(';
+        const std::vector<ref<Polynomial> > &args = rule->getRight()->getArgs();
+        res << rhsFun.getName() << '(';
         for (std::list<std::string>::iterator i = vars.begin(), e = vars.end(); i != e; ) {
             std::string var = *i;
             ref<Polynomial> arg = getArg(var, found->second, args);
@@ -78,7 +78,7 @@ static std::string getRightString(ref<Rule> rule, std::list<std::string> &vars,
     return res.str();
 }
 
-static std::string toCIntString(ref<Rule> rule, std::list<std::string> &vars, std::map<std::string, std::list<std::string> > &argNames)
+static std::string toCIntString(ref<Rule> rule, std::list<std::string> &vars, std::map<Symbol, std::list<std::string> > &argNames)
 {
     std::ostringstream res;
     res << getLeftString(rule, vars) << " -> " << "Com_1(" << getRightString(rule, vars, argNames) << ")";
@@ -88,7 +88,7 @@ static std::string toCIntString(ref<Rule> rule, std::list<std::string> &vars, st
     return res.str();
 }
 
-static std::string toCIntString(std::list<ref<Rule> > &rules, std::list<std::string> &vars, std::map<std::string, std::list<std::string> > &argNames)
+static std::string toCIntString(std::list<ref<Rule> > &rules, std::list<std::string> &vars, std::map<Symbol, std::list<std::string> > &argNames)
 {
     size_t numRules = rules.size();
     if (numRules == 0) {
@@ -121,11 +121,11 @@ static std::list<std::string> getVars(std::list<ref<Rule> > &rules)
     std::set<std::string> varsSet;
 
     for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
-        std::set<std::string> tmp;
+        std::set<Symbol> tmp;
         (*i)->addVariablesToSet(tmp);
-        for (std::set<std::string>::iterator ii = tmp.begin(), ee = tmp.end(); ii != ee; ++ii) {
-            if (ii->substr(0, 7) != "nondef.") {
-                varsSet.insert(*ii);
+        for (std::set<Symbol>::iterator ii = tmp.begin(), ee = tmp.end(); ii != ee; ++ii) {
+            if (ii->getName().substr(0, 7) != "nondef.") {
+                varsSet.insert(ii->getName());
             }
         }
     }
@@ -137,36 +137,38 @@ static std::list<std::string> getVars(std::list<ref<Rule> > &rules)
 
 static std::list<std::string> getAllVars(std::list<ref<Rule> > &rules)
 {
-    std::set<std::string> varsSet;
-
+    std::set<Symbol> symbols;
     for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
-        (*i)->addVariablesToSet(varsSet);
+        (*i)->addVariablesToSet(symbols);
     }
 
+    std::set<std::string> varsSet;
+    addNamesToSet(symbols, varsSet);
+
     std::list<std::string> res;
     res.insert(res.begin(), varsSet.begin(), varsSet.end());
     return res;
 }
 
-static std::map<std::string, std::list<std::string> > getArgNames(std::list<ref<Rule> > &rules)
+static std::map<Symbol, std::list<std::string> > getArgNames(std::list<ref<Rule> > &rules)
 {
-    std::map<std::string, std::list<std::string> > res;
+    std::map<Symbol, std::list<std::string> > res;
 
     for (std::list<ref<Rule> >::iterator i= rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> rule = *i;
-        std::string lhsFun = rule->getLeft()->getFunctionSymbol();
+        Symbol lhsFun = rule->getLeft()->getFunctionSymbol();
         std::list<std::string> argNames;
-        std::list<ref<Polynomial> > args = rule->getLeft()->getArgs();
-        for (std::list<ref<Polynomial> >::iterator ii = args.begin(), ee = args.end(); ii != ee; ++ii) {
+        const std::vector<ref<Polynomial> > &args = rule->getLeft()->getArgs();
+        for (std::vector<ref<Polynomial> >::const_iterator ii = args.begin(), ee = args.end(); ii != ee; ++ii) {
             if (!(*ii)->isVar()) {
                 std::cerr << "Internal error in UniformComplexityTuplePrinter (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
                 exit(0xAAAA);
             }
-            std::set<std::string> vars;
+            std::set<Symbol> vars;
             (*ii)->addVariablesToSet(vars);
-            argNames.push_back(*vars.begin());
+            argNames.push_back(vars.begin()->getName());
         }
-        std::map<std::string, std::list<std::string> >::iterator found = res.find(lhsFun);
+        std::map<Symbol, std::list<std::string> >::iterator found = res.find(lhsFun);
         if (found == res.end()) {
             res.insert(std::make_pair(lhsFun, argNames));
         } else if (found->second != argNames) {
@@ -178,14 +180,14 @@ static std::map<std::string, std::list<std::string> > getArgNames(std::list<ref<
     return res;
 }
 
-void printUniformComplexityTuples(std::list<ref<Rule> > &rules, std::set<std::string> &complexityLHSs, std::string &startFun, std::ostream &stream)
+void printUniformComplexityTuples(std::list<ref<Rule> > &rules, std::set<Symbol> &complexityLHSs, std::string &startFun, std::ostream &stream)
 {
-    std::set<std::string> todoComplexityLHSs;
+    std::set<Symbol> todoComplexityLHSs;
     todoComplexityLHSs.insert(complexityLHSs.begin(), complexityLHSs.end());
 
     std::list<std::string> vars = getVars(rules);
     std::list<std::string> allVars = getAllVars(rules);
-    std::map<std::string, std::list<std::string> > argNames = getArgNames(rules);
+    std::map<Symbol, std::list<std::string> > argNames = getArgNames(rules);
 
     stream << "(GOAL COMPLEXITY)" << std::endl;
     stream << "(STARTTERM (FUNCTIONSYMBOLS " << startFun << "))" << std::endl;
@@ -196,7 +198,7 @@ void printUniformComplexityTuples(std::list<ref<Rule> > &rules, std::set<std::st
 
     for (std::list<ref<Rule> >::iterator i = rules.begin(), e = rules.end(); i != e; ++i) {
         ref<Rule> rule = *i;
-        std::string lhsFun = rule->getLeft()->getFunctionSymbol();
+        Symbol lhsFun = rule->getLeft()->getFunctionSymbol();
         if (complexityLHSs.find(lhsFun) == complexityLHSs.end()) {
             stream << "  " << toCIntString(rule, vars, argNames) << std::endl;
         } else {
@@ -6,6 +6,7 @@
 // See LICENSE for details.
 
 #include "llvm2kittel/IntTRS/Constraint.h"
+#include "llvm2kittel/IntTRS/DNF.h"
 #include "llvm2kittel/IntTRS/Polynomial.h"
 #include "llvm2kittel/ConstraintEliminator.h"
 
@@ -13,6 +14,7 @@
 #include <sstream>
 #include <iostream>
 #include <cstdlib>
+#include <vector>
 
 ref<Constraint> Constraint::_true;
 ref<Constraint> Constraint::_false;
@@ -76,7 +78,7 @@ std::string True::toSMTString(bool)
     return ""; // No need to output (assert true)
 }
 
-ref<Constraint> True::instantiate(std::map<std::string, ref<Polynomial> > *)
+ref<Constraint> True::instantiate(std::map<Symbol, ref<Polynomial> > *)
 {
     return Constraint::_true;
 }
@@ -120,7 +122,7 @@ ref<Constraint> True::setAtomToTrue(ref<Constraint> c)
     return Constraint::_true;
 }
 
-void True::addVariablesToSet(std::set<std::string> &res)
+void True::addVariablesToSet(std::set<Symbol> &res)
 {}
 
 bool True::equalsInternal(ref<Constraint>)
@@ -128,6 +130,11 @@ bool True::equalsInternal(ref<Constraint>)
     return true;
 }
 
+unsigned long True::getHash()
+{
+    return CTrue;
+}
+
 // False
 False::False()
 {}
@@ -165,7 +172,7 @@ std::string False::toSMTString(bool)
     exit(217);
 }
 
-ref<Constraint> False::instantiate(std::map<std::string, ref<Polynomial> > *)
+ref<Constraint> False::instantiate(std::map<Symbol, ref<Polynomial> > *)
 {
     return Constraint::_false;
 }
@@ -210,7 +217,7 @@ ref<Constraint> False::setAtomToTrue(ref<Constraint> c)
     exit(217);
 }
 
-void False::addVariablesToSet(std::set<std::string> &res)
+void False::addVariablesToSet(std::set<Symbol> &res)
 {}
 
 bool False::equalsInternal(ref<Constraint>)
@@ -218,6 +225,11 @@ bool False::equalsInternal(ref<Constraint>)
     return true;
 }
 
+unsigned long False::getHash()
+{
+    return CFalse;
+}
+
 // Nondef
 Nondef::Nondef()
 {}
@@ -254,7 +266,7 @@ std::string Nondef::toSMTString(bool)
     return ""; // Can always chosen to be true; no need to output (assert true)
 }
 
-ref<Constraint> Nondef::instantiate(std::map<std::string, ref<Polynomial> > *)
+ref<Constraint> Nondef::instantiate(std::map<Symbol, ref<Polynomial> > *)
 {
     return new Nondef();
 }
@@ -295,7 +307,7 @@ ref<Constraint> Nondef::setAtomToTrue(ref<Constraint> c)
     exit(217);
 }
 
-void Nondef::addVariablesToSet(std::set<std::string> &res)
+void Nondef::addVariablesToSet(std::set<Symbol> &res)
 {}
 
 bool Nondef::equalsInternal(ref<Constraint> c)
@@ -303,11 +315,17 @@ bool Nondef::equalsInternal(ref<Constraint> c)
     return this == c.get();
 }
 
+unsigned long Nondef::getHash()
+{
+    return CNondef;
+}
+
 // Atom
 Atom::Atom(ref<Polynomial> lhs, ref<Polynomial> rhs, AType type)
   : m_lhs(lhs),
     m_rhs(rhs),
-    m_type(type)
+    m_type(type),
+    m_hash(hashCombine(hashCombine(hashCombine(CAtom, type), lhs->getHash()), rhs->getHash()))
 {}
 
 ref<Constraint> Atom::create(ref<Polynomial> lhs, ref<Polynomial> rhs, Atom::AType type)
@@ -316,7 +334,15 @@ ref<Constraint> Atom::create(ref<Polynomial> lhs, ref<Polynomial> rhs, Atom::ATy
 }
 
 Atom::~Atom()
-{}
+{
+    getTable().remove(this);
+}
+
+HashConsTable<Atom> &Atom::getTable()
+{
+    static HashConsTable<Atom> *table = new HashConsTable<Atom>();
+    return *table;
+}
 
 Atom::AType Atom::getAType()
 {
@@ -430,7 +456,7 @@ std::string Atom::toSMTString(bool onlyLinearPart)
     }
 }
 
-ref<Constraint> Atom::instantiate(std::map<std::string, ref<Polynomial> > *bindings)
+ref<Constraint> Atom::instantiate(std::map<Symbol, ref<Polynomial> > *bindings)
 {
     return create(m_lhs->instantiate(bindings), m_rhs->instantiate(bindings), m_type);
 }
@@ -484,40 +510,35 @@ ref<Constraint> Atom::eliminateNeq()
 
 ref<Constraint> Atom::evaluateTrivialAtoms()
 {
-    return evaluateTrivialAtomsInternal(m_lhs, m_rhs, m_type);
+    // create already evaluated the atom if it was trivial
+    return this;
 }
 
 ref<Constraint> Atom::evaluateTrivialAtomsInternal(ref<Polynomial> lhs, ref<Polynomial> rhs, AType type)
 {
     if (lhs->isConst() && rhs->isConst()) {
-        mpz_t lconst, rconst;
-        mpz_init(lconst);
-        mpz_init(rconst);
-        lhs->getConst(lconst);
-        rhs->getConst(rconst);
+        int cmp = lhs->getConst().compare(rhs->getConst());
         bool eval = true;
         if (type == Equ) {
-            eval = (mpz_cmp(lconst, rconst) == 0);
+            eval = (cmp == 0);
         } else if (type == Neq) {
-            eval = (mpz_cmp(lconst, rconst) != 0);
+            eval = (cmp != 0);
         } else if (type == Geq) {
-            eval = (mpz_cmp(lconst, rconst) >= 0);
+            eval = (cmp >= 0);
         } else if (type == Gtr) {
-            eval = (mpz_cmp(lconst, rconst) > 0);
+            eval = (cmp > 0);
         } else if (type == Leq) {
-            eval = (mpz_cmp(lconst, rconst) <= 0);
+            eval = (cmp <= 0);
         } else if (type == Lss) {
-            eval = (mpz_cmp(lconst, rconst) < 0);
+            eval = (cmp < 0);
         }
-        mpz_clear(lconst);
-        mpz_clear(rconst);
         if (eval) {
             return Constraint::_true;
         } else {
             return Constraint::_false;
         }
     } else {
-        return new Atom(lhs, rhs, type);
+        return getTable().intern(new Atom(lhs, rhs, type));
     }
 }
 
@@ -530,7 +551,7 @@ ref<Constraint> Atom::setAtomToTrue(ref<Constraint> c)
     }
 }
 
-void Atom::addVariablesToSet(std::set<std::string> &res)
+void Atom::addVariablesToSet(std::set<Symbol> &res)
 {
     m_lhs->addVariablesToSet(res);
     m_rhs->addVariablesToSet(res);
@@ -538,7 +559,16 @@ void Atom::addVariablesToSet(std::set<std::string> &res)
 
 bool Atom::equalsInternal(ref<Constraint> c)
 {
-    ref<Atom> atom = static_cast<Atom*>(c.get());
+    return this == c.get();
+}
+
+unsigned long Atom::getHash()
+{
+    return m_hash;
+}
+
+bool Atom::equalsStructurally(Atom *atom)
+{
     return m_type == atom->m_type && m_lhs->equals(atom->m_lhs) && m_rhs->equals(atom->m_rhs);
 }
 
@@ -566,15 +596,24 @@ ref<Constraint> Negation::create(ref<Constraint> c)
         return neg->m_c;
     }
 
-    return new Negation(c);
+    return getTable().intern(new Negation(c));
 }
 
 Negation::Negation(ref<Constraint> c)
-  : m_c(c)
+  : m_c(c),
+    m_hash(hashCombine(CNegation, c->getHash()))
 {}
 
 Negation::~Negation()
-{}
+{
+    getTable().remove(this);
+}
+
+HashConsTable<Negation> &Negation::getTable()
+{
+    static HashConsTable<Negation> *table = new HashConsTable<Negation>();
+    return *table;
+}
 
 Constraint::CType Negation::getCType()
 {
@@ -606,11 +645,16 @@ std::string Negation::toSMTString(bool)
     exit(217);
 }
 
-ref<Constraint> Negation::instantiate(std::map<std::string, ref<Polynomial> > *bindings)
+ref<Constraint> Negation::instantiate(std::map<Symbol, ref<Polynomial> > *bindings)
 {
     return create(m_c->instantiate(bindings));
 }
 
+ref<Constraint> Negation::getNegated()
+{
+    return m_c;
+}
+
 ref<Constraint> Negation::toNNF(bool negate)
 {
     return m_c->toNNF(!negate);
@@ -648,14 +692,23 @@ ref<Constraint> Negation::setAtomToTrue(ref<Constraint> c)
     exit(217);
 }
 
-void Negation::addVariablesToSet(std::set<std::string> &res)
+void Negation::addVariablesToSet(std::set<Symbol> &res)
 {
     m_c->addVariablesToSet(res);
 }
 
 bool Negation::equalsInternal(ref<Constraint> c)
 {
-    ref<Negation> neg = static_cast<Negation*>(c.get());
+    return this == c.get();
+}
+
+unsigned long Negation::getHash()
+{
+    return m_hash;
+}
+
+bool Negation::equalsStructurally(Negation *neg)
+{
     return m_c->equals(neg->m_c);
 }
 
@@ -663,7 +716,8 @@ bool Negation::equalsInternal(ref<Constraint> c)
 Operator::Operator(ref<Constraint> lhs, ref<Constraint> rhs, OType type)
   : m_lhs(lhs),
     m_rhs(rhs),
-    m_type(type)
+    m_type(type),
+    m_hash(hashCombine(hashCombine(hashCombine(COperator, type), lhs->getHash()), rhs->getHash()))
 {}
 
 ref<Constraint> Operator::create(ref<Constraint> lhs, ref<Constraint> rhs, Operator::OType type)
@@ -690,11 +744,19 @@ ref<Constraint> Operator::create(ref<Constraint> lhs, ref<Constraint> rhs, Opera
         }
     }
 
-    return new Operator(lhs, rhs, type);
+    return getTable().intern(new Operator(lhs, rhs, type));
 }
 
 Operator::~Operator()
-{}
+{
+    getTable().remove(this);
+}
+
+HashConsTable<Operator> &Operator::getTable()
+{
+    static HashConsTable<Operator> *table = new HashConsTable<Operator>();
+    return *table;
+}
 
 std::string Operator::typeToString(OType type)
 {
@@ -757,7 +819,7 @@ std::string Operator::toSMTString(bool onlyLinearPart)
     return res.str();
 }
 
-ref<Constraint> Operator::instantiate(std::map<std::string, ref<Polynomial> > *bindings)
+ref<Constraint> Operator::instantiate(std::map<Symbol, ref<Polynomial> > *bindings)
 {
     return create(m_lhs->instantiate(bindings), m_rhs->instantiate(bindings), m_type);
 }
@@ -780,38 +842,7 @@ ref<Constraint> Operator::toNNF(bool negate)
 
 ref<Constraint> Operator::toDNF(EliminateClass *elim)
 {
-    if (m_type == Or) {
-        return create(m_lhs->toDNF(elim), m_rhs->toDNF(elim), Or);
-    } else if (m_type == And) {
-        ref<Constraint> lhsdnf = m_lhs->toDNF(elim);
-        ref<Constraint> rhsdnf = m_rhs->toDNF(elim);
-        std::list<ref<Constraint> > lhsdcs;
-        lhsdnf->addDualClausesToList(lhsdcs);
-        std::list<ref<Constraint> > rhsdcs;
-        rhsdnf->addDualClausesToList(rhsdcs);
-        std::list<ref<Constraint> > combined;
-        for (std::list<ref<Constraint> >::iterator outeri = lhsdcs.begin(), outere = lhsdcs.end(); outeri != outere; ++outeri) {
-            ref<Constraint> outerdc = *outeri;
-            for (std::list<ref<Constraint> >::iterator inneri = rhsdcs.begin(), innere = rhsdcs.end(); inneri != innere; ++inneri) {
-                ref<Constraint> innerdc = *inneri;
-                ref<Constraint> c = create(outerdc, innerdc, And);
-                if (c->getCType() == Constraint::CFalse || !elim->shouldEliminate(c)) {
-                    combined.push_back(c);
-                } else {
-                    combined.push_back(_false);
-                }
-            }
-        }
-        ref<Constraint> res = *combined.rbegin();
-        combined.erase(--combined.end());
-        for (std::list<ref<Constraint> >::reverse_iterator ri = combined.rbegin(), re = combined.rend(); ri != re; ++ri) {
-            res = create(*ri, res, Or);
-        }
-        return res;
-    } else {
-        std::cerr << "Internal error in Operator::toDNF (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
-        exit(2107);
-    }
+    return DNF::create(this, elim).toConstraint();
 }
 
 void Operator::addDualClausesToList(std::list<ref<Constraint> > &res)
@@ -854,7 +885,7 @@ ref<Constraint> Operator::setAtomToTrue(ref<Constraint> c)
 }
 
 
-void Operator::addVariablesToSet(std::set<std::string> &res)
+void Operator::addVariablesToSet(std::set<Symbol> &res)
 {
     m_lhs->addVariablesToSet(res);
     m_rhs->addVariablesToSet(res);
@@ -872,6 +903,15 @@ ref<Constraint> Operator::getRight()
 
 bool Operator::equalsInternal(ref<Constraint> c)
 {
-    ref<Operator> op = static_cast<Operator*>(c.get());
+    return this == c.get();
+}
+
+unsigned long Operator::getHash()
+{
+    return m_hash;
+}
+
+bool Operator::equalsStructurally(Operator *op)
+{
     return m_type == op->m_type && m_lhs->equals(op->m_lhs) && m_rhs->equals(op->m_rhs);
 }
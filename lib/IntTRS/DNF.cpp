@@ -0,0 +1,242 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#include "llvm2kittel/IntTRS/DNF.h"
+#include "llvm2kittel/IntTRS/Constraint.h"
+#include "llvm2kittel/IntTRS/Polynomial.h"
+#include "llvm2kittel/ConstraintEliminator.h"
+
+// C++ includes
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <cstdlib>
+#include <iostream>
+
+DNF::Clause::Clause()
+  : literals(),
+    ids(),
+    outer(0),
+    outerLength(0)
+{}
+
+DNF::DNF()
+  : m_clauses()
+{}
+
+const std::vector<DNF::Clause> &DNF::getClauses() const
+{
+    return m_clauses;
+}
+
+DNF DNF::create(ref<Constraint> c, EliminateClass *elim)
+{
+    return normalize(c, false, elim);
+}
+
+DNF DNF::normalize(ref<Constraint> c, bool negate, EliminateClass *elim)
+{
+    Constraint::CType type = c->getCType();
+    if (type == Constraint::CTrue) {
+        return literal(negate ? Constraint::_false : Constraint::_true);
+    } else if (type == Constraint::CFalse) {
+        return literal(negate ? Constraint::_true : Constraint::_false);
+    } else if (type == Constraint::CNondef) {
+        return literal(c);
+    } else if (type == Constraint::CAtom) {
+        return atom(c, negate);
+    } else if (type == Constraint::CNegation) {
+        return normalize(static_cast<Negation*>(c.get())->getNegated(), !negate, elim);
+    }
+
+    Operator *op = static_cast<Operator*>(c.get());
+    bool conjunction = ((op->getOType() == Operator::And) != negate);
+    DNF lhs = normalize(op->getLeft(), negate, elim);
+    // false and true absorb conjunctions and disjunctions, respectively
+    if (conjunction ? lhs.m_clauses.empty() : lhs.isTrue()) {
+        return lhs;
+    }
+    DNF rhs = normalize(op->getRight(), negate, elim);
+    if (conjunction) {
+        return conjoin(lhs, rhs, elim);
+    } else {
+        return disjoin(lhs, rhs);
+    }
+}
+
+DNF DNF::atom(ref<Constraint> c, bool negate)
+{
+    ref<Constraint> a = negate ? c->toNNF(true) : c;
+    Atom *theAtom = static_cast<Atom*>(a.get());
+    if (a->getCType() != Constraint::CAtom || theAtom->getAType() != Atom::Neq) {
+        return literal(a);
+    }
+    DNF res;
+    Clause lss;
+    lss.literals.push_back(Atom::create(theAtom->getLeft(), theAtom->getRight(), Atom::Lss));
+    lss.ids.push_back(lss.literals.back().get());
+    res.m_clauses.push_back(lss);
+    Clause gtr;
+    gtr.literals.push_back(Atom::create(theAtom->getLeft(), theAtom->getRight(), Atom::Gtr));
+    gtr.ids.push_back(gtr.literals.back().get());
+    res.m_clauses.push_back(gtr);
+    return res;
+}
+
+DNF DNF::literal(ref<Constraint> c)
+{
+    DNF res;
+    Constraint::CType type = c->getCType();
+    if (type == Constraint::CFalse) {
+        return res;
+    }
+    Clause clause;
+    if (type == Constraint::CAtom) {
+        clause.literals.push_back(c);
+        clause.ids.push_back(c.get());
+    }
+    res.m_clauses.push_back(clause);
+    return res;
+}
+
+bool DNF::isTrue() const
+{
+    return m_clauses.size() == 1 && m_clauses.front().literals.empty();
+}
+
+DNF DNF::disjoin(const DNF &lhs, const DNF &rhs)
+{
+    DNF res = lhs;
+    for (std::vector<Clause>::const_iterator i = rhs.m_clauses.begin(), e = rhs.m_clauses.end(); i != e; ++i) {
+        res.add(*i);
+    }
+    return res;
+}
+
+DNF DNF::conjoin(const DNF &lhs, const DNF &rhs, EliminateClass *elim)
+{
+    DNF product;
+    for (unsigned int outer = 0; outer < lhs.m_clauses.size(); ++outer) {
+        const Clause &outerClause = lhs.m_clauses[outer];
+        for (std::vector<Clause>::const_iterator inneri = rhs.m_clauses.begin(), innere = rhs.m_clauses.end(); inneri != innere; ++inneri) {
+            Clause clause;
+            if (merge(outerClause, *inneri, clause)) {
+                clause.outer = outer;
+                clause.outerLength = outerClause.literals.size();
+                product.add(clause);
+            }
+        }
+    }
+
+    // only the clauses that survived the syntactic checks go to the solver,
+    // grouped by their outer clause so that it is only asserted once
+    std::vector<EliminateClass::ClauseGroup> groups;
+    std::vector<unsigned int> groupOf(lhs.m_clauses.size(), 0);
+    std::vector<bool> hasGroup(lhs.m_clauses.size(), false);
+    for (std::vector<Clause>::iterator i = product.m_clauses.begin(), e = product.m_clauses.end(); i != e; ++i) {
+        if (i->literals.empty()) {
+            continue;
+        }
+        if (!hasGroup[i->outer]) {
+            hasGroup[i->outer] = true;
+            groupOf[i->outer] = static_cast<unsigned int>(groups.size());
+            groups.push_back(EliminateClass::ClauseGroup());
+            groups.back().prefix = toConstraint(lhs.m_clauses[i->outer]);
+        }
+        EliminateClass::ClauseGroup &group = groups[groupOf[i->outer]];
+        Clause extension;
+        extension.literals.assign(i->literals.begin() + static_cast<std::ptrdiff_t>(i->outerLength), i->literals.end());
+        group.extensions.push_back(toConstraint(extension));
+        group.clauses.push_back(toConstraint(*i));
+    }
+    std::vector<std::vector<bool> > eliminate;
+    if (!groups.empty()) {
+        elim->shouldEliminateGroups(groups, eliminate);
+    }
+
+    DNF res;
+    std::vector<unsigned int> next(groups.size(), 0);
+    for (std::vector<Clause>::iterator i = product.m_clauses.begin(), e = product.m_clauses.end(); i != e; ++i) {
+        if (!i->literals.empty()) {
+            unsigned int group = groupOf[i->outer];
+            if (eliminate[group][next[group]++]) {
+                continue;
+            }
+        }
+        res.m_clauses.push_back(*i);
+    }
+    return res;
+}
+
+void DNF::add(const Clause &clause)
+{
+    for (std::vector<Clause>::iterator i = m_clauses.begin(), e = m_clauses.end(); i != e; ++i) {
+        if (subsumes(*i, clause)) {
+            return;
+        }
+    }
+    std::vector<Clause>::iterator keep = m_clauses.begin();
+    for (std::vector<Clause>::iterator i = m_clauses.begin(), e = m_clauses.end(); i != e; ++i) {
+        if (!subsumes(clause, *i)) {
+            if (keep != i) {
+                *keep = *i;
+            }
+            ++keep;
+        }
+    }
+    m_clauses.erase(keep, m_clauses.end());
+    m_clauses.push_back(clause);
+}
+
+bool DNF::merge(const Clause &lhs, const Clause &rhs, Clause &res)
+{
+    // both clauses are free of contradictions, so only pairs across them can clash
+    for (std::vector<ref<Constraint> >::const_iterator i = rhs.literals.begin(), e = rhs.literals.end(); i != e; ++i) {
+        ref<Constraint> negated = (*i)->toNNF(true);
+        if (std::binary_search(lhs.ids.begin(), lhs.ids.end(), negated.get())) {
+            return false;
+        }
+    }
+    res.literals = lhs.literals;
+    for (std::vector<ref<Constraint> >::const_iterator i = rhs.literals.begin(), e = rhs.literals.end(); i != e; ++i) {
+        if (!std::binary_search(lhs.ids.begin(), lhs.ids.end(), i->get())) {
+            res.literals.push_back(*i);
+        }
+    }
+    res.ids.reserve(lhs.ids.size() + rhs.ids.size());
+    std::set_union(lhs.ids.begin(), lhs.ids.end(), rhs.ids.begin(), rhs.ids.end(), std::back_inserter(res.ids));
+    return true;
+}
+
+bool DNF::subsumes(const Clause &lhs, const Clause &rhs)
+{
+    return lhs.ids.size() <= rhs.ids.size() && std::includes(rhs.ids.begin(), rhs.ids.end(), lhs.ids.begin(), lhs.ids.end());
+}
+
+ref<Constraint> DNF::toConstraint(const Clause &clause)
+{
+    if (clause.literals.empty()) {
+        return Constraint::_true;
+    }
+    ref<Constraint> res = clause.literals.back();
+    for (std::vector<ref<Constraint> >::const_reverse_iterator ri = clause.literals.rbegin() + 1, re = clause.literals.rend(); ri != re; ++ri) {
+        res = Operator::create(*ri, res, Operator::And);
+    }
+    return res;
+}
+
+ref<Constraint> DNF::toConstraint() const
+{
+    if (m_clauses.empty()) {
+        return Constraint::_false;
+    }
+    ref<Constraint> res = toConstraint(m_clauses.back());
+    for (std::vector<Clause>::const_reverse_iterator ri = m_clauses.rbegin() + 1, re = m_clauses.rend(); ri != re; ++ri) {
+        res = Operator::create(toConstraint(*ri), res, Operator::Or);
+    }
+    return res;
+}
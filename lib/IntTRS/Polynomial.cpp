@@ -6,20 +6,22 @@
 // See LICENSE for details.
 
 #include "llvm2kittel/IntTRS/Polynomial.h"
-#include "llvm2kittel/Util/gmp_kittel.h"
+#include "llvm2kittel/Util/Mutex.h"
 
 // C++ includes
+#include <algorithm>
 #include <sstream>
+#include <climits>
 #include <cstdlib>
 
-Monomial::Monomial(std::string x)
+Monomial::Monomial(Symbol x)
   : refCount(0),
     m_powers()
 {
     m_powers.push_back(std::make_pair(x, 1));
 }
 
-ref<Monomial> Monomial::create(std::string x)
+ref<Monomial> Monomial::create(Symbol x)
 {
     return new Monomial(x);
 }
@@ -27,13 +29,16 @@ ref<Monomial> Monomial::create(std::string x)
 Monomial::~Monomial()
 {}
 
-unsigned int Monomial::getPower(std::string x)
+static bool powerLess(const std::pair<Symbol, unsigned int> &p, Symbol x)
 {
-    for (std::list<std::pair<std::string, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end(); i != e; ++i) {
-        std::pair<std::string, unsigned int> &tmp = *i;
-        if (tmp.first == x) {
-            return tmp.second;
-        }
+    return p.first < x;
+}
+
+unsigned int Monomial::getPower(Symbol x)
+{
+    std::vector<std::pair<Symbol, unsigned int> >::iterator found = std::lower_bound(m_powers.begin(), m_powers.end(), x, powerLess);
+    if (found != m_powers.end() && found->first == x) {
+        return found->second;
     }
     return 0;
 }
@@ -45,13 +50,23 @@ bool Monomial::empty()
 
 bool Monomial::equals(ref<Monomial> mono)
 {
-    for (std::list<std::pair<std::string, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end(); i != e; ++i) {
-        std::pair<std::string, unsigned int> &tmp = *i;
-        if (mono->getPower(tmp.first) != tmp.second) {
-            return false;
+    return m_powers == mono->m_powers;
+}
+
+int Monomial::compare(ref<Monomial> mono)
+{
+    for (std::vector<std::pair<Symbol, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end(), oi = mono->m_powers.begin(), oe = mono->m_powers.end(); i != e; ++i, ++oi) {
+        if (oi == oe) {
+            return 1;
+        }
+        if (i->first != oi->first) {
+            return (i->first < oi->first) ? -1 : 1;
+        }
+        if (i->second != oi->second) {
+            return (i->second < oi->second) ? -1 : 1;
         }
     }
-    return true;
+    return (m_powers.size() == mono->m_powers.size()) ? 0 : -1;
 }
 
 bool Monomial::isUnivariateLinear()
@@ -59,7 +74,7 @@ bool Monomial::isUnivariateLinear()
     if (m_powers.size() != 1) {
         return false;
     } else {
-        std::pair<std::string, unsigned int> &tmp = *m_powers.begin();
+        std::pair<Symbol, unsigned int> &tmp = *m_powers.begin();
         return tmp.second == 1;
     }
 }
@@ -67,12 +82,12 @@ bool Monomial::isUnivariateLinear()
 std::string Monomial::toString()
 {
     std::ostringstream sstr;
-    for (std::list<std::pair<std::string, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end(); i != e; ) {
-        std::pair<std::string, unsigned int> &tmp = *i;
+    for (std::vector<std::pair<Symbol, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end(); i != e; ) {
+        std::pair<Symbol, unsigned int> &tmp = *i;
         if (tmp.second == 1) {
-            sstr << tmp.first;
+            sstr << tmp.first.getName();
         } else {
-            sstr << tmp.first << '^' << tmp.second;
+            sstr << tmp.first.getName() << '^' << tmp.second;
         }
         if (++i != e) {
             sstr << '*';
@@ -84,18 +99,18 @@ std::string Monomial::toString()
 std::string Monomial::toSMTString()
 {
     std::ostringstream sstr;
-    for (std::list<std::pair<std::string, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end(); i != e; ) {
-        std::pair<std::string, unsigned int> &tmp = *i;
+    for (std::vector<std::pair<Symbol, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end(); i != e; ) {
+        std::pair<Symbol, unsigned int> &tmp = *i;
         if (m_powers.size() != 1) {
             sstr << "(* ";
         }
         if (tmp.second == 1) {
-            sstr << tmp.first;
+            sstr << tmp.first.getName();
         } else {
             for (unsigned int c = 1; c < tmp.second; ++c) {
-                sstr << "(* " << tmp.first << " ";
+                sstr << "(* " << tmp.first.getName() << " ";
             }
-            sstr << tmp.first;
+            sstr << tmp.first.getName();
             for (unsigned int c = 1; c < tmp.second; ++c) {
                 sstr << ")";
             }
@@ -112,59 +127,52 @@ std::string Monomial::toSMTString()
 
 ref<Monomial> Monomial::mult(ref<Monomial> mono)
 {
-    ref<Monomial> res = create("x");
-    res->m_powers.clear();
-    for (std::list<std::pair<std::string, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end(); i != e; ++i) {
-        std::pair<std::string, unsigned int> &tmp = *i;
-        unsigned int otherPower = mono->getPower(tmp.first);
-        unsigned int newPower = tmp.second + otherPower;
-        if (newPower != 0) {
-            res->m_powers.push_back(std::make_pair(tmp.first, newPower));
-        }
-    }
-    for (std::list<std::pair<std::string, unsigned int> >::iterator i = mono->m_powers.begin(), e = mono->m_powers.end(); i != e; ++i) {
-        std::pair<std::string, unsigned int> &tmp = *i;
-        if (getPower(tmp.first) == 0) {
-            res->m_powers.push_back(tmp);
-        }
-    }
-    return res;
-}
-
-ref<Monomial> Monomial::lowerFirst()
-{
-    ref<Monomial> res = create("x");
+    ref<Monomial> res = create(Symbol());
     res->m_powers.clear();
-    bool isFirst = true;
-    for (std::list<std::pair<std::string, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end(); i != e; ++i) {
-        std::pair<std::string, unsigned int> &tmp = *i;
-        if (isFirst) {
-            if (tmp.second != 1) {
-                res->m_powers.push_back(std::make_pair(tmp.first, tmp.second - 1));
-            }
-            isFirst = false;
+    res->m_powers.reserve(m_powers.size() + mono->m_powers.size());
+    std::vector<std::pair<Symbol, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end();
+    std::vector<std::pair<Symbol, unsigned int> >::iterator oi = mono->m_powers.begin(), oe = mono->m_powers.end();
+    while (i != e && oi != oe) {
+        if (i->first < oi->first) {
+            res->m_powers.push_back(*i++);
+        } else if (oi->first < i->first) {
+            res->m_powers.push_back(*oi++);
         } else {
-            res->m_powers.push_back(tmp);
+            res->m_powers.push_back(std::make_pair(i->first, i->second + oi->second));
+            ++i;
+            ++oi;
         }
     }
+    res->m_powers.insert(res->m_powers.end(), i, e);
+    res->m_powers.insert(res->m_powers.end(), oi, oe);
     return res;
 }
 
-std::string Monomial::getFirst()
+Symbol Monomial::getFirst()
 {
     return m_powers.begin()->first;
 }
 
-void Monomial::addVariablesToSet(std::set<std::string> &res)
+void Monomial::addVariablesToSet(std::set<Symbol> &res)
 {
-    for (std::list<std::pair<std::string, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end(); i != e; ++i) {
-        std::pair<std::string, unsigned int> &tmp = *i;
+    for (std::vector<std::pair<Symbol, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end(); i != e; ++i) {
+        std::pair<Symbol, unsigned int> &tmp = *i;
         if (tmp.second != 0) {
-            res.insert(tmp.first);
+            res.insert(res.end(), tmp.first);
         }
     }
 }
 
+unsigned long Monomial::getHash()
+{
+    unsigned long res = 0;
+    for (std::vector<std::pair<Symbol, unsigned int> >::iterator i = m_powers.begin(), e = m_powers.end(); i != e; ++i) {
+        res = hashCombine(res, i->first.getId());
+        res = hashCombine(res, i->second);
+    }
+    return res;
+}
+
 ref<Polynomial> Polynomial::null;
 ref<Polynomial> Polynomial::one;
 ref<Polynomial> Polynomial::negone;
@@ -196,149 +204,185 @@ bool Polynomial::init()
     return true;
 }
 
+// guards the caches of constants, which functions converted in parallel share
+static NodeMutex &getConstantsMutex()
+{
+    static NodeMutex *mutex = new NodeMutex();
+    return *mutex;
+}
+
 ref<Polynomial> Polynomial::simax(unsigned int bitwidth)
 {
+    ScopedLock<NodeMutex> lock(getConstantsMutex());
     std::map<unsigned int, ref<Polynomial> >::iterator found = m_simax.find(bitwidth);
     if (found != m_simax.end()) {
         return found->second;
     }
-    mpz_t tmp;
-    mpz_init(tmp);
-    mpz_kittel_set_simax(tmp, bitwidth);
-    ref<Polynomial> pol = create(tmp);
-    mpz_clear(tmp);
+    ref<Polynomial> pol = create(Integer::powerOfTwo(bitwidth - 1) - 1);
     m_simax.insert(std::make_pair(bitwidth, pol));
     return pol;
 }
 
 ref<Polynomial> Polynomial::simin_as_ui(unsigned int bitwidth)
 {
+    ScopedLock<NodeMutex> lock(getConstantsMutex());
     std::map<unsigned int, ref<Polynomial> >::iterator found = m_simin_as_ui.find(bitwidth);
     if (found != m_simin_as_ui.end()) {
         return found->second;
     }
-    mpz_t tmp;
-    mpz_init(tmp);
-    mpz_kittel_set_simin_as_ui(tmp, bitwidth);
-    ref<Polynomial> pol = create(tmp);
-    mpz_clear(tmp);
+    ref<Polynomial> pol = create(Integer::powerOfTwo(bitwidth - 1));
     m_simin_as_ui.insert(std::make_pair(bitwidth, pol));
     return pol;
 }
 
 ref<Polynomial> Polynomial::simin(unsigned int bitwidth)
 {
+    ScopedLock<NodeMutex> lock(getConstantsMutex());
     std::map<unsigned int, ref<Polynomial> >::iterator found = m_simin.find(bitwidth);
     if (found != m_simin.end()) {
         return found->second;
     }
-    mpz_t tmp;
-    mpz_init(tmp);
-    mpz_kittel_set_simin(tmp, bitwidth);
-    ref<Polynomial> pol = create(tmp);
-    mpz_clear(tmp);
+    ref<Polynomial> pol = create(-Integer::powerOfTwo(bitwidth - 1));
     m_simin.insert(std::make_pair(bitwidth, pol));
     return pol;
 }
 
 ref<Polynomial> Polynomial::uimax(unsigned int bitwidth)
 {
+    ScopedLock<NodeMutex> lock(getConstantsMutex());
     std::map<unsigned int, ref<Polynomial> >::iterator found = m_uimax.find(bitwidth);
     if (found != m_uimax.end()) {
         return found->second;
     }
-    mpz_t tmp;
-    mpz_init(tmp);
-    mpz_kittel_set_uimax(tmp, bitwidth);
-    ref<Polynomial> pol = create(tmp);
-    mpz_clear(tmp);
+    ref<Polynomial> pol = create(Integer::powerOfTwo(bitwidth) - 1);
     m_uimax.insert(std::make_pair(bitwidth, pol));
     return pol;
 }
 
 ref<Polynomial> Polynomial::power_of_two(unsigned int power)
 {
+    ScopedLock<NodeMutex> lock(getConstantsMutex());
     std::map<unsigned int, ref<Polynomial> >::iterator found = m_power_of_two.find(power);
     if (found != m_power_of_two.end()) {
         return found->second;
     }
-    mpz_t tmp;
-    mpz_init(tmp);
-    mpz_kittel_set_power_of_two(tmp, power);
-    ref<Polynomial> pol = create(tmp);
-    mpz_clear(tmp);
+    ref<Polynomial> pol = create(Integer::powerOfTwo(power));
     m_power_of_two.insert(std::make_pair(power, pol));
     return pol;
 }
 
-Polynomial::Polynomial(std::string x)
+Polynomial::Polynomial(Symbol x)
   : refCount(0),
-    m_monos()
+    m_monos(),
+    m_constant(),
+    m_hash(0)
 {
-    mpz_init(m_constant);
-    m_monos.push_back(std::make_pair(mpz_class(Polynomial::_one), Monomial::create(x)));
+    m_monos.push_back(std::make_pair(Integer(1), Monomial::create(x)));
 }
 
-ref<Polynomial> Polynomial::create(std::string x)
+ref<Polynomial> Polynomial::create(Symbol x)
 {
-    return new Polynomial(x);
+    return intern(new Polynomial(x));
 }
 
-Polynomial::Polynomial(mpz_t c)
-  : refCount(0),
-    m_monos()
+ref<Polynomial> Polynomial::create(const std::string &x)
 {
-    mpz_init_set(m_constant, c);
+    return intern(new Polynomial(Symbol(x)));
 }
 
+Polynomial::Polynomial(const Integer &c)
+  : refCount(0),
+    m_monos(),
+    m_constant(c),
+    m_hash(0)
+{}
+
 ref<Polynomial> Polynomial::create(mpz_t c)
 {
-    return new Polynomial(c);
+    return intern(new Polynomial(Integer(c)));
+}
+
+ref<Polynomial> Polynomial::create(const Integer &c)
+{
+    return intern(new Polynomial(c));
 }
 
 Polynomial::Polynomial(ref<Monomial> mono)
   : refCount(0),
-    m_monos()
+    m_monos(),
+    m_constant(),
+    m_hash(0)
 {
-    mpz_init(m_constant);
-    m_monos.push_back(std::make_pair(mpz_class(Polynomial::_one), mono));
+    m_monos.push_back(std::make_pair(Integer(1), mono));
 }
 
 ref<Polynomial> Polynomial::create(ref<Monomial> mono)
 {
-    return new Polynomial(mono);
+    return intern(new Polynomial(mono));
 }
 
 Polynomial::~Polynomial()
 {
-    mpz_clear(m_constant);
+    getTable().remove(this);
+}
+
+HashConsTable<Polynomial> &Polynomial::getTable()
+{
+    // never destroyed, as static polynomials remove themselves on exit
+    static HashConsTable<Polynomial> *table = new HashConsTable<Polynomial>();
+    return *table;
+}
+
+ref<Polynomial> Polynomial::intern(Polynomial *p)
+{
+    unsigned long hash = p->m_constant.getHash();
+    for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator i = p->m_monos.begin(), e = p->m_monos.end(); i != e; ++i) {
+        hash = hashCombine(hash, i->first.getHash());
+        hash = hashCombine(hash, i->second->getHash());
+    }
+    p->m_hash = hash;
+    return getTable().intern(p);
+}
+
+unsigned long Polynomial::getHash()
+{
+    return m_hash;
+}
+
+static bool monoLess(const std::pair<Integer, ref<Monomial> > &p, const std::pair<Integer, ref<Monomial> > &q)
+{
+    return p.second->compare(q.second) < 0;
 }
 
 void Polynomial::getCoeff(mpz_t res, ref<Monomial> mono)
 {
-    for (std::list<std::pair<mpz_class, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
-        std::pair<mpz_class, ref<Monomial> > &tmp = *i;
-        if (mono->equals(tmp.second)) {
-            mpz_set(res, tmp.first.get_mpz_t());
-        }
+    std::pair<Integer, ref<Monomial> > key = std::make_pair(Integer(), mono);
+    std::vector<std::pair<Integer, ref<Monomial> > >::iterator found = std::lower_bound(m_monos.begin(), m_monos.end(), key, monoLess);
+    if (found != m_monos.end() && mono->equals(found->second)) {
+        found->first.get(res);
     }
     return;
 }
 
 void Polynomial::getConst(mpz_t res)
 {
-    mpz_set(res, m_constant);
+    m_constant.get(res);
+}
+
+Integer Polynomial::getConst()
+{
+    return m_constant;
 }
 
 bool Polynomial::isVar()
 {
-    if (mpz_cmp(m_constant, Polynomial::_null) != 0) {
+    if (m_constant.sgn() != 0) {
         return false;
     } else if (m_monos.size() != 1) {
         return false;
     } else {
-        std::pair<mpz_class, ref<Monomial> > &tmp = *m_monos.begin();
-        return (mpz_cmp(tmp.first.get_mpz_t(), Polynomial::_one) == 0) && (tmp.second->isUnivariateLinear());
+        std::pair<Integer, ref<Monomial> > &tmp = *m_monos.begin();
+        return (tmp.first == Integer(1)) && (tmp.second->isUnivariateLinear());
     }
 }
 
@@ -348,7 +392,7 @@ bool Polynomial::isUnivariateLinear()
     if (m_monos.size() != 1) {
         return false;
     } else {
-        std::pair<mpz_class, ref<Monomial> > &tmp = *m_monos.begin();
+        std::pair<Integer, ref<Monomial> > &tmp = *m_monos.begin();
         return tmp.second->isUnivariateLinear();
     }
 }
@@ -360,8 +404,8 @@ bool Polynomial::isConst()
 
 bool Polynomial::isLinear()
 {
-    for (std::list<std::pair<mpz_class, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
-        std::pair<mpz_class, ref<Monomial> > &tmp = *i;
+    for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
+        std::pair<Integer, ref<Monomial> > &tmp = *i;
         if (!tmp.second->isUnivariateLinear()) {
             return false;
         }
@@ -376,59 +420,47 @@ std::string Polynomial::toString()
         sstr << m_constant;
     } else {
         bool isFirst = true;
-        for (std::list<std::pair<mpz_class, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ) {
-            std::pair<mpz_class, ref<Monomial> > &tmp = *i;
-            if (mpz_cmp(tmp.first.get_mpz_t(), Polynomial::_one) == 0) {
+        for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ) {
+            std::pair<Integer, ref<Monomial> > &tmp = *i;
+            if (tmp.first == Integer(1)) {
                 // Do nothing
-            } else if (mpz_cmp(tmp.first.get_mpz_t(), Polynomial::_negone) == 0) {
+            } else if (tmp.first == Integer(-1)) {
                 if (isFirst) {
                     sstr << '-';
                 }
             } else {
                 if (isFirst) {
-                    if (mpz_cmp(tmp.first.get_mpz_t(), Polynomial::_null) < 0) {
+                    if (tmp.first.sgn() < 0) {
                         sstr << '-';
                     }
                 }
-                mpz_t abs;
-                mpz_init(abs);
-                mpz_abs(abs, tmp.first.get_mpz_t());
-                sstr << abs << '*';
-                mpz_clear(abs);
+                sstr << tmp.first.abs() << '*';
             }
             sstr << tmp.second->toString();
             isFirst = false;
             if (++i != e) {
-                std::pair<mpz_class, ref<Monomial> > peek = *i;
-                if (mpz_cmp(peek.first.get_mpz_t(), Polynomial::_null) < 0) {
+                std::pair<Integer, ref<Monomial> > peek = *i;
+                if (peek.first.sgn() < 0) {
                     sstr << " - ";
                 } else {
                     sstr << " + ";
                 }
             }
         }
-        if (mpz_cmp(m_constant, Polynomial::_null) < 0) {
-            mpz_t abs;
-            mpz_init(abs);
-            mpz_abs(abs, m_constant);
-            sstr << " - " << abs;
-            mpz_clear(abs);
-        } else if (mpz_cmp(m_constant, Polynomial::_null) > 0) {
+        if (m_constant.sgn() < 0) {
+            sstr << " - " << m_constant.abs();
+        } else if (m_constant.sgn() > 0) {
             sstr << " + " << m_constant;
         }
     }
     return sstr.str();
 }
 
-std::string Polynomial::constantToSMTString(mpz_class &constant)
+std::string Polynomial::constantToSMTString(const Integer &constant)
 {
     std::ostringstream sstr;
-    if (mpz_cmp(constant.get_mpz_t(), Polynomial::_null) < 0) {
-        mpz_t abs;
-        mpz_init(abs);
-        mpz_abs(abs, constant.get_mpz_t());
-        sstr << "(- " << abs << ")";
-        mpz_clear(abs);
+    if (constant.sgn() < 0) {
+        sstr << "(- " << constant.abs() << ")";
     } else {
         sstr << constant;
     }
@@ -439,15 +471,13 @@ std::string Polynomial::toSMTString()
 {
     std::ostringstream sstr;
     if (m_monos.empty()) {
-        mpz_class constant = mpz_class(m_constant);
-        return constantToSMTString(constant);
+        return constantToSMTString(m_constant);
     } else {
-        for (std::list<std::pair<mpz_class, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
-            std::pair<mpz_class, ref<Monomial> > &tmp = *i;
+        for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
+            std::pair<Integer, ref<Monomial> > &tmp = *i;
             sstr << "(+ (* " << constantToSMTString(tmp.first) << " " << tmp.second->toSMTString() << ") ";
         }
-        mpz_class constant = mpz_class(m_constant);
-        sstr << constantToSMTString(constant);
+        sstr << constantToSMTString(m_constant);
         for (unsigned int c = 0; c < m_monos.size(); ++c) {
             sstr << ")";
         }
@@ -455,163 +485,212 @@ std::string Polynomial::toSMTString()
     return sstr.str();
 }
 
-ref<Polynomial> Polynomial::add(ref<Polynomial> poly)
+void Polynomial::merge(std::vector<std::pair<Integer, ref<Monomial> > > &a, std::vector<std::pair<Integer, ref<Monomial> > > &b, bool negate, std::vector<std::pair<Integer, ref<Monomial> > > &res)
+{
+    res.reserve(a.size() + b.size());
+    std::vector<std::pair<Integer, ref<Monomial> > >::iterator ai = a.begin(), ae = a.end();
+    std::vector<std::pair<Integer, ref<Monomial> > >::iterator bi = b.begin(), be = b.end();
+    while (ai != ae || bi != be) {
+        int cmp = (ai == ae) ? 1 : ((bi == be) ? -1 : ai->second->compare(bi->second));
+        if (cmp < 0) {
+            res.push_back(*ai);
+            ++ai;
+        } else if (cmp > 0) {
+            if (negate) {
+                res.push_back(std::make_pair(-bi->first, bi->second));
+            } else {
+                res.push_back(*bi);
+            }
+            ++bi;
+        } else {
+            Integer newCoeff = negate ? ai->first - bi->first : ai->first + bi->first;
+            if (newCoeff.sgn() != 0) {
+                res.push_back(std::make_pair(newCoeff, ai->second));
+            }
+            ++ai;
+            ++bi;
+        }
+    }
+}
+
+void Polynomial::normalize(std::vector<std::pair<Integer, ref<Monomial> > > &monos)
 {
-    mpz_t newConstant;
-    mpz_init(newConstant);
-    mpz_add(newConstant, m_constant, poly->m_constant);
-    ref<Polynomial> res = create(newConstant);
-    mpz_clear(newConstant);
-    for (std::list<std::pair<mpz_class, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
-        std::pair<mpz_class, ref<Monomial> > &tmp = *i;
-        mpz_t otherCoeff;
-        mpz_init(otherCoeff);
-        poly->getCoeff(otherCoeff, tmp.second);
-        mpz_t newCoeff;
-        mpz_init(newCoeff);
-        mpz_add(newCoeff, tmp.first.get_mpz_t(), otherCoeff);
-        mpz_clear(otherCoeff);
-        if (mpz_cmp(newCoeff, Polynomial::_null) != 0) {
-            res->m_monos.push_back(std::make_pair(mpz_class(newCoeff), tmp.second));
+    std::stable_sort(monos.begin(), monos.end(), monoLess);
+    std::vector<std::pair<Integer, ref<Monomial> > >::iterator out = monos.begin();
+    for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator i = monos.begin(), e = monos.end(); i != e; ) {
+        Integer coeff = i->first;
+        ref<Monomial> mono = i->second;
+        for (++i; i != e && mono->equals(i->second); ++i) {
+            coeff += i->first;
         }
-        mpz_clear(newCoeff); // The mpz_class constructor does not take ownership
-    }
-    for (std::list<std::pair<mpz_class, ref<Monomial> > >::iterator i = poly->m_monos.begin(), e = poly->m_monos.end(); i != e; ++i) {
-        std::pair<mpz_class, ref<Monomial> > &tmp = *i;
-        mpz_t coeff;
-        mpz_init(coeff);
-        getCoeff(coeff, tmp.second);
-        if (mpz_cmp(coeff, Polynomial::_null) == 0) {
-            res->m_monos.push_back(tmp);
+        if (coeff.sgn() != 0) {
+            out->first = coeff;
+            out->second = mono;
+            ++out;
         }
-        mpz_clear(coeff);
     }
-    return res;
+    monos.erase(out, monos.end());
+}
+
+ref<Polynomial> Polynomial::add(ref<Polynomial> poly)
+{
+    Polynomial *res = new Polynomial(m_constant + poly->m_constant);
+    merge(m_monos, poly->m_monos, false, res->m_monos);
+    return intern(res);
 }
 
 ref<Polynomial> Polynomial::sub(ref<Polynomial> poly)
 {
-    return add(poly->constMult(Polynomial::_negone));
+    Polynomial *res = new Polynomial(m_constant - poly->m_constant);
+    merge(m_monos, poly->m_monos, true, res->m_monos);
+    return intern(res);
 }
 
 ref<Polynomial> Polynomial::constMult(mpz_t d)
 {
-    if (mpz_cmp(d, Polynomial::_null) == 0) {
+    return constMult(Integer(d));
+}
+
+ref<Polynomial> Polynomial::constMult(const Integer &d)
+{
+    if (d.sgn() == 0) {
         return Polynomial::null;
     } else {
-        mpz_t newConstant;
-        mpz_init(newConstant);
-        mpz_mul(newConstant, m_constant, d);
-        ref<Polynomial> res = create(newConstant);
-        mpz_clear(newConstant);
-        for (std::list<std::pair<mpz_class, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
-            std::pair<mpz_class, ref<Monomial> > &tmp = *i;
-            mpz_t newCoeff;
-            mpz_init(newCoeff);
-            mpz_mul(newCoeff, tmp.first.get_mpz_t(), d);
-            res->m_monos.push_back(std::make_pair(mpz_class(newCoeff), tmp.second));
-            mpz_clear(newCoeff); // The mpz_class constructor does not take ownership
+        Polynomial *res = new Polynomial(m_constant * d);
+        res->m_monos.reserve(m_monos.size());
+        for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
+            std::pair<Integer, ref<Monomial> > &tmp = *i;
+            res->m_monos.push_back(std::make_pair(tmp.first * d, tmp.second));
         }
-        return res;
+        return intern(res);
     }
 }
 
 ref<Polynomial> Polynomial::mult(ref<Polynomial> poly)
 {
     if (poly->isConst()) {
-        ref<Polynomial> res = this->constMult(poly->m_constant);
-        return res;
-    }
-    ref<Polynomial> pp = Polynomial::null;
-    for (std::list<std::pair<mpz_class, ref<Monomial> > >::iterator oi = m_monos.begin(), oe = m_monos.end(); oi != oe; ++oi) {
-        std::pair<mpz_class, ref<Monomial> > &outer = *oi;
-        for (std::list<std::pair<mpz_class, ref<Monomial> > >::iterator ii = poly->m_monos.begin(), ie = poly->m_monos.end(); ii != ie; ++ii) {
-            std::pair<mpz_class, ref<Monomial> > &inner = *ii;
-            ref<Polynomial> tmp = create(outer.second->mult(inner.second));
-            mpz_t newCoeff;
-            mpz_init(newCoeff);
-            mpz_mul(newCoeff, outer.first.get_mpz_t(), inner.first.get_mpz_t());
-            if (mpz_cmp(newCoeff, Polynomial::_null) != 0) {
-                pp = pp->add(tmp->constMult(newCoeff));
-            }
-            mpz_clear(newCoeff);
+        return constMult(poly->m_constant);
+    } else if (isConst()) {
+        return poly->constMult(m_constant);
+    }
+    Polynomial *res = new Polynomial(m_constant * poly->m_constant);
+    std::vector<std::pair<Integer, ref<Monomial> > > &monos = res->m_monos;
+    monos.reserve((m_monos.size() + 1) * (poly->m_monos.size() + 1) - 1);
+    for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator oi = m_monos.begin(), oe = m_monos.end(); oi != oe; ++oi) {
+        std::pair<Integer, ref<Monomial> > &outer = *oi;
+        for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator ii = poly->m_monos.begin(), ie = poly->m_monos.end(); ii != ie; ++ii) {
+            std::pair<Integer, ref<Monomial> > &inner = *ii;
+            monos.push_back(std::make_pair(outer.first * inner.first, outer.second->mult(inner.second)));
+        }
+        if (poly->m_constant.sgn() != 0) {
+            monos.push_back(std::make_pair(outer.first * poly->m_constant, outer.second));
         }
     }
-    ref<Polynomial> polyZero = create(_null);
-    polyZero->m_monos = poly->m_monos;
-    ref<Polynomial> cp = polyZero->constMult(m_constant);
-    ref<Polynomial> thisZero = create(_null);
-    thisZero->m_monos = m_monos;
-    ref<Polynomial> pc = thisZero->constMult(poly->m_constant);
-    mpz_t newConstant;
-    mpz_init(newConstant);
-    mpz_mul(newConstant, m_constant, poly->m_constant);
-    ref<Polynomial> cc = create(newConstant);
-    mpz_clear(newConstant);
-    return pp->add(cp->add(pc->add(cc)));
-}
-
-ref<Polynomial> Polynomial::instantiate(std::map<std::string, ref<Polynomial> > *bindings)
-{
-    ref<Polynomial> res = create(m_constant);
-    for (std::list<std::pair<mpz_class, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
-        ref<Polynomial> accu = Polynomial::one;
-        std::pair<mpz_class, ref<Monomial> > &tmp = *i;
-        ref<Monomial> mono = tmp.second;
-        while (!mono->empty()) {
-            std::string x = mono->getFirst();
-            mono = mono->lowerFirst();
-            ref<Polynomial> xnew = create(x);
-            std::map<std::string, ref<Polynomial> >::iterator found = bindings->find(x);
+    if (m_constant.sgn() != 0) {
+        for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator i = poly->m_monos.begin(), e = poly->m_monos.end(); i != e; ++i) {
+            std::pair<Integer, ref<Monomial> > &tmp = *i;
+            monos.push_back(std::make_pair(m_constant * tmp.first, tmp.second));
+        }
+    }
+    normalize(monos);
+    return intern(res);
+}
+
+ref<Polynomial> Polynomial::instantiate(std::map<Symbol, ref<Polynomial> > *bindings)
+{
+    Integer newConstant = m_constant;
+    std::vector<std::pair<Integer, ref<Monomial> > > newMonos;
+    newMonos.reserve(m_monos.size());
+    bool changed = false;
+    for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
+        std::pair<Integer, ref<Monomial> > &tmp = *i;
+        // the instantiated monomial, or null if no variable is bound
+        ref<Polynomial> accu;
+        if (tmp.second->isUnivariateLinear()) {
+            std::map<Symbol, ref<Polynomial> >::iterator found = bindings->find(tmp.second->getFirst());
             if (found != bindings->end()) {
-                xnew = found->second;
+                accu = found->second;
+            }
+        } else {
+            bool isBound = false;
+            ref<Polynomial> prod = Polynomial::one;
+            for (std::vector<std::pair<Symbol, unsigned int> >::iterator pi = tmp.second->m_powers.begin(), pe = tmp.second->m_powers.end(); pi != pe; ++pi) {
+                ref<Polynomial> xnew;
+                std::map<Symbol, ref<Polynomial> >::iterator found = bindings->find(pi->first);
+                if (found != bindings->end()) {
+                    xnew = found->second;
+                    isBound = true;
+                } else {
+                    xnew = create(pi->first);
+                }
+                for (unsigned int c = 0; c < pi->second; ++c) {
+                    prod = prod->mult(xnew);
+                }
+            }
+            if (isBound) {
+                accu = prod;
             }
-            accu = accu->mult(xnew);
         }
-        res = res->add(accu->constMult(tmp.first.get_mpz_t()));
+        if (accu.isNull()) {
+            newMonos.push_back(tmp);
+            continue;
+        }
+        changed = true;
+        for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator ai = accu->m_monos.begin(), ae = accu->m_monos.end(); ai != ae; ++ai) {
+            newMonos.push_back(std::make_pair(tmp.first * ai->first, ai->second));
+        }
+        newConstant += tmp.first * accu->m_constant;
     }
-    return res;
+    if (!changed) {
+        return this;
+    }
+    normalize(newMonos);
+    Polynomial *res = new Polynomial(newConstant);
+    res->m_monos.swap(newMonos);
+    return intern(res);
 }
 
-void Polynomial::addVariablesToSet(std::set<std::string> &res)
+void Polynomial::addVariablesToSet(std::set<Symbol> &res)
 {
-    for (std::list<std::pair<mpz_class, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
-        std::pair<mpz_class, ref<Monomial> > &tmp = *i;
+    for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
+        std::pair<Integer, ref<Monomial> > &tmp = *i;
         tmp.second->addVariablesToSet(res);
     }
 }
 
+void Polynomial::addLinearCoefficientsToMap(std::map<Symbol, mpz_class> &res)
+{
+    for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
+        std::pair<Integer, ref<Monomial> > &tmp = *i;
+        res[tmp.second->getFirst()] += tmp.first.toMpz();
+    }
+}
+
 long int Polynomial::normStepsNeeded()
 {
     if (isConst() || isVar()) {
         return 0;
     }
     long int res = 0;
-    for (std::list<std::pair<mpz_class, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
-        std::pair<mpz_class, ref<Monomial> > &tmp = *i;
+    for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(); i != e; ++i) {
+        std::pair<Integer, ref<Monomial> > &tmp = *i;
         if (!tmp.second->isUnivariateLinear()) {
             // multiplication...
             return -1;
         }
-        if (mpz_cmp(tmp.first.get_mpz_t(), Polynomial::_null) >= 0) {
-            if (mpz_fits_sint_p(tmp.first.get_mpz_t())) {
-                res += mpz_get_si(tmp.first.get_mpz_t());
-            } else {
-                // too big...
-                return -1;
-            }
+        if (!tmp.first.isSmall() || tmp.first.getSmall() > INT_MAX || tmp.first.getSmall() < INT_MIN) {
+            // too big...
+            return -1;
+        }
+        if (tmp.first.sgn() >= 0) {
+            res += tmp.first.getSmall();
         } else {
-            if (mpz_fits_sint_p(tmp.first.get_mpz_t())) {
-                res -= mpz_get_si(tmp.first.get_mpz_t());
-                // negative numbers need one step more due to non-symmetric range
-                ++res;
-            } else {
-                // too big...
-                return -1;
-            }
+            res -= tmp.first.getSmall();
+            // negative numbers need one step more due to non-symmetric range
+            ++res;
         }
     }
-    if (mpz_cmp(m_constant, Polynomial::_null) != 0) {
+    if (m_constant.sgn() != 0) {
         ++res;
     }
     return res - 1;
@@ -619,10 +698,18 @@ long int Polynomial::normStepsNeeded()
 
 bool Polynomial::equals(ref<Polynomial> p)
 {
-    ref<Polynomial> tmp = sub(p);
-    bool res = false;
-    if (tmp->isConst()) {
-        res = (mpz_cmp(tmp->m_constant, Polynomial::_null) == 0);
+    return this == p.get();
+}
+
+bool Polynomial::equalsStructurally(Polynomial *p)
+{
+    if (m_constant != p->m_constant || m_monos.size() != p->m_monos.size()) {
+        return false;
     }
-    return res;
+    for (std::vector<std::pair<Integer, ref<Monomial> > >::iterator i = m_monos.begin(), e = m_monos.end(), pi = p->m_monos.begin(); i != e; ++i, ++pi) {
+        if (i->first != pi->first || !i->second->equals(pi->second)) {
+            return false;
+        }
+    }
+    return true;
 }
@@ -7,6 +7,7 @@
 
 #include "llvm2kittel/IntTRS/Rule.h"
 #include "llvm2kittel/IntTRS/Constraint.h"
+#include "llvm2kittel/IntTRS/HashCons.h"
 #include "llvm2kittel/IntTRS/Term.h"
 
 // C++ includes
@@ -61,14 +62,14 @@ ref<Constraint> Rule::getConstraint()
     return m_c;
 }
 
-void Rule::addVariablesToSet(std::set<std::string> &res)
+void Rule::addVariablesToSet(std::set<Symbol> &res)
 {
     m_lhs->addVariablesToSet(res);
     m_rhs->addVariablesToSet(res);
     m_c->addVariablesToSet(res);
 }
 
-ref<Rule> Rule::dropArgs(std::set<unsigned int> drop)
+ref<Rule> Rule::dropArgs(const std::set<unsigned int> &drop)
 {
     return create(m_lhs->dropArgs(drop), m_rhs->dropArgs(drop), m_c);
 }
@@ -78,7 +79,12 @@ bool Rule::equals(ref<Rule> rule)
     return (m_lhs->equals(rule->m_lhs) && m_rhs->equals(rule->m_rhs) && m_c->equals(rule->m_c));
 }
 
-ref<Rule> Rule::instantiate(std::map<std::string, ref<Polynomial> > *subst)
+unsigned long Rule::getHash()
+{
+    return hashCombine(hashCombine(m_lhs->getHash(), m_rhs->getHash()), m_c->getHash());
+}
+
+ref<Rule> Rule::instantiate(std::map<Symbol, ref<Polynomial> > *subst)
 {
   return create(m_lhs->instantiate(subst), m_rhs->instantiate(subst), m_c->instantiate(subst));
 }
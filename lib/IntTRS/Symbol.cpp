@@ -0,0 +1,86 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#include "llvm2kittel/IntTRS/Symbol.h"
+#include "llvm2kittel/Util/Mutex.h"
+
+// C++ includes
+#include <map>
+
+namespace {
+
+// The names are the keys of m_index, whose nodes are never moved, so symbols
+// can point into them.
+struct SymbolTable
+{
+    std::map<std::string, unsigned int> m_index;
+    const std::string *m_empty;
+    NodeMutex m_mutex;
+
+    SymbolTable()
+      : m_index(),
+        m_empty(NULL),
+        m_mutex()
+    {
+        // index 0 is the empty name, used by default-constructed symbols
+        lookup("", m_empty);
+    }
+
+    unsigned int lookup(const std::string &name, const std::string *&res)
+    {
+        ScopedLock<NodeMutex> lock(m_mutex);
+        std::map<std::string, unsigned int>::iterator found = m_index.find(name);
+        if (found == m_index.end()) {
+            found = m_index.insert(std::make_pair(name, static_cast<unsigned int>(m_index.size()))).first;
+        }
+        res = &found->first;
+        return found->second;
+    }
+
+private:
+    SymbolTable(const SymbolTable &);
+    SymbolTable &operator=(const SymbolTable &);
+};
+
+// constructed on first use so that symbols can be created during static
+// initialization
+SymbolTable &getTable()
+{
+    static SymbolTable table;
+    return table;
+}
+
+} // namespace
+
+Symbol::Symbol()
+  : m_id(0),
+    m_name(getTable().m_empty)
+{}
+
+Symbol::Symbol(const std::string &name)
+  : m_id(0),
+    m_name(NULL)
+{
+    m_id = getTable().lookup(name, m_name);
+}
+
+const std::string &Symbol::getName() const
+{
+    return *m_name;
+}
+
+unsigned int Symbol::getId() const
+{
+    return m_id;
+}
+
+void addNamesToSet(const std::set<Symbol> &symbols, std::set<std::string> &res)
+{
+    for (std::set<Symbol>::const_iterator i = symbols.begin(), e = symbols.end(); i != e; ++i) {
+        res.insert(i->getName());
+    }
+}
@@ -11,26 +11,63 @@
 // C++ includes
 #include <sstream>
 
-Term::Term(std::string f, std::list<ref<Polynomial> > args)
+Term::Term(Symbol f, const std::vector<ref<Polynomial> > &args)
   : refCount(0),
     m_f(f),
     m_args(args),
-    m_vars()
-{}
+    m_vars(),
+    m_varsReady(false),
+    m_hash(f.getId())
+{
+    for (std::vector<ref<Polynomial> >::iterator i = m_args.begin(), e = m_args.end(); i != e; ++i) {
+        m_hash = hashCombine(m_hash, (*i)->getHash());
+    }
+}
+
+ref<Term> Term::create(Symbol f, const std::vector<ref<Polynomial> > &args)
+{
+    return getTable().intern(new Term(f, args));
+}
+
+ref<Term> Term::create(const std::string &f, const std::vector<ref<Polynomial> > &args)
+{
+    return getTable().intern(new Term(Symbol(f), args));
+}
 
-ref<Term> Term::create(std::string f, std::list<ref<Polynomial> > args)
+ref<Term> Term::create(Symbol f, const std::list<ref<Polynomial> > &args)
 {
-    return new Term(f, args);
+    return getTable().intern(new Term(f, std::vector<ref<Polynomial> >(args.begin(), args.end())));
+}
+
+ref<Term> Term::create(const std::string &f, const std::list<ref<Polynomial> > &args)
+{
+    return getTable().intern(new Term(Symbol(f), std::vector<ref<Polynomial> >(args.begin(), args.end())));
 }
 
 Term::~Term()
-{}
+{
+    getTable().remove(this);
+}
+
+HashConsTable<Term> &Term::getTable()
+{
+    static HashConsTable<Term> *table = new HashConsTable<Term>();
+    return *table;
+}
+
+#ifdef LLVM2KITTEL_ATOMIC_REFCOUNT
+Mutex &Term::getVarsMutex()
+{
+    static Mutex *mutex = new Mutex();
+    return *mutex;
+}
+#endif
 
 std::string Term::toString()
 {
     std::ostringstream res;
-    res << m_f << '(';
-    for (std::list<ref<Polynomial> >::iterator i = m_args.begin(), e = m_args.end(); i != e; ) {
+    res << m_f.getName() << '(';
+    for (std::vector<ref<Polynomial> >::iterator i = m_args.begin(), e = m_args.end(); i != e; ) {
         ref<Polynomial> tmp = *i;
         res << tmp->toString();
         if (++i != e) {
@@ -41,80 +78,107 @@ std::string Term::toString()
     return res.str();
 }
 
-std::string Term::getFunctionSymbol()
+Symbol Term::getFunctionSymbol()
 {
     return m_f;
 }
 
-std::list<ref<Polynomial> > Term::getArgs()
+const std::vector<ref<Polynomial> > &Term::getArgs()
 {
     return m_args;
 }
 
+unsigned int Term::getArity()
+{
+    return static_cast<unsigned int>(m_args.size());
+}
+
 ref<Polynomial> Term::getArg(unsigned int i)
 {
-    unsigned int c = 0;
-    for (std::list<ref<Polynomial> >::iterator it = m_args.begin(), et = m_args.end(); it != et; ++it) {
-        if (c == i) {
-            return *it;
-        }
-        ++c;
+    if (i >= m_args.size()) {
+        return ref<Polynomial>();
     }
-    return ref<Polynomial>();
+    return m_args[i];
 }
 
-ref<Term> Term::instantiate(std::map<std::string, ref<Polynomial> > *bindings)
+ref<Term> Term::instantiate(std::map<Symbol, ref<Polynomial> > *bindings)
 {
-    std::list<ref<Polynomial> > newargs;
-    for (std::list<ref<Polynomial> >::iterator i = m_args.begin(), e = m_args.end(); i != e; ++i) {
+    std::vector<ref<Polynomial> > newargs;
+    newargs.reserve(m_args.size());
+    for (std::vector<ref<Polynomial> >::iterator i = m_args.begin(), e = m_args.end(); i != e; ++i) {
         ref<Polynomial> pol = *i;
         newargs.push_back(pol->instantiate(bindings));
     }
     return create(m_f, newargs);
 }
 
-void Term::addVariablesToSet(std::set<std::string> &res)
+void Term::addVariablesToSet(std::set<Symbol> &res)
 {
     setupVars();
-    for (std::vector<std::set<std::string> >::iterator i = m_vars.begin(), e = m_vars.end(); i != e; ++i) {
+    for (std::vector<std::set<Symbol> >::iterator i = m_vars.begin(), e = m_vars.end(); i != e; ++i) {
         res.insert(i->begin(), i->end());
     }
 }
 
-void Term::addVariablesToSet(unsigned int argpos, std::set<std::string> &res)
+void Term::addVariablesToSet(unsigned int argpos, std::set<Symbol> &res)
 {
     setupVars();
-    std::set<std::string> &tmp = m_vars[argpos];
+    std::set<Symbol> &tmp = m_vars[argpos];
     res.insert(tmp.begin(), tmp.end());
 }
 
 void Term::setupVars(void)
 {
-    if (m_args.size() != m_vars.size()) {
-        m_vars.clear();
-        for (std::list<ref<Polynomial> >::iterator i = m_args.begin(), e = m_args.end(); i != e; ++i) {
-            ref<Polynomial> tmp = *i;
-            std::set<std::string> vars;
-            tmp->addVariablesToSet(vars);
-            m_vars.push_back(vars);
-        }
+#ifdef LLVM2KITTEL_ATOMIC_REFCOUNT
+    // interned terms are shared between threads, so the variables are
+    // collected once under a lock and published with release semantics
+    if (__atomic_load_n(&m_varsReady, __ATOMIC_ACQUIRE)) {
+        return;
     }
+    ScopedLock<Mutex> lock(getVarsMutex());
+#endif
+    if (m_varsReady) {
+        return;
+    }
+    m_vars.reserve(m_args.size());
+    for (std::vector<ref<Polynomial> >::iterator i = m_args.begin(), e = m_args.end(); i != e; ++i) {
+        m_vars.push_back(std::set<Symbol>());
+        (*i)->addVariablesToSet(m_vars.back());
+    }
+#ifdef LLVM2KITTEL_ATOMIC_REFCOUNT
+    __atomic_store_n(&m_varsReady, true, __ATOMIC_RELEASE);
+#else
+    m_varsReady = true;
+#endif
 }
 
-ref<Term> Term::dropArgs(std::set<unsigned int> drop)
+ref<Term> Term::dropArgs(const std::set<unsigned int> &drop)
 {
-    std::list<ref<Polynomial> > newargs;
-    unsigned int argc = 0;
-    for (std::list<ref<Polynomial> >::iterator i = m_args.begin(), e = m_args.end(); i != e; ++i, ++argc) {
-        if (drop.find(argc) == drop.end()) {
-            ref<Polynomial> pol = *i;
-            newargs.push_back(pol);
+    std::vector<ref<Polynomial> > newargs;
+    newargs.reserve(m_args.size());
+    // drop is sorted, so walk it alongside the arguments
+    std::set<unsigned int>::const_iterator d = drop.begin(), de = drop.end();
+    for (unsigned int argc = 0; argc < m_args.size(); ++argc) {
+        if (d != de && *d == argc) {
+            ++d;
+        } else {
+            newargs.push_back(m_args[argc]);
         }
     }
     return create(m_f, newargs);
 }
 
 bool Term::equals(ref<Term> term)
+{
+    return this == term.get();
+}
+
+unsigned long Term::getHash()
+{
+    return m_hash;
+}
+
+bool Term::equalsStructurally(Term *term)
 {
     if (m_f != term->m_f) {
         return false;
@@ -124,7 +188,7 @@ bool Term::equals(ref<Term> term)
         return false;
     }
 
-    for (std::list<ref<Polynomial> >::iterator i = m_args.begin(), e = m_args.end(), ti = term->m_args.begin(); i != e; ++i, ++ti) {
+    for (std::vector<ref<Polynomial> >::iterator i = m_args.begin(), e = m_args.end(), ti = term->m_args.begin(); i != e; ++i, ++ti) {
         if (!(*i)->equals(*ti)) {
             return false;
         }
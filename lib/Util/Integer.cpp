@@ -0,0 +1,136 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#include "llvm2kittel/Util/Integer.h"
+
+// C++ includes
+#include <climits>
+#include <sstream>
+
+Integer::Integer(mpz_srcptr value)
+  : m_small(0),
+    m_big(NULL)
+{
+    if (mpz_fits_slong_p(value)) {
+        m_small = mpz_get_si(value);
+    } else {
+        m_big = new mpz_class(value);
+    }
+}
+
+Integer &Integer::operator=(const Integer &other)
+{
+    if (this != &other) {
+        mpz_class *big = (other.m_big == NULL) ? NULL : new mpz_class(*other.m_big);
+        delete m_big;
+        m_small = other.m_small;
+        m_big = big;
+    }
+    return *this;
+}
+
+Integer Integer::fromUnsigned(unsigned long value)
+{
+    if (value <= static_cast<unsigned long>(LONG_MAX)) {
+        return Integer(static_cast<long>(value));
+    }
+    return fromMpz(mpz_class(value));
+}
+
+Integer Integer::powerOfTwo(unsigned int power)
+{
+    if (power < sizeof(long) * CHAR_BIT - 1) {
+        return Integer(1L << power);
+    }
+    mpz_class res;
+    mpz_setbit(res.get_mpz_t(), power);
+    return fromMpz(res);
+}
+
+Integer Integer::fromMpz(const mpz_class &value)
+{
+    return Integer(value.get_mpz_t());
+}
+
+void Integer::get(mpz_t res) const
+{
+    if (m_big == NULL) {
+        mpz_set_si(res, m_small);
+    } else {
+        mpz_set(res, m_big->get_mpz_t());
+    }
+}
+
+mpz_class Integer::toMpz() const
+{
+    if (m_big == NULL) {
+        return mpz_class(m_small);
+    }
+    return *m_big;
+}
+
+std::string Integer::toString() const
+{
+    std::ostringstream sstr;
+    sstr << *this;
+    return sstr.str();
+}
+
+unsigned long Integer::getHash() const
+{
+    if (m_big == NULL) {
+        return static_cast<unsigned long>(m_small);
+    }
+    mpz_srcptr value = m_big->get_mpz_t();
+    unsigned long res = static_cast<unsigned long>(mpz_sgn(value));
+    for (size_t i = 0, e = mpz_size(value); i < e; ++i) {
+        res = res * 31 + static_cast<unsigned long>(mpz_getlimbn(value, static_cast<mp_size_t>(i)));
+    }
+    return res;
+}
+
+int Integer::compareSlow(const Integer &other) const
+{
+    // a big integer never fits in a long, so its sign decides
+    if (m_big == NULL) {
+        return -mpz_sgn(other.m_big->get_mpz_t());
+    } else if (other.m_big == NULL) {
+        return mpz_sgn(m_big->get_mpz_t());
+    }
+    int res = mpz_cmp(m_big->get_mpz_t(), other.m_big->get_mpz_t());
+    return (res > 0) - (res < 0);
+}
+
+Integer Integer::negSlow() const
+{
+    return fromMpz(-toMpz());
+}
+
+Integer Integer::addSlow(const Integer &other) const
+{
+    return fromMpz(toMpz() + other.toMpz());
+}
+
+Integer Integer::subSlow(const Integer &other) const
+{
+    return fromMpz(toMpz() - other.toMpz());
+}
+
+Integer Integer::mulSlow(const Integer &other) const
+{
+    return fromMpz(toMpz() * other.toMpz());
+}
+
+std::ostream &operator<<(std::ostream &os, const Integer &i)
+{
+    if (i.isSmall()) {
+        os << i.getSmall();
+    } else {
+        os << i.toMpz();
+    }
+    return os;
+}
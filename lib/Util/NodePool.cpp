@@ -0,0 +1,199 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#include "llvm2kittel/Util/NodePool.h"
+#include "llvm2kittel/Util/Mutex.h"
+
+// C++ includes
+#include <cstdlib>
+#include <new>
+
+// C includes
+#include <stdint.h>
+
+namespace
+{
+
+const size_t SlabSize = 64 * 1024;
+const size_t Granularity = 16;
+const size_t MaxSize = 256;
+const size_t NumClasses = MaxSize / Granularity;
+
+struct FreeChunk
+{
+    FreeChunk *next;
+};
+
+// Header at the start of every slab; slabs are aligned to SlabSize, so the
+// header of a chunk is found by masking its address
+struct Slab
+{
+    Slab *prev;
+    Slab *next;
+    FreeChunk *free;
+    char *bump;
+    char *end;
+    size_t chunkSize;
+    size_t live;
+    size_t sizeClass;
+    bool available;
+};
+
+const size_t HeaderSize = ((sizeof(Slab) + Granularity - 1) / Granularity) * Granularity;
+
+// slabs with at least one free chunk, per size class
+Slab *available[NumClasses];
+size_t slabCount = 0;
+unsigned int regionDepth = 0;
+
+// constructed on first use and never destroyed, as nodes are also allocated
+// during static initialization and released during static destruction
+NodeMutex &getMutex()
+{
+    static NodeMutex *mutex = new NodeMutex();
+    return *mutex;
+}
+
+void link(Slab *slab)
+{
+    Slab *&head = available[slab->sizeClass];
+    slab->prev = NULL;
+    slab->next = head;
+    if (head != NULL) {
+        head->prev = slab;
+    }
+    head = slab;
+    slab->available = true;
+}
+
+void unlink(Slab *slab)
+{
+    if (slab->prev != NULL) {
+        slab->prev->next = slab->next;
+    } else {
+        available[slab->sizeClass] = slab->next;
+    }
+    if (slab->next != NULL) {
+        slab->next->prev = slab->prev;
+    }
+    slab->prev = NULL;
+    slab->next = NULL;
+    slab->available = false;
+}
+
+Slab *newSlab(size_t sizeClass)
+{
+    void *mem = NULL;
+    if (posix_memalign(&mem, SlabSize, SlabSize) != 0) {
+        throw std::bad_alloc();
+    }
+    Slab *slab = static_cast<Slab*>(mem);
+    slab->prev = NULL;
+    slab->next = NULL;
+    slab->free = NULL;
+    slab->bump = static_cast<char*>(mem) + HeaderSize;
+    slab->end = static_cast<char*>(mem) + SlabSize;
+    slab->chunkSize = (sizeClass + 1) * Granularity;
+    slab->live = 0;
+    slab->sizeClass = sizeClass;
+    link(slab);
+    ++slabCount;
+    return slab;
+}
+
+bool isFull(Slab *slab)
+{
+    return slab->free == NULL && static_cast<size_t>(slab->end - slab->bump) < slab->chunkSize;
+}
+
+Slab *slabOf(void *p)
+{
+    return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(p) & ~static_cast<uintptr_t>(SlabSize - 1));
+}
+
+}
+
+void *NodePool::allocate(size_t size)
+{
+    if (size == 0 || size > MaxSize) {
+        return ::operator new(size);
+    }
+    ScopedLock<NodeMutex> lock(getMutex());
+    size_t sizeClass = (size - 1) / Granularity;
+    Slab *slab = available[sizeClass];
+    if (slab == NULL) {
+        slab = newSlab(sizeClass);
+    }
+    void *res;
+    if (slab->free != NULL) {
+        res = slab->free;
+        slab->free = slab->free->next;
+    } else {
+        res = slab->bump;
+        slab->bump += slab->chunkSize;
+    }
+    ++slab->live;
+    if (isFull(slab)) {
+        unlink(slab);
+    }
+    return res;
+}
+
+void NodePool::deallocate(void *p, size_t size)
+{
+    if (p == NULL) {
+        return;
+    }
+    if (size == 0 || size > MaxSize) {
+        ::operator delete(p);
+        return;
+    }
+    ScopedLock<NodeMutex> lock(getMutex());
+    Slab *slab = slabOf(p);
+    FreeChunk *chunk = static_cast<FreeChunk*>(p);
+    chunk->next = slab->free;
+    slab->free = chunk;
+    --slab->live;
+    if (!slab->available) {
+        link(slab);
+    }
+}
+
+void NodePool::trim()
+{
+    ScopedLock<NodeMutex> lock(getMutex());
+    for (size_t c = 0; c < NumClasses; ++c) {
+        Slab *slab = available[c];
+        while (slab != NULL) {
+            Slab *next = slab->next;
+            if (slab->live == 0) {
+                unlink(slab);
+                free(slab);
+                --slabCount;
+            }
+            slab = next;
+        }
+    }
+}
+
+size_t NodePool::getSlabCount()
+{
+    ScopedLock<NodeMutex> lock(getMutex());
+    return slabCount;
+}
+
+NodeRegion::NodeRegion()
+{
+    ++regionDepth;
+}
+
+NodeRegion::~NodeRegion()
+{
+    if (--regionDepth == 0) {
+        NodePool::trim();
+    }
+}
@@ -0,0 +1,172 @@
+// This file is part of llvm2KITTeL
+//
+// Copyright 2014 Jeroen Ketema
+//
+// Licensed under the University of Illinois/NCSA Open Source License.
+// See LICENSE for details.
+
+#include "llvm2kittel/Util/TaskPool.h"
+#include "llvm2kittel/Util/Mutex.h"
+
+// C/C++ includes
+#include <cstdlib>
+#include <iostream>
+#include <pthread.h>
+
+TaskPool::TaskPool()
+  : m_ranges(),
+    m_threads(),
+    m_mutex(new Mutex()),
+    m_started(new Condition()),
+    m_finished(new Condition()),
+    m_run(0),
+    m_workers(0),
+    m_busy(0),
+    m_stop(false)
+{}
+
+TaskPool::~TaskPool()
+{
+    {
+        ScopedLock<Mutex> lock(*m_mutex);
+        m_stop = true;
+        m_started->broadcast();
+    }
+    for (std::vector<Thread*>::iterator i = m_threads.begin(), e = m_threads.end(); i != e; ++i) {
+        pthread_join((*i)->thread, NULL);
+        delete *i;
+    }
+    delete m_finished;
+    delete m_started;
+    delete m_mutex;
+}
+
+bool TaskPool::nextTask(unsigned int worker, unsigned int &index)
+{
+    Range &own = m_ranges[worker];
+    {
+        ScopedLock<Mutex> lock(*own.mutex);
+        if (own.begin < own.end) {
+            index = own.begin++;
+            return true;
+        }
+    }
+
+    // only one lock is held at a time; the stolen tasks are in neither range
+    // until they are added to ours, but then they are ours to run anyway
+    unsigned int numWorkers = static_cast<unsigned int>(m_ranges.size());
+    for (unsigned int i = 1; i < numWorkers; ++i) {
+        Range &victim = m_ranges[(worker + i) % numWorkers];
+        unsigned int begin;
+        unsigned int end;
+        {
+            ScopedLock<Mutex> lock(*victim.mutex);
+            if (victim.begin == victim.end) {
+                continue;
+            }
+            end = victim.end;
+            begin = victim.begin + (victim.end - victim.begin) / 2;
+            victim.end = begin;
+        }
+        ScopedLock<Mutex> lock(*own.mutex);
+        index = begin;
+        own.begin = begin + 1;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
+
+void TaskPool::runTasks(unsigned int worker)
+{
+    unsigned int index;
+    while (nextTask(worker, index)) {
+        runTask(index, worker);
+    }
+}
+
+// the loop of the threads, which take part in the runs after seen that have
+// enough workers
+void TaskPool::serve(unsigned int worker, unsigned long seen)
+{
+    ScopedLock<Mutex> lock(*m_mutex);
+    for (;;) {
+        while (!m_stop && m_run == seen) {
+            m_started->wait(*m_mutex);
+        }
+        if (m_stop) {
+            return;
+        }
+        seen = m_run;
+        if (worker >= m_workers) {
+            continue;
+        }
+        m_mutex->unlock();
+        runTasks(worker);
+        m_mutex->lock();
+        if (--m_busy == 0) {
+            m_finished->broadcast();
+        }
+    }
+}
+
+void *TaskPool::runThread(void *arg)
+{
+    Thread *thread = static_cast<Thread*>(arg);
+    thread->pool->serve(thread->worker, thread->run);
+    return NULL;
+}
+
+void TaskPool::run(unsigned int size, unsigned int workers)
+{
+    unsigned int numWorkers = (workers == 0) ? 1 : workers;
+    if (size < numWorkers) {
+        numWorkers = (size == 0) ? 1 : size;
+    }
+    if (numWorkers == 1) {
+        for (unsigned int i = 0; i < size; ++i) {
+            runTask(i, 0);
+        }
+        return;
+    }
+
+    m_ranges.assign(numWorkers, Range());
+    for (unsigned int w = 0; w < numWorkers; ++w) {
+        m_ranges[w].mutex = new Mutex();
+        m_ranges[w].begin = static_cast<unsigned int>((static_cast<unsigned long>(size) * w) / numWorkers);
+        m_ranges[w].end = static_cast<unsigned int>((static_cast<unsigned long>(size) * (w + 1)) / numWorkers);
+    }
+
+    {
+        ScopedLock<Mutex> lock(*m_mutex);
+        // the threads are started before the run is announced, so that they
+        // take part in it
+        while (m_threads.size() + 1 < numWorkers) {
+            Thread *thread = new Thread();
+            thread->pool = this;
+            thread->worker = static_cast<unsigned int>(m_threads.size()) + 1;
+            thread->run = m_run;
+            if (pthread_create(&thread->thread, NULL, runThread, thread) != 0) {
+                std::cerr << "Could not start worker thread (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+                exit(277);
+            }
+            m_threads.push_back(thread);
+        }
+        m_workers = numWorkers;
+        m_busy = numWorkers - 1;
+        ++m_run;
+        m_started->broadcast();
+    }
+    runTasks(0);
+    {
+        ScopedLock<Mutex> lock(*m_mutex);
+        while (m_busy != 0) {
+            m_finished->wait(*m_mutex);
+        }
+    }
+
+    for (std::vector<Range>::iterator i = m_ranges.begin(), e = m_ranges.end(); i != e; ++i) {
+        delete i->mutex;
+    }
+    m_ranges.clear();
+}
@@ -11,7 +11,9 @@
 #include "llvm2kittel/Converter.h"
 #include "llvm2kittel/DivRemConstraintType.h"
 #include "llvm2kittel/Kittelizer.h"
+#include "llvm2kittel/QueryCache.h"
 #include "llvm2kittel/Slicer.h"
+#include "llvm2kittel/SolverLimits.h"
 #include "llvm2kittel/Analysis/ConditionPropagator.h"
 #include "llvm2kittel/Analysis/HierarchyBuilder.h"
 #include "llvm2kittel/Analysis/InstChecker.h"
@@ -34,6 +36,8 @@
 #include "llvm2kittel/Transform/NondefFactory.h"
 #include "llvm2kittel/Transform/StrengthIncreaser.h"
 #include "llvm2kittel/Util/CommandLine.h"
+#include "llvm2kittel/Util/NodePool.h"
+#include "llvm2kittel/Util/TaskPool.h"
 #include "llvm2kittel/Util/Version.h"
 
 // llvm includes
@@ -89,6 +93,10 @@
 #include <iostream>
 #include <sstream>
 #include <cstdlib>
+#include <vector>
+
+// C includes
+#include <unistd.h>
 
 // command line stuff
 
@@ -138,9 +146,27 @@ static cl::opt<SMTSolver> smtSolver("smt-solver",
                                                clEnumValN(MathSAT5Solver, "mathsat5", "use MathSAT5"),
                                                clEnumValN(Yices2Solver, "yices2", "use Yices2"),
                                                clEnumValN(Z3Solver, "z3", "use Z3"),
+                                               clEnumValN(BuiltinSolver, "builtin", "only use the built-in linear arithmetic checker"),
                                                clEnumValN(NoSolver, "none", "do not eliminate unsatisfiable contraints"),
                                                clEnumValEnd)
                                     );
+static cl::opt<bool> smtPerQuery("smt-per-query", cl::desc("Start a new SMT solver process for every query instead of keeping one solver session"), cl::init(false));
+static cl::opt<unsigned int> smtWorkers("smt-workers", cl::desc("Number of SMT solver processes that decide queries in parallel (0: one per core)"), cl::init(0));
+static cl::opt<unsigned int> smtTimeout("smt-timeout", cl::desc("Time limit for a single SMT query in milliseconds (0: no limit)"), cl::init(0));
+static cl::opt<unsigned int> smtSCCBudget("smt-scc-budget", cl::desc("Total time the SMT solver may take per SCC in milliseconds (0: no limit)"), cl::init(0));
+static cl::opt<unsigned int> smtBudget("smt-budget", cl::desc("Total time the SMT solver may take per run in milliseconds (0: no limit)"), cl::init(0));
+static cl::opt<TimeoutPolicy> smtTimeoutPolicy("smt-timeout-policy",
+                                               cl::desc("What to do with clauses whose SMT query timed out, was given up by the solver, or did not fit the budget"),
+                                               cl::init(KeepClause),
+                                               cl::values(
+                                                          clEnumValN(KeepClause, "keep", "keep the clause (default)"),
+                                                          clEnumValN(FallBackToChecker, "builtin", "decide the clause with the built-in linear arithmetic checker"),
+                                                          clEnumValEnd)
+                                               );
+static cl::opt<unsigned int> jobs("jobs", cl::desc("Number of functions that are converted in parallel, each with its own kittelize threads; the output is the same as with one job (0: one per core)"), cl::init(1));
+static cl::opt<unsigned int> kittelizeThreads("kittelize-threads", cl::desc("Number of threads that convert rules to DNF in parallel, each with its own SMT solver processes (0: one per core)"), cl::init(1));
+static cl::opt<unsigned int> dnfBudget("dnf-budget", cl::desc("Maximal number of rules a constraint is expanded into before it is split over intermediate locations (0: no limit)"), cl::init(1024));
+static cl::opt<std::string> smtCache("smt-cache", cl::desc("Directory in which SMT query results are cached across runs"), cl::init(std::string()));
 static cl::opt<bool> bitwiseConditions("bitwise-conditions", cl::desc("Add conditions for bitwise & and |"), cl::init(false));
 
 static cl::opt<bool> dumpLL("dump-ll", cl::desc("Dump transformed bitcode into a file"), cl::init(false));
@@ -394,6 +420,208 @@ std::string getSccName(std::list<llvm::Function*> scc)
     return sstream.str();
 }
 
+// Everything a function contributes to the output of its SCC
+struct ConvertedFunction
+{
+    std::list<ref<Rule> > rules;
+    std::list<ref<Rule> > condensedRules;
+    std::list<ref<Rule> > kittelizedRules;
+    std::list<ref<Rule> > slicedRules;
+    std::set<Symbol> complexityLHSs;
+};
+
+// Runs the conversion pipeline on single functions; only reads the module
+// and the analysis results, so several functions can be converted at once
+class FunctionConverter
+{
+public:
+    FunctionConverter(const llvm::Type *boolType, std::map<llvm::Function*, MayMustMap> &mmMap, std::map<llvm::Function*, std::set<llvm::GlobalVariable*> > &funcMayZap, std::map<llvm::Function*, TrueFalseMap> &tfMap, std::map<llvm::Function*, std::set<llvm::BasicBlock*> > &lebMap, std::map<llvm::Function*, ConditionMap> &elcMap)
+      : m_boolType(boolType),
+        m_mmMap(mmMap),
+        m_funcMayZap(funcMayZap),
+        m_tfMap(tfMap),
+        m_lebMap(lebMap),
+        m_elcMap(elcMap)
+    {}
+
+    void convert(llvm::Function *curr, std::set<llvm::Function*> &sccSet, const std::vector<EliminateClass*> &elims, ConvertedFunction &res)
+    {
+        Converter converter(m_boolType, assumeIsControl, selectIsControl, onlyMultiPredIsControl, boundedIntegers, unsignedEncoding, onlyLoopConditions, divisionConstraintType, bitwiseConditions, complexityTuples || uniformComplexityTuples);
+        std::map<llvm::Function*, MayMustMap>::iterator tmp1 = m_mmMap.find(curr);
+        if (tmp1 == m_mmMap.end()) {
+            std::cerr << "Could not find alias information (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
+            exit(9876);
+        }
+        MayMustMap curr_mmMap = tmp1->second;
+        std::map<llvm::Function*, TrueFalseMap>::iterator tmp2 = m_tfMap.find(curr);
+        TrueFalseMap curr_tfMap;
+        if (tmp2 != m_tfMap.end()) {
+            curr_tfMap = tmp2->second;
+        }
+        std::map<llvm::Function*, std::set<llvm::BasicBlock*> >::iterator tmp3 = m_lebMap.find(curr);
+        std::set<llvm::BasicBlock*> curr_leb;
+        if (tmp3 != m_lebMap.end()) {
+            curr_leb = tmp3->second;
+        }
+        std::map<llvm::Function*, ConditionMap>::iterator tmp4 = m_elcMap.find(curr);
+        ConditionMap curr_elcMap;
+        if (tmp4 != m_elcMap.end()) {
+            curr_elcMap = tmp4->second;
+        }
+        converter.phase1(curr, sccSet, curr_mmMap, m_funcMayZap, curr_tfMap, curr_leb, curr_elcMap);
+        converter.phase2(curr, sccSet, curr_mmMap, m_funcMayZap, curr_tfMap, curr_leb, curr_elcMap);
+        // the fresh locations of a function are numbered independently of
+        // the other functions, so that the order of conversion does not matter
+        unsigned int splitCount = 0;
+        std::list<ref<Rule> > condensedRules = converter.getCondensedRules();
+        std::list<ref<Rule> > kittelizedRules = kittelize(condensedRules, elims, dnfBudget, splitCount);
+        Slicer slicer(curr, converter.getPhiVariables());
+        std::list<ref<Rule> > slicedRules;
+        if (noSlicing) {
+            slicedRules = kittelizedRules;
+        } else {
+            slicedRules = slicer.sliceUsage(kittelizedRules);
+            slicedRules = slicer.sliceConstraint(slicedRules);
+            slicedRules = slicer.sliceDefined(slicedRules);
+            slicedRules = slicer.sliceStillUsed(slicedRules, conservativeSlicing);
+            slicedRules = slicer.sliceTrivialNondefConstraints(slicedRules);
+            slicedRules = slicer.sliceDuplicates(slicedRules);
+        }
+        if (boundedIntegers) {
+            slicedRules = kittelize(addBoundConstraints(slicedRules, converter.getBitwidthMap(), unsignedEncoding), elims, dnfBudget, splitCount);
+            slicedRules = removeImpliedBounds(slicedRules, converter.getBitwidthMap(), unsignedEncoding);
+        }
+        if (debug) {
+            // the uncondensed rules are only materialized for debugging
+            res.rules = converter.getRules();
+            res.condensedRules = condensedRules;
+            res.kittelizedRules = kittelizedRules;
+        }
+        if (simplifyConds) {
+            slicedRules = simplifyConstraints(slicedRules);
+        }
+        res.slicedRules = slicedRules;
+
+        if (complexityTuples || uniformComplexityTuples) {
+            res.complexityLHSs = converter.getComplexityLHSs();
+        }
+    }
+
+private:
+    const llvm::Type *m_boolType;
+    std::map<llvm::Function*, MayMustMap> &m_mmMap;
+    std::map<llvm::Function*, std::set<llvm::GlobalVariable*> > &m_funcMayZap;
+    std::map<llvm::Function*, TrueFalseMap> &m_tfMap;
+    std::map<llvm::Function*, std::set<llvm::BasicBlock*> > &m_lebMap;
+    std::map<llvm::Function*, ConditionMap> &m_elcMap;
+
+private:
+    FunctionConverter(const FunctionConverter &);
+    FunctionConverter &operator=(const FunctionConverter &);
+};
+
+// Converts the functions of all sccs at once, one task per function; every
+// worker has its own solver handles, which are bound to the limits of the
+// scc of the function at hand
+class ConvertTasks : public TaskPool
+{
+public:
+    ConvertTasks(FunctionConverter &converter, const std::vector<llvm::Function*> &functions, const std::vector<unsigned int> &sccOf, std::vector<std::set<llvm::Function*> > &sccSets, const std::vector<SolverLimits*> &sccLimits, const std::vector<std::vector<EliminateClass*> > &elims)
+      : m_converter(converter),
+        m_functions(functions),
+        m_sccOf(sccOf),
+        m_sccSets(sccSets),
+        m_sccLimits(sccLimits),
+        m_elims(elims),
+        m_results(functions.size())
+    {}
+
+    const ConvertedFunction &getResult(unsigned int index)
+    {
+        return m_results[index];
+    }
+
+protected:
+    virtual void runTask(unsigned int index, unsigned int worker)
+    {
+        const std::vector<EliminateClass*> &elims = m_elims[worker];
+        for (std::vector<EliminateClass*>::const_iterator i = elims.begin(), e = elims.end(); i != e; ++i) {
+            (*i)->setLimits(m_sccLimits[m_sccOf[index]]);
+        }
+        m_converter.convert(m_functions[index], m_sccSets[m_sccOf[index]], elims, m_results[index]);
+    }
+
+private:
+    FunctionConverter &m_converter;
+    const std::vector<llvm::Function*> &m_functions;
+    const std::vector<unsigned int> &m_sccOf;
+    std::vector<std::set<llvm::Function*> > &m_sccSets;
+    const std::vector<SolverLimits*> &m_sccLimits;
+    const std::vector<std::vector<EliminateClass*> > &m_elims;
+    std::vector<ConvertedFunction> m_results;
+};
+
+void printSccHeader(std::list<llvm::Function*> scc, unsigned int currNum, unsigned int num)
+{
+    if (debug) {
+        std::cout << "========================================" << std::endl;
+    }
+    if ((!complexityTuples && !uniformComplexityTuples) || debug) {
+        std::cout << "///*** " << getPartNumber(currNum, num) << '_' << getSccName(scc) << " ***///" << std::endl;
+    }
+}
+
+void printScc(std::list<llvm::Function*> scc, const std::vector<const ConvertedFunction*> &funcs)
+{
+    std::list<ref<Rule> > allRules;
+    std::list<ref<Rule> > allCondensedRules;
+    std::list<ref<Rule> > allKittelizedRules;
+    std::list<ref<Rule> > allSlicedRules;
+    std::set<Symbol> complexityLHSs;
+    for (std::vector<const ConvertedFunction*>::const_iterator fi = funcs.begin(), fe = funcs.end(); fi != fe; ++fi) {
+        const ConvertedFunction *func = *fi;
+        allRules.insert(allRules.end(), func->rules.begin(), func->rules.end());
+        allCondensedRules.insert(allCondensedRules.end(), func->condensedRules.begin(), func->condensedRules.end());
+        allKittelizedRules.insert(allKittelizedRules.end(), func->kittelizedRules.begin(), func->kittelizedRules.end());
+        allSlicedRules.insert(allSlicedRules.end(), func->slicedRules.begin(), func->slicedRules.end());
+        complexityLHSs.insert(func->complexityLHSs.begin(), func->complexityLHSs.end());
+    }
+    if (debug) {
+        std::cout << "========================================" << std::endl;
+        for (std::list<ref<Rule> >::iterator i = allRules.begin(), e = allRules.end(); i != e; ++i) {
+            ref<Rule> tmp = *i;
+            std::cout << tmp->toString() << std::endl;
+        }
+        std::cout << "========================================" << std::endl;
+        for (std::list<ref<Rule> >::iterator i = allCondensedRules.begin(), e = allCondensedRules.end(); i != e; ++i) {
+            ref<Rule> tmp = *i;
+            std::cout << tmp->toString() << std::endl;
+        }
+        std::cout << "========================================" << std::endl;
+        for (std::list<ref<Rule> >::iterator i = allKittelizedRules.begin(), e = allKittelizedRules.end(); i != e; ++i) {
+            ref<Rule> tmp = *i;
+            std::cout << tmp->toString() << std::endl;
+        }
+        std::cout << "========================================" << std::endl;
+    }
+    if (complexityTuples) {
+        printComplexityTuples(allSlicedRules, complexityLHSs, std::cout);
+    } else if (uniformComplexityTuples) {
+        std::ostringstream startfun;
+        startfun << "eval_" << getSccName(scc) << "_start";
+        std::string name = startfun.str();
+        printUniformComplexityTuples(allSlicedRules, complexityLHSs, name, std::cout);
+    } else if (t2output) {
+        std::string startFun = "eval_" + getSccName(scc) + "_start";
+        printT2System(allSlicedRules, startFun, std::cout);
+    } else {
+        for (std::list<ref<Rule> >::iterator i = allSlicedRules.begin(), e = allSlicedRules.end(); i != e; ++i) {
+            ref<Rule> tmp = *i;
+            std::cout << tmp->toKittelString() << std::endl;
+        }
+    }
+}
+
 int main(int argc, char *argv[])
 {
     cl::SetVersionPrinter(&versionPrinter);
@@ -415,6 +643,12 @@ int main(int argc, char *argv[])
         std::cerr << "Cannot use \"-inline\" in combination with \"-eager-inline\"" << std::endl;
         return 333;
     }
+#if defined(LLVM2KITTEL_Z3_API)
+    if (smtSolver == Z3Solver && smtPerQuery) {
+        std::cerr << "Cannot use \"-smt-per-query\" with \"-smt-solver=z3\" when Z3 is linked as a library" << std::endl;
+        return 333;
+    }
+#endif
 
 #if LLVM_VERSION < VERSION(3, 5)
     llvm::OwningPtr<llvm::MemoryBuffer> owningBuffer;
@@ -669,119 +903,104 @@ int main(int argc, char *argv[])
         funcMayZap.insert(std::make_pair(func, funcTransZap));
     }
 
+    // one solver session per thread serves all sccs
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int workers = smtWorkers;
+    if (workers == 0) {
+        workers = (cores > 0) ? static_cast<unsigned int>(cores) : 1;
+    }
+    unsigned int threads = kittelizeThreads;
+    if (threads == 0) {
+        threads = (cores > 0) ? static_cast<unsigned int>(cores) : 1;
+    }
+    unsigned int numJobs = jobs;
+    if (numJobs == 0) {
+        numJobs = (cores > 0) ? static_cast<unsigned int>(cores) : 1;
+    }
+#ifndef LLVM2KITTEL_ATOMIC_REFCOUNT
+    // rules can only be shared between threads with atomic reference counts
+    if (threads > 1 || numJobs > 1) {
+        std::cerr << "Warning: ignoring \"-jobs\" and \"-kittelize-threads\" as llvm2kittel was built without ATOMIC_REFCOUNT; converting sequentially" << std::endl;
+    }
+    threads = 1;
+    numJobs = 1;
+#endif
+    QueryCache queryCache(smtCache);
+    SolverLimits solverLimits(smtTimeout, smtSCCBudget, smtBudget, smtTimeoutPolicy);
+    std::vector<std::vector<EliminateClass*> > jobElims(numJobs);
+    for (unsigned int j = 0; j < numJobs; ++j) {
+        for (unsigned int t = 0; t < threads; ++t) {
+            EliminateClass *elim = eliminateClassFactory(smtSolver, !smtPerQuery, (workers + numJobs * threads - 1) / (numJobs * threads));
+            elim->setCache(&queryCache);
+            elim->setLimits(&solverLimits);
+            jobElims[j].push_back(elim);
+        }
+    }
+    std::vector<EliminateClass*> &elims = jobElims.front();
+    FunctionConverter functionConverter(boolType, mmMap, funcMayZap, tfMap, lebMap, elcMap);
+
     // convert sccs separately
     unsigned int num = static_cast<unsigned int>(dependsOnSccs.size());
     unsigned int currNum = 0;
-    for (std::list<std::list<llvm::Function*> >::iterator scci = dependsOnSccs.begin(), scce = dependsOnSccs.end(); scci != scce; ++scci) {
-        std::list<llvm::Function*> scc = *scci;
-        std::list<ref<Rule> > allRules;
-        std::list<ref<Rule> > allCondensedRules;
-        std::list<ref<Rule> > allKittelizedRules;
-        std::list<ref<Rule> > allSlicedRules;
-        if (debug) {
-            std::cout << "========================================" << std::endl;
-        }
-        if ((!complexityTuples && !uniformComplexityTuples) || debug) {
-            std::cout << "///*** " << getPartNumber(++currNum, num) << '_' << getSccName(scc) << " ***///" << std::endl;
-        }
-        std::set<llvm::Function*> sccSet;
-        sccSet.insert(scc.begin(), scc.end());
-
-        std::set<std::string> complexityLHSs;
-
-        for (std::list<llvm::Function*>::iterator fi = scc.begin(), fe = scc.end(); fi != fe; ++fi) {
-            llvm::Function *curr = *fi;
-            Converter converter(boolType, assumeIsControl, selectIsControl, onlyMultiPredIsControl, boundedIntegers, unsignedEncoding, onlyLoopConditions, divisionConstraintType, bitwiseConditions, complexityTuples || uniformComplexityTuples);
-            std::map<llvm::Function*, MayMustMap>::iterator tmp1 = mmMap.find(curr);
-            if (tmp1 == mmMap.end()) {
-                std::cerr << "Could not find alias information (" << __FILE__ << ":" << __LINE__ << ")!" << std::endl;
-                exit(9876);
-            }
-            MayMustMap curr_mmMap = tmp1->second;
-            std::map<llvm::Function*, TrueFalseMap>::iterator tmp2 = tfMap.find(curr);
-            TrueFalseMap curr_tfMap;
-            if (tmp2 != tfMap.end()) {
-                curr_tfMap = tmp2->second;
-            }
-            std::map<llvm::Function*, std::set<llvm::BasicBlock*> >::iterator tmp3 = lebMap.find(curr);
-            std::set<llvm::BasicBlock*> curr_leb;
-            if (tmp3 != lebMap.end()) {
-                curr_leb = tmp3->second;
-            }
-            std::map<llvm::Function*, ConditionMap>::iterator tmp4 = elcMap.find(curr);
-            ConditionMap curr_elcMap;
-            if (tmp4 != elcMap.end()) {
-                curr_elcMap = tmp4->second;
-            }
-            converter.phase1(curr, sccSet, curr_mmMap, funcMayZap, curr_tfMap, curr_leb, curr_elcMap);
-            converter.phase2(curr, sccSet, curr_mmMap, funcMayZap, curr_tfMap, curr_leb, curr_elcMap);
-            std::list<ref<Rule> > rules = converter.getRules();
-            std::list<ref<Rule> > condensedRules = converter.getCondensedRules();
-            std::list<ref<Rule> > kittelizedRules = kittelize(condensedRules, smtSolver);
-            Slicer slicer(curr, converter.getPhiVariables());
-            std::list<ref<Rule> > slicedRules;
-            if (noSlicing) {
-                slicedRules = kittelizedRules;
-            } else {
-                slicedRules = slicer.sliceUsage(kittelizedRules);
-                slicedRules = slicer.sliceConstraint(slicedRules);
-                slicedRules = slicer.sliceDefined(slicedRules);
-                slicedRules = slicer.sliceStillUsed(slicedRules, conservativeSlicing);
-                slicedRules = slicer.sliceTrivialNondefConstraints(slicedRules);
-                slicedRules = slicer.sliceDuplicates(slicedRules);
-            }
-            if (boundedIntegers) {
-                slicedRules = kittelize(addBoundConstraints(slicedRules, converter.getBitwidthMap(), unsignedEncoding), smtSolver);
-            }
-            if (debug) {
-                allRules.insert(allRules.end(), rules.begin(), rules.end());
-                allCondensedRules.insert(allCondensedRules.end(), condensedRules.begin(), condensedRules.end());
-                allKittelizedRules.insert(allKittelizedRules.end(), kittelizedRules.begin(), kittelizedRules.end());
-            }
-            if (simplifyConds) {
-                slicedRules = simplifyConstraints(slicedRules);
-            }
-            allSlicedRules.insert(allSlicedRules.end(), slicedRules.begin(), slicedRules.end());
-
-            if (complexityTuples || uniformComplexityTuples) {
-                std::set<std::string> tmpLHSs = converter.getComplexityLHSs();
-                complexityLHSs.insert(tmpLHSs.begin(), tmpLHSs.end());
+    if (numJobs == 1) {
+        for (std::list<std::list<llvm::Function*> >::iterator scci = dependsOnSccs.begin(), scce = dependsOnSccs.end(); scci != scce; ++scci) {
+            // nodes of this scc are released before the next one is converted
+            NodeRegion region;
+            solverLimits.startSCC();
+            std::list<llvm::Function*> scc = *scci;
+            printSccHeader(scc, ++currNum, num);
+            std::set<llvm::Function*> sccSet;
+            sccSet.insert(scc.begin(), scc.end());
+            std::vector<ConvertedFunction> converted(scc.size());
+            std::vector<const ConvertedFunction*> funcs;
+            unsigned int f = 0;
+            for (std::list<llvm::Function*>::iterator fi = scc.begin(), fe = scc.end(); fi != fe; ++fi, ++f) {
+                functionConverter.convert(*fi, sccSet, elims, converted[f]);
+                funcs.push_back(&converted[f]);
             }
+            printScc(scc, funcs);
         }
-        if (debug) {
-            std::cout << "========================================" << std::endl;
-            for (std::list<ref<Rule> >::iterator i = allRules.begin(), e = allRules.end(); i != e; ++i) {
-                ref<Rule> tmp = *i;
-                std::cout << tmp->toString() << std::endl;
-            }
-            std::cout << "========================================" << std::endl;
-            for (std::list<ref<Rule> >::iterator i = allCondensedRules.begin(), e = allCondensedRules.end(); i != e; ++i) {
-                ref<Rule> tmp = *i;
-                std::cout << tmp->toString() << std::endl;
-            }
-            std::cout << "========================================" << std::endl;
-            for (std::list<ref<Rule> >::iterator i = allKittelizedRules.begin(), e = allKittelizedRules.end(); i != e; ++i) {
-                ref<Rule> tmp = *i;
-                std::cout << tmp->toString() << std::endl;
+    } else {
+        // the functions of all sccs are converted before anything is printed;
+        // the output is then produced in the same order as above
+        NodeRegion region;
+        std::vector<std::set<llvm::Function*> > sccSets;
+        std::vector<SolverLimits*> sccLimits;
+        std::vector<llvm::Function*> functions;
+        std::vector<unsigned int> sccOf;
+        for (std::list<std::list<llvm::Function*> >::iterator scci = dependsOnSccs.begin(), scce = dependsOnSccs.end(); scci != scce; ++scci) {
+            unsigned int index = static_cast<unsigned int>(sccSets.size());
+            sccSets.push_back(std::set<llvm::Function*>(scci->begin(), scci->end()));
+            sccLimits.push_back(new SolverLimits(solverLimits));
+            for (std::list<llvm::Function*>::iterator fi = scci->begin(), fe = scci->end(); fi != fe; ++fi) {
+                functions.push_back(*fi);
+                sccOf.push_back(index);
             }
-            std::cout << "========================================" << std::endl;
-        }
-        if (complexityTuples) {
-            printComplexityTuples(allSlicedRules, complexityLHSs, std::cout);
-        } else if (uniformComplexityTuples) {
-            std::ostringstream startfun;
-            startfun << "eval_" << getSccName(scc) << "_start";
-            std::string name = startfun.str();
-            printUniformComplexityTuples(allSlicedRules, complexityLHSs, name, std::cout);
-        } else if (t2output) {
-            std::string startFun = "eval_" + getSccName(scc) + "_start";
-            printT2System(allSlicedRules, startFun, std::cout);
-        } else {
-            for (std::list<ref<Rule> >::iterator i = allSlicedRules.begin(), e = allSlicedRules.end(); i != e; ++i) {
-                ref<Rule> tmp = *i;
-                std::cout << tmp->toKittelString() << std::endl;
+        }
+        ConvertTasks tasks(functionConverter, functions, sccOf, sccSets, sccLimits, jobElims);
+        tasks.run(static_cast<unsigned int>(functions.size()), numJobs);
+        unsigned int index = 0;
+        for (std::list<std::list<llvm::Function*> >::iterator scci = dependsOnSccs.begin(), scce = dependsOnSccs.end(); scci != scce; ++scci) {
+            std::list<llvm::Function*> scc = *scci;
+            printSccHeader(scc, ++currNum, num);
+            std::vector<const ConvertedFunction*> funcs;
+            for (std::list<llvm::Function*>::iterator fi = scc.begin(), fe = scc.end(); fi != fe; ++fi) {
+                funcs.push_back(&tasks.getResult(index++));
             }
+            printScc(scc, funcs);
         }
+        for (std::vector<SolverLimits*>::iterator i = sccLimits.begin(), e = sccLimits.end(); i != e; ++i) {
+            delete *i;
+        }
+    }
+
+    for (std::vector<std::vector<EliminateClass*> >::iterator j = jobElims.begin(), je = jobElims.end(); j != je; ++j) {
+        for (std::vector<EliminateClass*>::iterator i = j->begin(), e = j->end(); i != e; ++i) {
+            delete *i;
+        }
+    }
+    if (solverLimits.getTimeouts() != 0 || solverLimits.getSkipped() != 0) {
+        std::cerr << "Warning: " << solverLimits.getTimeouts() << " SMT queries timed out or were given up by the solver and " << solverLimits.getSkipped() << " exceeded the time budget" << std::endl;
     }
 
     return 0;